@@ -0,0 +1,268 @@
+/******************************************************************************
+This source file is part of the project
+HyperSheetsPreprocessor (HSPP) - Optimizer and minifier for CSS
+Copyright (C) 2019 Waldemar Zimpel <hspp@utilizer.de>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://www.gnu.org/licenses/>.
+*******************************************************************************/
+
+#include "Benchmark.h"
+#include "../src/String.h"
+#include "../src/defs.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+/// Benchmarks stop after this multiple of the minimum time, even if most
+/// of it was spent in preparation, which is not measured
+constexpr uint64_t MAX_WALL_TIME_FACTOR = 20;
+
+static DataContainer<pair<string, Benchmark::Function> > &benchmarks()
+{
+    static DataContainer<pair<string, Benchmark::Function> > benchmark_list;
+    return benchmark_list;
+}
+
+Benchmark::State::
+State(const uint64_t min_time_ns) :
+    m_min_time_ns(min_time_ns),
+    m_begin(steady_clock::now())
+{}
+
+bool
+Benchmark::State::
+keepRunning()
+{
+    const auto now = steady_clock::now();
+
+    if (m_timing) {
+        m_elapsed_time_ns += uint64_t(duration_cast<nanoseconds>(now - m_begin).count());
+        m_timing = false;
+    }
+
+    if (m_iterations == 0)
+        m_wall_begin = now;
+    else if (m_elapsed_time_ns >= m_min_time_ns ||
+             uint64_t(duration_cast<nanoseconds>(now - m_wall_begin).count()) >= m_min_time_ns * MAX_WALL_TIME_FACTOR)
+        return false;
+
+    ++m_iterations;
+    m_timing = true;
+    m_begin = steady_clock::now();
+
+    return true;
+}
+
+void
+Benchmark::State::
+pauseTiming()
+{
+    if (!m_timing) return;
+
+    m_elapsed_time_ns += uint64_t(duration_cast<nanoseconds>(steady_clock::now() - m_begin).count());
+    m_timing = false;
+}
+
+void
+Benchmark::State::
+resumeTiming()
+{
+    m_timing = true;
+    m_begin = steady_clock::now();
+}
+
+void
+Benchmark::State::
+setBytesPerIteration(const uint64_t bytes)
+{
+    m_bytes_per_iteration = bytes;
+}
+
+void
+Benchmark::State::
+setOperationsPerIteration(const uint64_t operations)
+{
+    m_operations_per_iteration = max<uint64_t>(operations, 1);
+}
+
+/*static*/ void
+Benchmark::
+add(const string &name, const Function &function)
+{
+    benchmarks().emplace_back(name, function);
+}
+
+/*static*/ DataContainer<Benchmark::Result>
+Benchmark::
+run(const string &filter, const uint64_t min_time_ns, ostream &stream)
+{
+    DataContainer<Result> results;
+
+    stream << "Benchmark" << String::repeatChar(' ', 41)
+           << "      ns/op        MB/s  Iterations" << endl;
+
+    for (const auto &benchmark : benchmarks()) {
+        if (benchmark.first.find(filter) == string::npos)
+            continue;
+
+        State state(min_time_ns);
+        benchmark.second(state);
+
+        const double
+        operations = double(max<uint64_t>(state.iterations(), 1)) * state.operationsPerIteration(),
+        seconds = state.elapsedTime() / 1e9;
+
+        results.push_back({
+            benchmark.first, state.iterations(), state.elapsedTime() / operations,
+            seconds > 0 ? state.bytesPerIteration() * double(state.iterations()) / seconds / 1e6 : 0
+        });
+
+        const auto &result = results.back();
+        const string
+        ns_per_op = String::numberFormat(result.ns_per_op, 1),
+        mb_per_s = result.mb_per_s > 0 ? String::numberFormat(result.mb_per_s, 2) : "-",
+        iterations = to_string(result.iterations);
+
+        stream << result.name << String::repeatChar(' ', result.name.length() < 50 ? 50 - result.name.length() : 1)
+               << String::repeatChar(' ', ns_per_op.length() < 11 ? 11 - ns_per_op.length() : 1) << ns_per_op
+               << String::repeatChar(' ', mb_per_s.length() < 12 ? 12 - mb_per_s.length() : 1) << mb_per_s
+               << String::repeatChar(' ', iterations.length() < 12 ? 12 - iterations.length() : 1) << iterations
+               << endl;
+    }
+
+    return results;
+}
+
+/*static*/ double
+Benchmark::
+measure(const Function &function, const uint64_t min_time_ns)
+{
+    State state(min_time_ns);
+    function(state);
+
+    return state.elapsedTime() / double(max<uint64_t>(state.iterations(), 1));
+}
+
+/*static*/ double
+Benchmark::
+growthExponent(const DataContainer<pair<double, double> > &samples)
+{
+    double sum_x = 0, sum_y = 0, sum_xx = 0, sum_xy = 0;
+
+    for (const auto &sample : samples) {
+        const double x = log(sample.first), y = log(sample.second);
+
+        sum_x += x;
+        sum_y += y;
+        sum_xx += x * x;
+        sum_xy += x * y;
+    }
+
+    const double
+    count = samples.size(),
+    denominator = count * sum_xx - sum_x * sum_x;
+
+    return denominator != 0 ? (count * sum_xy - sum_x * sum_y) / denominator : 0;
+}
+
+/*static*/ void
+Benchmark::
+writeJson(const DataContainer<Result> &results, ostream &stream)
+{
+    stream << "{\"benchmarks\":[";
+
+    for (auto result = results.begin(); result != results.end(); ++result) {
+        stream << (result != results.begin() ? "," : "") << NEWLINE
+               << "{\"name\":\"" << result->name
+               << "\",\"iterations\":" << result->iterations
+               << ",\"ns_per_op\":" << String::numberFormat(result->ns_per_op, 3)
+               << ",\"mb_per_s\":" << String::numberFormat(result->mb_per_s, 3) << "}";
+    }
+
+    stream << NEWLINE "]}" << endl;
+}
+
+/*static*/ DataContainer<Benchmark::Result>
+Benchmark::
+readJson(const string &json)
+{
+    DataContainer<Result> results;
+
+    // Returns the value following the key, starting the search at position
+    const auto valueOf = [&json](const string &key, const size_t position) -> string {
+        const auto key_position = json.find("\"" + key + "\":", position);
+
+        if (key_position == string::npos)
+            return string();
+
+        const auto begin = key_position + key.length() + 3;
+        const auto end = json.find_first_of(",}", json[begin] == '"' ? json.find('"', begin + 1) : begin);
+
+        string value = json.substr(begin, end - begin);
+
+        if (!value.empty() && value.front() == '"')
+            value = value.substr(1, value.length() - 2);
+
+        return value;
+    };
+
+    for (size_t position = json.find("{\"name\":"); position != string::npos;
+         position = json.find("{\"name\":", position + 1)) {
+        results.push_back({
+            valueOf("name", position),
+            strtoull(valueOf("iterations", position).data(), nullptr, 10),
+            strtod(valueOf("ns_per_op", position).data(), nullptr),
+            strtod(valueOf("mb_per_s", position).data(), nullptr)
+        });
+    }
+
+    return results;
+}
+
+/*static*/ bool
+Benchmark::
+compare(const DataContainer<Result> &results, const DataContainer<Result> &baseline,
+        const double threshold, ostream &stream)
+{
+    bool passed = true;
+
+    stream << NEWLINE "Benchmark" << String::repeatChar(' ', 41)
+           << "   Baseline    Current   Change" << endl;
+
+    for (const auto &result : results) {
+        const auto base = find_if(baseline.begin(), baseline.end(), [&result](const Result &base_result) {
+            return base_result.name == result.name;
+        });
+
+        if (base == baseline.end() || base->ns_per_op <= 0)
+            continue;
+
+        const double change = (result.ns_per_op - base->ns_per_op) / base->ns_per_op * 100;
+        const string
+        base_ns = String::numberFormat(base->ns_per_op, 1),
+        current_ns = String::numberFormat(result.ns_per_op, 1),
+        change_text = (change > 0 ? "+" : "") + String::numberFormat(change, 1) + "%";
+
+        stream << result.name << String::repeatChar(' ', result.name.length() < 50 ? 50 - result.name.length() : 1)
+               << String::repeatChar(' ', base_ns.length() < 11 ? 11 - base_ns.length() : 1) << base_ns
+               << String::repeatChar(' ', current_ns.length() < 11 ? 11 - current_ns.length() : 1) << current_ns
+               << String::repeatChar(' ', change_text.length() < 9 ? 9 - change_text.length() : 1) << change_text
+               << (change > threshold ? "  slower" : "") << endl;
+
+        if (change > threshold)
+            passed = false;
+    }
+
+    return passed;
+}
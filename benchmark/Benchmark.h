@@ -0,0 +1,172 @@
+/******************************************************************************
+This source file is part of the project
+HyperSheetsPreprocessor (HSPP) - Optimizer and minifier for CSS
+Copyright (C) 2019 Waldemar Zimpel <hspp@utilizer.de>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://www.gnu.org/licenses/>.
+*******************************************************************************/
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+#include "../src/DataContainer.h"
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+using namespace std;
+using namespace std::chrono;
+
+/// Registry and runner of the benchmarks of hspp_bench
+class Benchmark final
+{
+public:
+    /// Passed to every benchmark function, which repeats its work
+    /// as long as keepRunning() returns true:
+    ///
+    ///     while (state.keepRunning()) {
+    ///         state.pauseTiming();
+    ///         // Preparation, which is not measured
+    ///         state.resumeTiming();
+    ///         // Measured work
+    ///     }
+    class State final
+    {
+    public:
+        explicit
+        State(const uint64_t min_time_ns);
+
+        bool
+        keepRunning();
+
+        void
+        pauseTiming(),
+        resumeTiming(),
+
+        /// Bytes processed by one iteration, used for MB/s
+        setBytesPerIteration(const uint64_t bytes),
+        /// Operations done by one iteration, used for ns/op. Defaults to 1.
+        setOperationsPerIteration(const uint64_t operations);
+
+        inline uint64_t
+        iterations() const,
+        elapsedTime() const,
+        bytesPerIteration() const,
+        operationsPerIteration() const;
+
+    private:
+        const uint64_t m_min_time_ns;
+
+        uint64_t
+        m_iterations = 0,
+        m_elapsed_time_ns = 0,
+        m_bytes_per_iteration = 0,
+        m_operations_per_iteration = 1;
+
+        bool m_timing = false;
+
+        steady_clock::time_point
+        m_begin,
+        m_wall_begin;
+    };
+
+    struct Result
+    {
+        string name;
+        uint64_t iterations;
+        double ns_per_op, mb_per_s;
+    };
+
+    using Function = function<void(State &state)>;
+
+    static void
+    add(const string &name, const Function &function);
+
+    /// Makes the compiler assume, that the value is used, so that the
+    /// computation of a result, which a benchmark throws away, isn't removed
+    template<class T>
+    static inline void
+    doNotOptimize(const T &value);
+
+    /// Runs all benchmarks, which contain filter in their name, and
+    /// writes a line of text for each of them to the stream
+    static DataContainer<Result>
+    run(const string &filter, const uint64_t min_time_ns, ostream &stream);
+
+    /// Runs a single benchmark function and returns the measured time
+    /// of one iteration in nanoseconds
+    static double
+    measure(const Function &function, const uint64_t min_time_ns);
+
+    /// Returns the exponent b of time = a * size^b, which is fitted to
+    /// the samples (size, time) by least squares on a log-log scale
+    static double
+    growthExponent(const DataContainer<pair<double, double> > &samples);
+
+    static void
+    writeJson(const DataContainer<Result> &results, ostream &stream);
+
+    /// Reads results, which were written with writeJson()
+    static DataContainer<Result>
+    readJson(const string &json);
+
+    /// Writes the change of every result compared to the baseline. Returns
+    /// false, if a benchmark got slower by more than threshold percent.
+    static bool
+    compare(const DataContainer<Result> &results, const DataContainer<Result> &baseline,
+            const double threshold, ostream &stream);
+};
+
+template<class T>
+inline /*static*/ void
+Benchmark::
+doNotOptimize(const T &value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static const volatile void *sink;
+    sink = &value;
+#endif
+}
+
+inline uint64_t
+Benchmark::State::
+iterations() const
+{
+    return m_iterations;
+}
+
+inline uint64_t
+Benchmark::State::
+elapsedTime() const
+{
+    return m_elapsed_time_ns;
+}
+
+inline uint64_t
+Benchmark::State::
+bytesPerIteration() const
+{
+    return m_bytes_per_iteration;
+}
+
+inline uint64_t
+Benchmark::State::
+operationsPerIteration() const
+{
+    return m_operations_per_iteration;
+}
+
+#endif // BENCHMARK_H
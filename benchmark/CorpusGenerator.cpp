@@ -0,0 +1,392 @@
+/******************************************************************************
+This source file is part of the project
+HyperSheetsPreprocessor (HSPP) - Optimizer and minifier for CSS
+Copyright (C) 2019 Waldemar Zimpel <hspp@utilizer.de>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://www.gnu.org/licenses/>.
+*******************************************************************************/
+
+#include "CorpusGenerator.h"
+
+/// Buffered content is written to the stream, when it reaches this size
+constexpr uint64_t FLUSH_SIZE = 1024 * 1024;
+
+static const char *const ELEMENT_NAMES[] = {
+    "div", "a", "p", "span", "ul li", "section", "nav", "button", "input", "h2"
+};
+
+static const char *const PSEUDO_CLASSES[] = {
+    ":hover", ":focus", ":active", ":first-child", ":last-child", ":nth-child(2n+1)", "::before", "::after"
+};
+
+static const char *const COLOR_PROPERTIES[] = {
+    "color", "background-color", "border-color", "outline-color", "fill"
+};
+
+/// The first ones of them take up to four values
+static const char *const LENGTH_PROPERTIES[] = {
+    "margin", "padding", "border-radius", "width", "height", "top", "left", "font-size", "line-height", "margin-top"
+};
+
+constexpr uint64_t MULTI_VALUE_LENGTH_PROPERTIES = 3;
+
+static const char *const DISPLAY_VALUES[] = {
+    "none", "block", "inline-block", "flex", "grid", "inline"
+};
+
+static const char *const COLOR_NAMES[] = {
+    "white", "black", "red", "navy", "olive", "teal", "silver", "transparent", "rebeccapurple", "darkslategray"
+};
+
+static const char *const TIMING_FUNCTIONS[] = {
+    "ease", "ease-in-out", "linear", "cubic-bezier(0.25, 0.10, 0.25, 1.00)"
+};
+
+template<class T, size_t N>
+static constexpr uint64_t countOf(const T (&)[N])
+{
+    return N;
+}
+
+CorpusGenerator::Random::
+Random(const uint64_t seed) :
+    m_state(seed)
+{}
+
+uint64_t
+CorpusGenerator::Random::
+next()
+{
+    uint64_t result = (m_state += 0x9E3779B97F4A7C15ULL);
+    result = (result ^ (result >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    result = (result ^ (result >> 27)) * 0x94D049BB133111EBULL;
+
+    return result ^ (result >> 31);
+}
+
+uint64_t
+CorpusGenerator::Random::
+below(const uint64_t bound)
+{
+    return bound != 0 ? next() % bound : 0;
+}
+
+uint64_t
+CorpusGenerator::Random::
+between(const uint64_t min, const uint64_t max)
+{
+    return max > min ? min + below(max - min + 1) : min;
+}
+
+bool
+CorpusGenerator::Random::
+chance(const double probability)
+{
+    // 53 random bits give a uniformly distributed double in [0, 1)
+    return double(next() >> 11) * (1.0 / 9007199254740992.0) < probability;
+}
+
+CorpusGenerator::
+CorpusGenerator(const Options &options) :
+    m_options(options),
+    m_random(options.seed)
+{}
+
+void
+CorpusGenerator::
+generate(ostream &stream, const string &import_file_name_prefix)
+{
+    const uint64_t parts = m_options.import_count + 1;
+
+    for (uint64_t index = 0; index < m_options.import_count; ++index)
+        stream << "@import url(\"" << import_file_name_prefix << index << ".css\");\n";
+
+    if (m_options.import_count != 0)
+        stream << "\n";
+
+    writeStyleSheet(stream, m_options.size / parts, m_options.rule_count / parts);
+}
+
+void
+CorpusGenerator::
+generateImport(ostream &stream, const uint64_t index)
+{
+    const uint64_t parts = m_options.import_count + 1;
+
+    Options options = m_options;
+    options.seed = m_options.seed + index + 1;
+    options.import_count = 0;
+
+    CorpusGenerator(options).writeStyleSheet(stream, m_options.size / parts, m_options.rule_count / parts);
+}
+
+void
+CorpusGenerator::
+writeStyleSheet(ostream &stream, const uint64_t size, const uint64_t rule_count)
+{
+    string buffer;
+    uint64_t written = 0;
+
+    buffer.reserve(FLUSH_SIZE + FLUSH_SIZE / 4);
+
+    if (m_options.custom_property_count != 0) {
+        buffer += ":root {\n";
+
+        for (uint64_t index = 0; index < m_options.custom_property_count; ++index) {
+            buffer += "  --custom-property-" + to_string(index) + ": ";
+            writeColor(buffer);
+            buffer += ";\n";
+        }
+
+        buffer += "}\n\n";
+    }
+
+    for (uint64_t index = 0; index < m_options.animation_count; ++index) {
+        buffer += "@keyframes animation-" + to_string(index) + " {\n"
+                  "  0% {\n    opacity: 0;\n    transform: translateY(" + to_string(m_random.below(50)) + "px);\n  }\n"
+                  "  100% {\n    opacity: 1;\n    transform: none;\n  }\n}\n\n";
+    }
+
+    for (uint64_t rules = 0; size != 0 ? written + buffer.length() < size : rules < rule_count; ++rules) {
+        writeRule(buffer);
+
+        if (buffer.length() >= FLUSH_SIZE) {
+            stream.write(buffer.data(), streamsize(buffer.length()));
+            written += buffer.length();
+            buffer.clear();
+        }
+    }
+
+    stream.write(buffer.data(), streamsize(buffer.length()));
+}
+
+void
+CorpusGenerator::
+writeRule(string &buffer)
+{
+    if (m_random.chance(m_options.comment_density))
+        buffer += "/* Generated rule " + to_string(m_random.next() % 100000) + ", a comment which is usually removed */\n";
+
+    const bool in_media_rule = m_options.media_query_count != 0 && m_random.chance(m_options.media_ratio);
+    const string indentation = in_media_rule ? "  " : "";
+
+    if (in_media_rule) {
+        // Queries are derived from their index, so every index
+        // always stands for the same query
+        const uint64_t query = m_random.below(m_options.media_query_count);
+
+        buffer += "@media ";
+        buffer += query % 3 == 2 ? "screen and (max-width: " : "(min-width: ";
+        buffer += to_string(320 + query * 64) + "px)";
+
+        if (query % 4 == 3)
+            buffer += " and (orientation: landscape)";
+
+        buffer += " {\n";
+    }
+
+    const uint64_t selector_count = m_random.between(1, m_options.selector_list_length);
+
+    for (uint64_t index = 0; index < selector_count; ++index) {
+        buffer += index != 0 ? ",\n" + indentation : indentation;
+        writeSelector(buffer);
+    }
+
+    buffer += " {\n";
+
+    const uint64_t declaration_count = m_random.between(1, m_options.declarations_per_rule);
+
+    for (uint64_t index = 0; index < declaration_count; ++index) {
+        buffer += indentation + "  ";
+        writeDeclaration(buffer);
+        buffer += ";\n";
+    }
+
+    buffer += indentation + "}\n";
+
+    if (in_media_rule)
+        buffer += "}\n";
+
+    buffer += "\n";
+}
+
+void
+CorpusGenerator::
+writeSelector(string &buffer)
+{
+    if (m_options.id_count != 0 && m_random.chance(0.15))
+        buffer += "#id-" + to_string(m_random.below(m_options.id_count)) + " ";
+
+    if (m_random.chance(0.3) && m_options.class_count != 0)
+        buffer += ".class-" + to_string(m_random.below(m_options.class_count)) + " > ";
+
+    if (m_random.chance(0.3) || m_options.class_count == 0)
+        buffer += ELEMENT_NAMES[m_random.below(countOf(ELEMENT_NAMES))];
+
+    if (m_options.class_count != 0) {
+        for (uint64_t count = m_random.between(1, 2); count != 0; --count)
+            buffer += ".class-" + to_string(m_random.below(m_options.class_count));
+    }
+
+    if (m_random.chance(0.05))
+        buffer += "[data-state=\"open\"]";
+
+    if (m_random.chance(0.2))
+        buffer += PSEUDO_CLASSES[m_random.below(countOf(PSEUDO_CLASSES))];
+}
+
+void
+CorpusGenerator::
+writeDeclaration(string &buffer)
+{
+    if (m_options.data_uri_size != 0 && m_random.chance(m_options.data_uri_density)) {
+        static const char BASE64_CHARACTERS[] =
+            "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+        buffer += "background-image: url(\"data:image/png;base64,";
+
+        for (uint64_t index = 0; index < m_options.data_uri_size; ++index)
+            buffer += BASE64_CHARACTERS[m_random.below(64)];
+
+        buffer += "\")";
+        return;
+    }
+
+    switch (m_random.below(10)) {
+    case 0: case 1: case 2:
+        buffer += COLOR_PROPERTIES[m_random.below(countOf(COLOR_PROPERTIES))];
+        buffer += ": ";
+
+        if (m_options.custom_property_count != 0 && m_random.chance(0.2))
+            buffer += "var(--custom-property-" + to_string(m_random.below(m_options.custom_property_count)) + ")";
+        else
+            writeColor(buffer);
+
+        break;
+
+    case 3: case 4: case 5: {
+        const uint64_t property = m_random.below(countOf(LENGTH_PROPERTIES));
+
+        buffer += LENGTH_PROPERTIES[property];
+        buffer += ": ";
+        writeLength(buffer);
+
+        if (property < MULTI_VALUE_LENGTH_PROPERTIES) {
+            for (uint64_t count = m_random.below(4); count != 0; --count) {
+                buffer += " ";
+                writeLength(buffer);
+            }
+        }
+
+        break;
+    }
+
+    case 6:
+        buffer += "display: ";
+        buffer += DISPLAY_VALUES[m_random.below(countOf(DISPLAY_VALUES))];
+        break;
+
+    case 7:
+        buffer += "opacity: 0." + to_string(m_random.below(10)) + "00";
+        break;
+
+    case 8:
+        buffer += "transition: opacity 0." + to_string(m_random.between(1, 9)) + "0s ";
+        buffer += TIMING_FUNCTIONS[m_random.below(countOf(TIMING_FUNCTIONS))];
+        buffer += ", transform " + to_string(m_random.below(1000)) + "ms";
+        break;
+
+    default:
+        if (m_options.animation_count != 0 && m_random.chance(0.5)) {
+            buffer += "animation: animation-" + to_string(m_random.below(m_options.animation_count)) +
+                      " " + to_string(m_random.between(1, 5)) + ".50s ease-out both";
+        } else {
+            buffer += "transform: rotate(" + to_string(m_random.below(360)) + "deg) scale(1.0" +
+                      to_string(m_random.below(10)) + ")";
+        }
+    }
+
+    if (m_random.chance(0.02))
+        buffer += " !important";
+}
+
+void
+CorpusGenerator::
+writeColor(string &buffer)
+{
+    static const char HEX_DIGITS[] = "0123456789abcdef";
+
+    switch (m_random.below(5)) {
+    case 0:
+        buffer += COLOR_NAMES[m_random.below(countOf(COLOR_NAMES))];
+        break;
+
+    case 1:
+        buffer += "rgb(" + to_string(m_random.below(256)) + ", " + to_string(m_random.below(256)) +
+                  ", " + to_string(m_random.below(256)) + ")";
+        break;
+
+    case 2:
+        buffer += "rgba(" + to_string(m_random.below(256)) + ", " + to_string(m_random.below(256)) +
+                  ", " + to_string(m_random.below(256)) + ", 0." + to_string(m_random.below(10)) + ")";
+        break;
+
+    case 3:
+        buffer += "hsl(" + to_string(m_random.below(360)) + ", " + to_string(m_random.below(101)) +
+                  "%, " + to_string(m_random.below(101)) + "%)";
+        break;
+
+    default:
+        buffer += '#';
+
+        // Pairwise equal digits can be shortened by the minifier
+        if (m_random.chance(0.3)) {
+            for (uint8_t index = 0; index < 3; ++index)
+                buffer.append(2, HEX_DIGITS[m_random.below(16)]);
+        } else {
+            for (uint8_t index = 0; index < 6; ++index)
+                buffer += HEX_DIGITS[m_random.below(16)];
+        }
+    }
+}
+
+void
+CorpusGenerator::
+writeLength(string &buffer)
+{
+    switch (m_random.below(6)) {
+    case 0:
+        buffer += "0px";
+        break;
+
+    case 1:
+        buffer += to_string(m_random.below(100)) + "px";
+        break;
+
+    case 2:
+        buffer += "0" + to_string(m_random.below(4)) + "." + to_string(m_random.below(100)) + "0em";
+        break;
+
+    case 3:
+        buffer += to_string(m_random.below(101)) + ".0%";
+        break;
+
+    case 4:
+        buffer += "0." + to_string(m_random.between(1, 9)) + "50rem";
+        break;
+
+    default:
+        buffer += "calc(100% - " + to_string(m_random.between(1, 300)) + "px)";
+    }
+}
@@ -0,0 +1,113 @@
+/******************************************************************************
+This source file is part of the project
+HyperSheetsPreprocessor (HSPP) - Optimizer and minifier for CSS
+Copyright (C) 2019 Waldemar Zimpel <hspp@utilizer.de>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://www.gnu.org/licenses/>.
+*******************************************************************************/
+
+#ifndef CORPUSGENERATOR_H
+#define CORPUSGENERATOR_H
+#include <cstdint>
+#include <ostream>
+#include <string>
+using namespace std;
+
+/// Generates synthetic stylesheets of a given size and shape. The same seed
+/// and options always result in the same stylesheet on every platform.
+class CorpusGenerator final
+{
+public:
+    struct Options
+    {
+        uint64_t
+        seed = 1,
+        /// Size of the stylesheet in bytes, the generation stops at the
+        /// first rule boundary reaching it. If 0, rule_count is used.
+        size = 0,
+        rule_count = 1000,
+
+        /// Upper bounds of the selectors per rule and declarations per rule
+        selector_list_length = 3,
+        declarations_per_rule = 6,
+
+        /// Number of different class names, IDs, custom properties and
+        /// animation names used by the rules
+        class_count = 500,
+        id_count = 50,
+        custom_property_count = 20,
+        animation_count = 10,
+
+        /// Number of different media queries. Every rule wrapped in a media
+        /// rule picks one of them, so the same queries are repeated.
+        media_query_count = 8,
+        data_uri_size = 256,
+        import_count = 0;
+
+        double
+        /// Share of the rules which are wrapped in a media rule
+        media_ratio = 0.1,
+        /// Share of the rules which are preceded by a comment
+        comment_density = 0.05,
+        /// Share of the declarations which contain a data URI
+        data_uri_density = 0.005;
+    };
+
+    explicit
+    CorpusGenerator(const Options &options);
+
+    /// Writes the stylesheet. With import_count > 0, it begins with @import
+    /// rules of the files "<import_file_name_prefix><index>.css", whose
+    /// content is written by generateImport(). The size and the rule count
+    /// are split evenly between the stylesheet and its imports.
+    void
+    generate(ostream &stream, const string &import_file_name_prefix = string()),
+    generateImport(ostream &stream, const uint64_t index);
+
+private:
+    /// SplitMix64, which is used instead of the standard distributions,
+    /// whose results differ between standard library implementations
+    class Random final
+    {
+    public:
+        explicit
+        Random(const uint64_t seed);
+
+        uint64_t
+        next(),
+        /// Returns a number in [0, bound)
+        below(const uint64_t bound),
+        /// Returns a number in [min, max]
+        between(const uint64_t min, const uint64_t max);
+
+        bool
+        chance(const double probability);
+
+    private:
+        uint64_t m_state;
+    };
+
+    void
+    writeStyleSheet(ostream &stream, const uint64_t size, const uint64_t rule_count),
+    writeRule(string &buffer),
+    writeSelector(string &buffer),
+    writeDeclaration(string &buffer),
+    writeColor(string &buffer),
+    writeLength(string &buffer);
+
+    const Options m_options;
+    Random m_random;
+};
+
+#endif // CORPUSGENERATOR_H
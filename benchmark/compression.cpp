@@ -0,0 +1,300 @@
+/******************************************************************************
+This source file is part of the project
+HyperSheetsPreprocessor (HSPP) - Optimizer and minifier for CSS
+Copyright (C) 2019 Waldemar Zimpel <hspp@utilizer.de>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://www.gnu.org/licenses/>.
+*******************************************************************************/
+
+#include "../src/config/Config.h"
+#include "../src/css/CssPassManager.h"
+#include "../src/filesystem/FileSystem.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <zlib.h>
+
+#ifdef HSPP_HAVE_BROTLI
+#include <brotli/encode.h>
+#endif
+
+using namespace std::chrono;
+
+Config cfg;
+
+#ifdef WIN
+#define NULL_DEVICE "NUL"
+#else
+#define NULL_DEVICE "/dev/null"
+#endif
+
+#define COMPRESSION_USAGE\
+    "Usage: hspp_compression [options]" NEWLINE NEWLINE\
+    "Minifies the corpus with every optimization switched on alone and" NEWLINE\
+    "one after another, and compares the raw and the compressed sizes." NEWLINE NEWLINE\
+    "Options:" NEWLINE\
+    "    --corpus <path>           Directory of the stylesheets" NEWLINE\
+    "    --hspp <path>             Path of the hspp executable" NEWLINE\
+    "    --work-dir <path>         Absolute path of the directory for the" NEWLINE\
+    "                              configuration files and the output" NEWLINE
+
+bool RETURN(const string &message)
+{
+    cerr << message << endl;
+    exit(1);
+}
+
+/// Optimizations of the [css] section of the configuration file, the passes
+/// with a setting. They are enabled one after another in the order of the
+/// passes, identifiers are renamed last.
+static DataContainer<string> optimizations()
+{
+    using CSS::CssPassManager;
+
+    const auto isRenaming = [](const CssPassManager::Pass pass) -> bool {
+        return pass >= CssPassManager::MINIFY_IDS && pass <= CssPassManager::MINIFY_ANIMATION_NAMES;
+    };
+
+    DataContainer<string> names, renaming;
+
+    for (uint8_t pass = 0; pass < CssPassManager::PASS_COUNT; ++pass)
+        if (CssPassManager::hasSetting(CssPassManager::Pass(pass)))
+            (isRenaming(CssPassManager::Pass(pass)) ? renaming : names)
+                .emplace_back(CssPassManager::passName(CssPassManager::Pass(pass)));
+
+    names.insert(names.end(), renaming.begin(), renaming.end());
+
+    return names;
+}
+
+static const DataContainer<string> OPTIMIZATIONS = optimizations();
+
+/// Width of the configuration column, fits the longest "only <optimization>"
+static const uint64_t NAME_WIDTH = [] {
+    uint64_t width = string("Configuration").length();
+
+    for (const auto &optimization : OPTIMIZATIONS)
+        width = max<uint64_t>(width, string("only ").length() + optimization.length());
+
+    return width + 1;
+}();
+
+struct Result
+{
+    string name;
+    uint64_t raw, gzip, brotli;
+    double time_ms;
+};
+
+static uint64_t gzipSize(const string &content)
+{
+    z_stream stream {};
+
+    // 15 window bits, plus 16 for the gzip header and trailer
+    deflateInit2(&stream, 9, Z_DEFLATED, 15 + 16, 9, Z_DEFAULT_STRATEGY) != Z_OK &&
+        RETURN("Couldn't initialize zlib");
+
+    string compressed(deflateBound(&stream, uLong(content.length())), '\0');
+
+    stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(content.data()));
+    stream.avail_in = uInt(content.length());
+    stream.next_out = reinterpret_cast<Bytef *>(&compressed[0]);
+    stream.avail_out = uInt(compressed.length());
+
+    deflate(&stream, Z_FINISH) != Z_STREAM_END &&
+        RETURN("Couldn't compress with zlib");
+
+    const uint64_t size = stream.total_out;
+    deflateEnd(&stream);
+
+    return size;
+}
+
+static uint64_t brotliSize(const string &content)
+{
+#ifdef HSPP_HAVE_BROTLI
+    size_t size = BrotliEncoderMaxCompressedSize(content.length());
+    string compressed(size, '\0');
+
+    !BrotliEncoderCompress(BROTLI_MAX_QUALITY, BROTLI_DEFAULT_WINDOW, BROTLI_MODE_TEXT,
+                           content.length(), reinterpret_cast<const uint8_t *>(content.data()),
+                           &size, reinterpret_cast<uint8_t *>(&compressed[0])) &&
+        RETURN("Couldn't compress with brotli");
+
+    return size;
+#else
+    (void)content;
+    return 0;
+#endif
+}
+
+/// Minifies every stylesheet of the corpus with the enabled optimizations
+/// and sums up the sizes of the output
+static Result measure(const string &name, const DataContainer<string> &enabled,
+                      const DataContainer<string> &corpus, const string &hspp_path, const string &work_dir)
+{
+    const string
+    config_path = work_dir + DIR_SEP "hspp.ini",
+    output_dir = work_dir + DIR_SEP "output";
+
+    string config = "[general]" NEWLINE "create_json_file = off" NEWLINE NEWLINE "[css]" NEWLINE;
+
+    for (const auto &optimization : OPTIMIZATIONS)
+        config += optimization + " = " + (find(enabled.begin(), enabled.end(), optimization) != enabled.end() ? "on" : "off") + NEWLINE;
+
+    !FileSystem::writeFile(config_path, config) &&
+        RETURN("Couldn't write '" + config_path + "'");
+
+    Result result {name, 0, 0, 0, 0};
+
+    for (const auto &file_path : corpus) {
+        const string command =
+            "\"" + hspp_path + "\" -i \"" + file_path + "\" -o \"" + output_dir +
+            "\" --config-file \"" + config_path + "\" > " NULL_DEVICE;
+
+        const auto begin = steady_clock::now();
+
+        system(command.data()) != 0 &&
+            RETURN("Failed: " + command);
+
+        result.time_ms += duration_cast<microseconds>(steady_clock::now() - begin).count() / 1e3;
+
+        string output;
+        const auto output_path = output_dir + DIR_SEP + FileSystem::getBaseName(file_path);
+
+        !FileSystem::readFile(output_path, output) &&
+            RETURN("Couldn't read '" + output_path + "'");
+
+        result.raw += output.length();
+        result.gzip += gzipSize(output);
+        result.brotli += brotliSize(output);
+    }
+
+    return result;
+}
+
+/// Writes the result and its difference to the reference. Returns true, if
+/// the raw output got smaller, but the compressed output got larger.
+static bool writeResult(const Result &result, const Result *reference)
+{
+    const auto column = [](const string &value, const uint64_t width) -> string {
+        return value.length() < width ? String::repeatChar(' ', width - value.length()) + value : ' ' + value;
+    };
+
+    const auto difference = [&reference](const uint64_t value, const uint64_t reference_value) -> string {
+        if (!reference) return string();
+
+        const int64_t change = int64_t(value) - int64_t(reference_value);
+        return (change > 0 ? "+" : "") + to_string(change);
+    };
+
+    const bool compressed_larger = reference && result.raw < reference->raw &&
+        (result.gzip > reference->gzip || (result.brotli && result.brotli > reference->brotli));
+
+    cout << result.name << String::repeatChar(' ', result.name.length() < NAME_WIDTH ? NAME_WIDTH - result.name.length() : 1)
+         << column(to_string(result.raw), 10) << column(difference(result.raw, reference ? reference->raw : 0), 9)
+         << column(to_string(result.gzip), 10) << column(difference(result.gzip, reference ? reference->gzip : 0), 8)
+         << column(result.brotli ? to_string(result.brotli) : "-", 10)
+         << column(result.brotli ? difference(result.brotli, reference ? reference->brotli : 0) : "", 8)
+         << column(String::numberFormat(result.time_ms, 1), 10)
+         << (compressed_larger ? "  compressed larger" : "") << endl;
+
+    return compressed_larger;
+}
+
+int main(int argc, char **argv)
+{
+    ios_base::sync_with_stdio(false);
+
+    string corpus_path = HSPP_BENCH_CORPUS_DIR, hspp_path = HSPP_BINARY_PATH, work_dir = HSPP_COMPRESSION_WORK_DIR;
+
+    for (int32_t i = 1; i < argc; ++i) {
+        const string arg = argv[i];
+
+        if (arg == "--help") {
+            cout << COMPRESSION_USAGE;
+            return 0;
+        }
+
+        i + 1 >= argc &&
+            RETURN("Expected a value after argument '" + arg + "'" NEWLINE NEWLINE COMPRESSION_USAGE);
+
+        const string value = argv[++i];
+
+        if (arg == "--corpus")
+            corpus_path = value;
+        else if (arg == "--hspp")
+            hspp_path = value;
+        else if (arg == "--work-dir")
+            work_dir = value;
+        else
+            RETURN("Unknown argument: " + arg + NEWLINE NEWLINE COMPRESSION_USAGE);
+    }
+
+    !FileSystem::isAbsolutePath(work_dir) &&
+        RETURN("The work directory '" + work_dir + "' is not an absolute path.");
+
+    string fail_path;
+
+    !FileSystem::createPath(work_dir + DIR_SEP "output", fail_path) && !FileSystem::isDir(work_dir + DIR_SEP "output") &&
+        RETURN("Couldn't create '" + fail_path + "'");
+
+    !FileSystem::isDir(corpus_path) &&
+        RETURN("The corpus directory '" + corpus_path + "' does not exist.");
+
+    auto corpus = FileSystem::getDirectoryContents(corpus_path);
+    sort(corpus.begin(), corpus.end());
+
+    corpus.erase(remove_if(corpus.begin(), corpus.end(), [](const string &file_path) {
+        return file_path.length() < 4 || file_path.compare(file_path.length() - 4, 4, ".css") != 0;
+    }), corpus.end());
+
+    corpus.empty() &&
+        RETURN("The corpus directory '" + corpus_path + "' doesn't contain any stylesheets.");
+
+    cout << "Configuration" << String::repeatChar(' ', NAME_WIDTH - string("Configuration").length())
+         << "       Raw   Change    gzip-9  Change brotli-11  Change   Time ms" << endl;
+
+    // Every optimization alone compared to none
+    const auto none = measure("none", DataContainer<string>(), corpus, hspp_path, work_dir);
+    writeResult(none, nullptr);
+
+    uint64_t compressed_larger = 0;
+
+    for (const auto &optimization : OPTIMIZATIONS)
+        compressed_larger += writeResult(measure("only " + optimization, {optimization}, corpus, hspp_path, work_dir), &none);
+
+    cout << endl;
+
+    // The optimizations enabled one after another, each compared to the previous step
+    DataContainer<string> enabled;
+    auto previous = none;
+
+    for (const auto &optimization : OPTIMIZATIONS) {
+        enabled.emplace_back(optimization);
+
+        const auto result = measure("+ " + optimization, enabled, corpus, hspp_path, work_dir);
+        compressed_larger += writeResult(result, &previous);
+        previous = result;
+    }
+
+#ifndef HSPP_HAVE_BROTLI
+    cout << NEWLINE "Built without brotli, only gzip sizes are reported." << endl;
+#endif
+
+    if (compressed_larger)
+        cout << NEWLINE << compressed_larger << " optimization(s) made the raw output smaller, but the compressed output larger." << endl;
+
+    return 0;
+}
@@ -0,0 +1,146 @@
+/******************************************************************************
+This source file is part of the project
+HyperSheetsPreprocessor (HSPP) - Optimizer and minifier for CSS
+Copyright (C) 2019 Waldemar Zimpel <hspp@utilizer.de>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://www.gnu.org/licenses/>.
+*******************************************************************************/
+
+#include "CorpusGenerator.h"
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+
+#define GENERATOR_USAGE\
+    "Usage: hspp_corpus --output <path> [options]" "\n\n"\
+    "Options:" "\n"\
+    "    --seed <number>               Seed of the random numbers" "\n"\
+    "    --size <bytes>[K|M|G]         Size of the output, overrides --rules" "\n"\
+    "    --rules <number>              Number of rules" "\n"\
+    "    --selectors <number>          Maximum selectors per rule" "\n"\
+    "    --declarations <number>       Maximum declarations per rule" "\n"\
+    "    --classes <number>            Number of different class names" "\n"\
+    "    --ids <number>                Number of different IDs" "\n"\
+    "    --custom-properties <number>  Number of different custom properties" "\n"\
+    "    --animations <number>         Number of different animation names" "\n"\
+    "    --media-queries <number>      Number of different media queries" "\n"\
+    "    --media-ratio <0..1>          Share of rules inside media rules" "\n"\
+    "    --comment-density <0..1>      Share of rules preceded by a comment" "\n"\
+    "    --data-uri-size <bytes>       Size of each data URI" "\n"\
+    "    --data-uri-density <0..1>     Share of declarations with a data URI" "\n"\
+    "    --imports <number>            Number of imported stylesheets, which" "\n"\
+    "                                  are written next to the output file" "\n"
+
+bool RETURN(const string &message)
+{
+    cerr << message << endl;
+    exit(1);
+}
+
+/// Parses a number with an optional K, M or G suffix
+static uint64_t parseSize(const string &value)
+{
+    char *end = nullptr;
+    uint64_t size = strtoull(value.data(), &end, 10);
+
+    switch (*end) {
+    case 'G': case 'g': size *= 1024;
+    // fall through
+    case 'M': case 'm': size *= 1024;
+    // fall through
+    case 'K': case 'k': size *= 1024;
+    }
+
+    return size;
+}
+
+static void writeFile(const string &path, const function<void(ostream &)> &write)
+{
+    ofstream stream(path, ios::out | ios::trunc | ios::binary);
+
+    !stream.is_open() &&
+        RETURN("Couldn't open '" + path + "' for writing.");
+
+    write(stream);
+
+    !stream.good() &&
+        RETURN("Couldn't write '" + path + "'");
+}
+
+int main(int argc, char **argv)
+{
+    ios_base::sync_with_stdio(false);
+
+    CorpusGenerator::Options options;
+    string output_path;
+
+    for (int32_t i = 1; i < argc; ++i) {
+        const string arg = argv[i];
+
+        if (arg == "--help") {
+            cout << GENERATOR_USAGE;
+            return 0;
+        }
+
+        i + 1 >= argc &&
+            RETURN("Expected a value after argument '" + arg + "'\n\n" GENERATOR_USAGE);
+
+        const string value = argv[++i];
+        const uint64_t number = strtoull(value.data(), nullptr, 10);
+        const double ratio = strtod(value.data(), nullptr);
+
+        if (arg == "--output")                  output_path = value;
+        else if (arg == "--seed")               options.seed = number;
+        else if (arg == "--size")               options.size = parseSize(value);
+        else if (arg == "--rules")              options.rule_count = number;
+        else if (arg == "--selectors")          options.selector_list_length = max<uint64_t>(number, 1);
+        else if (arg == "--declarations")       options.declarations_per_rule = max<uint64_t>(number, 1);
+        else if (arg == "--classes")            options.class_count = number;
+        else if (arg == "--ids")                options.id_count = number;
+        else if (arg == "--custom-properties")  options.custom_property_count = number;
+        else if (arg == "--animations")         options.animation_count = number;
+        else if (arg == "--media-queries")      options.media_query_count = number;
+        else if (arg == "--media-ratio")        options.media_ratio = ratio;
+        else if (arg == "--comment-density")    options.comment_density = ratio;
+        else if (arg == "--data-uri-size")      options.data_uri_size = number;
+        else if (arg == "--data-uri-density")   options.data_uri_density = ratio;
+        else if (arg == "--imports")            options.import_count = number;
+        else RETURN("Unknown argument: " + arg + "\n\n" GENERATOR_USAGE);
+    }
+
+    output_path.empty() &&
+        RETURN("The output path is not specified.\n\n" GENERATOR_USAGE);
+
+    // Imported stylesheets are named after the output file
+    const auto name_begin = output_path.find_last_of("/\\") + 1;
+    const auto name_end = output_path.rfind('.') > name_begin ? output_path.rfind('.') : output_path.length();
+    const string
+    directory = output_path.substr(0, name_begin),
+    import_prefix = output_path.substr(name_begin, name_end - name_begin) + "-import-";
+
+    CorpusGenerator generator(options);
+
+    writeFile(output_path, [&](ostream &stream) {
+        generator.generate(stream, import_prefix);
+    });
+
+    for (uint64_t index = 0; index < options.import_count; ++index) {
+        writeFile(directory + import_prefix + to_string(index) + ".css", [&](ostream &stream) {
+            generator.generateImport(stream, index);
+        });
+    }
+
+    return 0;
+}
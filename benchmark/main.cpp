@@ -0,0 +1,483 @@
+/******************************************************************************
+This source file is part of the project
+HyperSheetsPreprocessor (HSPP) - Optimizer and minifier for CSS
+Copyright (C) 2019 Waldemar Zimpel <hspp@utilizer.de>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://www.gnu.org/licenses/>.
+*******************************************************************************/
+
+#include "Benchmark.h"
+#include "CorpusGenerator.h"
+#include "../src/config/Config.h"
+#include "../src/css/generator/CssGenerator.h"
+#include "../src/css/minifier/CssMinifier.h"
+#include "../src/css/modifier/CssModifier.h"
+#include "../src/css/modifier/restructuring/CssRestructuring.h"
+#include "../src/css/parser/CssParser.h"
+#include "../src/css/tokenizer/CssTokenizer.h"
+#include "../src/filesystem/FileSystem.h"
+#include "../src/HashTable.h"
+#include "../src/String.h"
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+using namespace CSS::Tokenization;
+using namespace CSS::Parsing;
+using namespace CSS::Minification;
+using namespace CSS::Generation;
+
+Config cfg;
+
+#define BENCH_USAGE\
+    "Usage: hspp_bench [options]" NEWLINE NEWLINE\
+    "Options:" NEWLINE\
+    "    --corpus <path>           Directory of the stylesheets used by the" NEWLINE\
+    "                              macro benchmarks and the stage benchmarks" NEWLINE\
+    "    --filter <text>           Run only benchmarks containing the text" NEWLINE\
+    "    --min-time <ms>           Minimum measured time of each benchmark" NEWLINE\
+    "    --json <path>             Write the results as JSON" NEWLINE\
+    "    --baseline <path>         Compare the results with a JSON file" NEWLINE\
+    "                              written by '--json'" NEWLINE\
+    "    --threshold <percent>     Fail, if a benchmark got slower by more" NEWLINE\
+    "                              than this compared to the baseline" NEWLINE\
+    "    --scaling <exponent>      Instead of the benchmarks, run the stages" NEWLINE\
+    "                              on generated stylesheets of doubling size" NEWLINE\
+    "                              and fail, if the time of a stage grows" NEWLINE\
+    "                              faster than size^exponent" NEWLINE
+
+bool RETURN(const string &message)
+{
+    cerr << message << endl;
+    exit(1);
+}
+
+/// Stylesheets of the corpus, sorted by file name
+static DataContainer<pair<string, shared_ptr<string> > > readCorpus(const string &path)
+{
+    !FileSystem::isDir(path) &&
+        RETURN("The corpus directory '" + path + "' does not exist.");
+
+    auto file_paths = FileSystem::getDirectoryContents(path);
+    sort(file_paths.begin(), file_paths.end());
+
+    DataContainer<pair<string, shared_ptr<string> > > corpus;
+
+    for (const auto &file_path : file_paths) {
+        if (FileSystem::getFileExtension(file_path) != ".css")
+            continue;
+
+        const auto content = make_shared<string>();
+
+        !FileSystem::readFile(file_path, *content) &&
+            RETURN("Couldn't read '" + file_path + "'");
+
+        corpus.emplace_back(FileSystem::getBaseName(file_path), content);
+    }
+
+    corpus.empty() &&
+        RETURN("The corpus directory '" + path + "' doesn't contain any stylesheets.");
+
+    return corpus;
+}
+
+/// Benchmarks of the single stages of the minification of the content
+static DataContainer<pair<string, Benchmark::Function> > stageBenchmarks(const shared_ptr<string> &content)
+{
+    DataContainer<pair<string, Benchmark::Function> > benchmarks;
+
+    benchmarks.emplace_back("stage/tokenize", [content](Benchmark::State &state) {
+        state.setBytesPerIteration(content->length());
+
+        while (state.keepRunning())
+            Benchmark::doNotOptimize(CssTokenizer::tokenize(*content));
+    });
+
+    benchmarks.emplace_back("stage/parse", [content](Benchmark::State &state) {
+        state.setBytesPerIteration(content->length());
+
+        while (state.keepRunning()) {
+            state.pauseTiming();
+            const auto token_stream = CssTokenizer::tokenize(*content);
+            state.resumeTiming();
+
+            Benchmark::doNotOptimize(CssParser::parse(token_stream));
+        }
+    });
+
+    benchmarks.emplace_back("stage/modify", [content](Benchmark::State &state) {
+        state.setBytesPerIteration(content->length());
+
+        while (state.keepRunning()) {
+            state.pauseTiming();
+            const auto stylesheet = CssParser::parse(*content);
+            CssModifier css_modifier;
+            state.resumeTiming();
+
+            stylesheet->accept(css_modifier);
+        }
+    });
+
+    benchmarks.emplace_back("stage/restructure", [content](Benchmark::State &state) {
+        state.setBytesPerIteration(content->length());
+        cfg.enable(Config::CSS__MERGE_MEDIA_RULES);
+
+        while (state.keepRunning()) {
+            state.pauseTiming();
+            const auto stylesheet = CssParser::parse(*content);
+            CssRestructuring restructuring;
+            restructuring.setStyleSheet(stylesheet);
+
+            for (const auto &element : stylesheet->elements()) {
+                if (element->type() == CssBaseElement::AT_RULE &&
+                    static_pointer_cast<CssAtRule>(element)->keyword() == "media")
+                    restructuring.appendAtRuleMedia(static_pointer_cast<CssAtRule>(element));
+            }
+            state.resumeTiming();
+
+            restructuring.restructure();
+        }
+
+        cfg.disable(Config::CSS__MERGE_MEDIA_RULES);
+    });
+
+    benchmarks.emplace_back("stage/generate", [content](Benchmark::State &state) {
+        state.setBytesPerIteration(content->length());
+
+        const auto stylesheet = CssParser::parse(*content);
+        CssModifier css_modifier;
+        stylesheet->accept(css_modifier);
+
+        while (state.keepRunning()) {
+            string output;
+            CssGenerator css_generator(output);
+
+            stylesheet->accept(css_generator);
+            Benchmark::doNotOptimize(output);
+        }
+    });
+
+    return benchmarks;
+}
+
+/// Benchmark of the whole minification of the content
+static Benchmark::Function minifyBenchmark(const shared_ptr<string> &content)
+{
+    return [content](Benchmark::State &state) {
+        state.setBytesPerIteration(content->length());
+
+        while (state.keepRunning()) {
+            // The minifier takes over the content
+            state.pauseTiming();
+            const auto input = make_shared<string>(*content);
+            state.resumeTiming();
+
+            Benchmark::doNotOptimize(CssMinifier::minify(input));
+        }
+    };
+}
+
+/// Benchmarks of single functions and containers
+static void addMicroBenchmarks()
+{
+    Benchmark::add("micro/get_short_number", [](Benchmark::State &state) {
+        const DataContainer<string> numbers {
+            "0.50", "010", "1.000", "0.0", "12.5000", "100", "003.1400", "0.001", "42", "7.0"
+        };
+
+        state.setOperationsPerIteration(numbers.size());
+
+        while (state.keepRunning())
+            for (const auto &number : numbers)
+                Benchmark::doNotOptimize(CssModifier::getShortNumber(number));
+    });
+
+    Benchmark::add("micro/get_short_hex_color", [](Benchmark::State &state) {
+        const DataContainer<string> colors {
+            "ffffff", "0055aa", "123456", "aabbccdd", "00000000", "abcdef", "ff0000", "a1b2c3d4"
+        };
+
+        state.setOperationsPerIteration(colors.size());
+
+        while (state.keepRunning())
+            for (const auto &color : colors)
+                Benchmark::doNotOptimize(CssModifier::getShortHexColorValue(color));
+    });
+
+    Benchmark::add("micro/minify_colors", [](Benchmark::State &state) {
+        string content;
+
+        for (uint32_t i = 0; i < 256; ++i) {
+            content += ".c" + to_string(i) + "{color:rgb(" + to_string(i) + ",0,0);"
+                       "background:#ffffff;border-color:white;outline-color:hsl(" +
+                       to_string(i) + ",50%,50%);fill:rgba(0,0," + to_string(i) + ",0.5)}";
+        }
+
+        state.setBytesPerIteration(content.length());
+        state.setOperationsPerIteration(256 * 5);
+
+        while (state.keepRunning()) {
+            state.pauseTiming();
+            const auto stylesheet = CssParser::parse(content);
+            CssModifier css_modifier;
+            state.resumeTiming();
+
+            stylesheet->accept(css_modifier);
+        }
+    });
+
+    // Number of elements of the container benchmarks
+    constexpr uint64_t CONTAINER_SIZE = 1024;
+
+    Benchmark::add("micro/data_container_append", [](Benchmark::State &state) {
+        state.setOperationsPerIteration(CONTAINER_SIZE);
+
+        while (state.keepRunning()) {
+            DataContainer<uint64_t> container;
+
+            for (uint64_t i = 0; i < CONTAINER_SIZE; ++i)
+                container.appendElement(i);
+
+            Benchmark::doNotOptimize(container);
+        }
+    });
+
+    Benchmark::add("micro/data_container_has_element", [](Benchmark::State &state) {
+        DataContainer<uint64_t> container;
+
+        for (uint64_t i = 0; i < CONTAINER_SIZE; ++i)
+            container.appendElement(i);
+
+        state.setOperationsPerIteration(CONTAINER_SIZE);
+
+        while (state.keepRunning())
+            for (uint64_t i = 0; i < CONTAINER_SIZE; ++i)
+                Benchmark::doNotOptimize(container.hasElement(i * 7 % CONTAINER_SIZE));
+    });
+
+    Benchmark::add("micro/data_container_remove_elements", [](Benchmark::State &state) {
+        state.setOperationsPerIteration(CONTAINER_SIZE);
+
+        while (state.keepRunning()) {
+            state.pauseTiming();
+            DataContainer<uint64_t> container;
+
+            for (uint64_t i = 0; i < CONTAINER_SIZE; ++i)
+                container.appendElement(i);
+            state.resumeTiming();
+
+            container.removeElements([](const uint64_t &element) {
+                return element % 2 == 0;
+            });
+
+            Benchmark::doNotOptimize(container);
+        }
+    });
+
+    Benchmark::add("micro/hash_table_set_element", [](Benchmark::State &state) {
+        DataContainer<string> keys;
+
+        for (uint64_t i = 0; i < CONTAINER_SIZE; ++i)
+            keys.appendElement("identifier-" + to_string(i));
+
+        state.setOperationsPerIteration(CONTAINER_SIZE * 2);
+
+        while (state.keepRunning()) {
+            HashTable<string, uint64_t> table;
+
+            // Every key is inserted once and found once
+            for (uint64_t round = 0; round < 2; ++round) {
+                for (uint64_t i = 0; i < CONTAINER_SIZE; ++i) {
+                    uint64_t value = i;
+                    table.setElement(keys[i], value);
+                }
+            }
+
+            Benchmark::doNotOptimize(table);
+        }
+    });
+
+    Benchmark::add("micro/hash_table_find", [](Benchmark::State &state) {
+        DataContainer<string> keys;
+        HashTable<string, uint64_t> table;
+
+        for (uint64_t i = 0; i < CONTAINER_SIZE; ++i) {
+            keys.appendElement("identifier-" + to_string(i));
+            table.appendElement(keys.back(), i);
+        }
+
+        state.setOperationsPerIteration(CONTAINER_SIZE);
+
+        while (state.keepRunning())
+            for (const auto &key : keys)
+                Benchmark::doNotOptimize(table.find(key));
+    });
+}
+
+/// Benchmarks of the whole minification of every stylesheet of the corpus
+static void addMacroBenchmarks(const DataContainer<pair<string, shared_ptr<string> > > &corpus)
+{
+    for (const auto &file : corpus)
+        Benchmark::add("macro/minify/" + file.first, minifyBenchmark(file.second));
+}
+
+/// Runs the stages and the whole minification on generated stylesheets of
+/// the same shape at doubling sizes and fits the growth exponent of their
+/// time. Returns false, if any of them grows faster than size^max_exponent.
+static bool runScalingTest(const string &filter, const uint64_t min_time_ns, const double max_exponent)
+{
+    constexpr uint64_t
+    BASE_SIZE = 512 * 1024,
+    STEPS = 5;
+
+    DataContainer<string> names;
+    DataContainer<DataContainer<pair<double, double> > > samples;
+
+    for (uint64_t step = 0; step < STEPS; ++step) {
+        CorpusGenerator::Options options;
+        options.size = BASE_SIZE << step;
+
+        ostringstream stream;
+        CorpusGenerator(options).generate(stream);
+        const auto content = make_shared<string>(stream.str());
+
+        auto benchmarks = stageBenchmarks(content);
+        benchmarks.emplace_back("macro/minify", minifyBenchmark(content));
+
+        uint64_t index = 0;
+
+        for (const auto &benchmark : benchmarks) {
+            if (benchmark.first.find(filter) == string::npos)
+                continue;
+
+            if (step == 0) {
+                names.emplace_back(benchmark.first);
+                samples.emplace_back();
+            }
+
+            samples.at(index++).emplace_back(content->length(), Benchmark::measure(benchmark.second, min_time_ns));
+        }
+    }
+
+    bool passed = true;
+
+    cout << "Stage" << String::repeatChar(' ', 19);
+
+    for (uint64_t step = 0; step < STEPS; ++step) {
+        const string size = to_string((BASE_SIZE << step) / 1024) + " KiB";
+        cout << String::repeatChar(' ', size.length() < 12 ? 12 - size.length() : 1) << size;
+    }
+
+    cout << "  Exponent" << endl;
+
+    for (uint64_t i = 0; i < names.size(); ++i) {
+        const double exponent = Benchmark::growthExponent(samples.at(i));
+        const string exponent_text = String::numberFormat(exponent, 2);
+
+        cout << names.at(i) << String::repeatChar(' ', names.at(i).length() < 24 ? 24 - names.at(i).length() : 1);
+
+        for (const auto &sample : samples.at(i)) {
+            const string time = String::numberFormat(sample.second / 1e6, 2) + " ms";
+            cout << String::repeatChar(' ', time.length() < 12 ? 12 - time.length() : 1) << time;
+        }
+
+        cout << String::repeatChar(' ', exponent_text.length() < 10 ? 10 - exponent_text.length() : 1) << exponent_text
+             << (exponent > max_exponent ? "  super-linear" : "") << endl;
+
+        if (exponent > max_exponent)
+            passed = false;
+    }
+
+    return passed;
+}
+
+int main(int argc, char **argv)
+{
+    ios_base::sync_with_stdio(false);
+
+    string corpus_path = HSPP_BENCH_CORPUS_DIR, filter, json_path, baseline_path;
+    double min_time_ms = 500, threshold = 10, max_exponent = 0;
+
+    for (int32_t i = 1; i < argc; ++i) {
+        const string arg = argv[i];
+
+        if (arg == "--help") {
+            cout << BENCH_USAGE;
+            return 0;
+        }
+
+        i + 1 >= argc &&
+            RETURN("Expected a value after argument '" + arg + "'" NEWLINE NEWLINE BENCH_USAGE);
+
+        const string value = argv[++i];
+
+        if (arg == "--corpus")
+            corpus_path = value;
+        else if (arg == "--filter")
+            filter = value;
+        else if (arg == "--min-time")
+            min_time_ms = strtod(value.data(), nullptr);
+        else if (arg == "--json")
+            json_path = value;
+        else if (arg == "--baseline")
+            baseline_path = value;
+        else if (arg == "--threshold")
+            threshold = strtod(value.data(), nullptr);
+        else if (arg == "--scaling")
+            max_exponent = strtod(value.data(), nullptr);
+        else
+            RETURN("Unknown argument: " + arg + NEWLINE NEWLINE BENCH_USAGE);
+    }
+
+    // Output of the benchmarked code never leaves the process
+    cfg.enable(Config::GENERAL__OUTPUT_TO_STDO);
+
+    if (max_exponent > 0)
+        return runScalingTest(filter, uint64_t(min_time_ms * 1e6), max_exponent) ? 0 : 1;
+
+    const auto corpus = readCorpus(corpus_path);
+
+    const auto content = make_shared<string>();
+
+    for (const auto &file : corpus)
+        *content += *file.second + "\n";
+
+    for (const auto &benchmark : stageBenchmarks(content))
+        Benchmark::add(benchmark.first, benchmark.second);
+
+    addMicroBenchmarks();
+    addMacroBenchmarks(corpus);
+
+    const auto results = Benchmark::run(filter, uint64_t(min_time_ms * 1e6), cout);
+
+    if (!json_path.empty()) {
+        ostringstream json;
+        Benchmark::writeJson(results, json);
+
+        !FileSystem::writeFile(json_path, json.str()) &&
+            RETURN("Couldn't write '" + json_path + "'");
+    }
+
+    if (!baseline_path.empty()) {
+        string baseline;
+
+        !FileSystem::readFile(baseline_path, baseline) &&
+            RETURN("Couldn't read '" + baseline_path + "'");
+
+        if (!Benchmark::compare(results, Benchmark::readJson(baseline), threshold, cout))
+            return 1;
+    }
+
+    return 0;
+}
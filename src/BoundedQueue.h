@@ -0,0 +1,99 @@
+/******************************************************************************
+This source file is part of the project
+HyperSheetsPreprocessor (HSPP) - Optimizer and minifier for CSS
+Copyright (C) 2019 Waldemar Zimpel <hspp@utilizer.de>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://www.gnu.org/licenses/>.
+*******************************************************************************/
+
+#ifndef BOUNDEDQUEUE_H
+#define BOUNDEDQUEUE_H
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <queue>
+using namespace std;
+
+/// Queue with limited capacity which connects a producing and
+/// a consuming thread. The producer is blocked while the queue is full,
+/// the consumer while it is empty.
+template<class T>
+class BoundedQueue final
+{
+public:
+    explicit
+    BoundedQueue(const size_t capacity);
+
+    void
+    push(T element),
+    close();
+
+    /// Returns false, if the queue is closed and all elements are taken
+    bool
+    pop(T &element);
+
+private:
+    queue<T> m_elements;
+    const size_t m_capacity;
+    bool m_closed {false};
+
+    mutex m_mutex;
+    condition_variable m_not_empty, m_not_full;
+};
+
+template<class T>
+BoundedQueue<T>::BoundedQueue(const size_t capacity) :
+    m_capacity(capacity) {}
+
+template<class T>
+void
+BoundedQueue<T>::
+push(T element)
+{
+    unique_lock<mutex> lock(m_mutex);
+    m_not_full.wait(lock, [this]() { return m_elements.size() < m_capacity; });
+
+    m_elements.emplace(move(element));
+    m_not_empty.notify_one();
+}
+
+template<class T>
+void
+BoundedQueue<T>::
+close()
+{
+    lock_guard<mutex> lock(m_mutex);
+    m_closed = true;
+    m_not_empty.notify_all();
+}
+
+template<class T>
+bool
+BoundedQueue<T>::
+pop(T &element)
+{
+    unique_lock<mutex> lock(m_mutex);
+    m_not_empty.wait(lock, [this]() { return !m_elements.empty() || m_closed; });
+
+    if (m_elements.empty())
+        return false;
+
+    element = move(m_elements.front());
+    m_elements.pop();
+    m_not_full.notify_one();
+
+    return true;
+}
+
+#endif // BOUNDEDQUEUE_H
@@ -20,6 +20,7 @@ along with this program. If not, see <https://www.gnu.org/licenses/>.
 #ifndef DATACONTAINER_H
 #define DATACONTAINER_H
 #include <algorithm>
+#include <cstdint>
 #include <functional>
 #include <vector>
 using namespace std;
@@ -109,12 +110,10 @@ DataContainer<T>::
 removeElements(const function<bool(const T &element)> &function)
 {
     // The callback function has to return true to remove the element.
-    // Iteration does't stop until the end.
+    // Iteration does't stop until the end. The remaining elements are
+    // moved only once, instead of on every removal.
 
-    iterateAll([&](const T &element) -> void {
-        if (function(element))
-            removeElement(element);
-    });
+    this->erase(std::remove_if(this->begin(), this->end(), function), this->end());
 }
 
 template<class T>
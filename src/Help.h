@@ -64,7 +64,27 @@ along with this program. If not, see <https://www.gnu.org/licenses/>.
     "    --config-file             Set the configuration file path" NEWLINE\
     "    --config-info             Show current configuration" NEWLINE\
     "    --stdo                    Use standard output" NEWLINE\
-    "                              instead of a file" DBLNEWLINE\
+    "                              instead of a file" NEWLINE\
+    "    --stats [json]            Show time and counters of each" NEWLINE\
+    "                              processing phase" NEWLINE\
+    "    --trace-file              Write the timeline of the processing" NEWLINE\
+    "                              phases to a Chrome trace event file" NEWLINE\
+    "    --size-report             Write the output size per file, rule" NEWLINE\
+    "                              and context and the bytes saved by" NEWLINE\
+    "                              each pass to a JSON file" NEWLINE\
+    "    --selector-report         Write the selectors, which are likely" NEWLINE\
+    "                              expensive for the style matching of" NEWLINE\
+    "                              browsers, to a JSON file" NEWLINE\
+    "    -O <0|1|2>                Optimization level, overrides the" NEWLINE\
+    "                              settings of the configuration file" NEWLINE\
+    "                              0: remove white space and comments" NEWLINE\
+    "                              1: also rewrite values and rules" NEWLINE\
+    "                              2: also rename identifiers and" NEWLINE\
+    "                                 restructure the stylesheet" NEWLINE\
+    "    --passes                  Show time and saved bytes of each pass" NEWLINE\
+    "    --fixpoint                Repeat restructuring passes, until" NEWLINE\
+    "                              they change nothing" NEWLINE\
+    "    --pass-budget <ms>        Stop repeating a pass after this time" DBLNEWLINE\
     "    -i                        Input file path" NEWLINE\
     "    -o                        Output directory path" DBLNEWLINE\
     "The input and output paths must differ." NEWLINE\
@@ -0,0 +1,67 @@
+/******************************************************************************
+This source file is part of the project
+HyperSheetsPreprocessor (HSPP) - Optimizer and minifier for CSS
+Copyright (C) 2019 Waldemar Zimpel <hspp@utilizer.de>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://www.gnu.org/licenses/>.
+*******************************************************************************/
+
+#include "MemoryArena.h"
+
+MemoryArena::
+MemoryArena(const size_t chunk_size) :
+    m_chunk_size(chunk_size)
+{}
+
+MemoryArena::
+~MemoryArena()
+{
+    m_chunks.iterateAll([](char *chunk) {
+        delete[] chunk;
+    });
+}
+
+void *
+MemoryArena::
+allocate(const size_t size, const size_t alignment)
+{
+    uintptr_t
+    position = reinterpret_cast<uintptr_t>(m_position),
+    aligned = (position + alignment - 1) & ~(uintptr_t(alignment) - 1);
+
+    if (!m_position || aligned + size > reinterpret_cast<uintptr_t>(m_end)) {
+        // Oversized objects get a chunk of their own
+        allocateChunk(size + alignment > m_chunk_size ? size + alignment : m_chunk_size);
+
+        position = reinterpret_cast<uintptr_t>(m_position);
+        aligned = (position + alignment - 1) & ~(uintptr_t(alignment) - 1);
+    }
+
+    m_position = reinterpret_cast<char *>(aligned + size);
+    m_bytes_allocated += size;
+
+    return reinterpret_cast<void *>(aligned);
+}
+
+void
+MemoryArena::
+allocateChunk(const size_t size)
+{
+    char *chunk = new char[size];
+
+    m_chunks.appendElement(chunk);
+    m_position = chunk;
+    m_end = chunk + size;
+    m_bytes_reserved += size;
+}
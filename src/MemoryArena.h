@@ -0,0 +1,159 @@
+/******************************************************************************
+This source file is part of the project
+HyperSheetsPreprocessor (HSPP) - Optimizer and minifier for CSS
+Copyright (C) 2019 Waldemar Zimpel <hspp@utilizer.de>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://www.gnu.org/licenses/>.
+*******************************************************************************/
+
+#ifndef MEMORYARENA_H
+#define MEMORYARENA_H
+#include "DataContainer.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+using namespace std;
+
+/// Bump allocator which hands out memory from large consecutive chunks.
+/// Objects allocated one after another end up next to each other in memory.
+/// Memory is only released at once, when the arena is destroyed.
+class MemoryArena final
+{
+public:
+    explicit
+    MemoryArena(const size_t chunk_size = 64 * 1024);
+
+    ~MemoryArena();
+
+    MemoryArena(const MemoryArena &) = delete;
+    MemoryArena &operator=(const MemoryArena &) = delete;
+
+    void
+    *allocate(const size_t size, const size_t alignment);
+
+    inline uint64_t
+    bytesAllocated() const,
+    bytesReserved() const;
+
+private:
+    void
+    allocateChunk(const size_t size);
+
+    DataContainer<char *> m_chunks;
+
+    char
+    *m_position = nullptr,
+    *m_end = nullptr;
+
+    const size_t m_chunk_size;
+    uint64_t
+    m_bytes_allocated = 0,
+    m_bytes_reserved = 0;
+};
+
+using MemoryArenaPtr = shared_ptr<MemoryArena>;
+
+inline uint64_t
+MemoryArena::
+bytesAllocated() const
+{
+    return m_bytes_allocated;
+}
+
+inline uint64_t
+MemoryArena::
+bytesReserved() const
+{
+    return m_bytes_reserved;
+}
+
+/// Allocator which can be passed to allocate_shared(). Every copy holds a
+/// reference to the arena, so it lives as long as any of its objects.
+template<class T>
+class ArenaAllocator
+{
+public:
+    using value_type = T;
+
+    explicit
+    ArenaAllocator(const MemoryArenaPtr &arena);
+
+    template<class U>
+    ArenaAllocator(const ArenaAllocator<U> &other);
+
+    T
+    *allocate(const size_t count);
+
+    inline void
+    deallocate(T *, const size_t);
+
+    inline const MemoryArenaPtr
+    &arena() const;
+
+private:
+    MemoryArenaPtr m_arena;
+};
+
+template<class T>
+ArenaAllocator<T>::
+ArenaAllocator(const MemoryArenaPtr &arena) :
+    m_arena(arena)
+{}
+
+template<class T>
+template<class U>
+ArenaAllocator<T>::
+ArenaAllocator(const ArenaAllocator<U> &other) :
+    m_arena(other.arena())
+{}
+
+template<class T>
+T *
+ArenaAllocator<T>::
+allocate(const size_t count)
+{
+    return static_cast<T *>(m_arena->allocate(count * sizeof(T), alignof(T)));
+}
+
+template<class T>
+inline void
+ArenaAllocator<T>::
+deallocate(T *, const size_t)
+{
+    // Memory is released together with the arena
+}
+
+template<class T>
+inline const MemoryArenaPtr &
+ArenaAllocator<T>::
+arena() const
+{
+    return m_arena;
+}
+
+template<class T, class U>
+inline bool
+operator==(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b)
+{
+    return a.arena() == b.arena();
+}
+
+template<class T, class U>
+inline bool
+operator!=(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b)
+{
+    return a.arena() != b.arena();
+}
+
+#endif // MEMORYARENA_H
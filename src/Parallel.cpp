@@ -0,0 +1,59 @@
+/******************************************************************************
+This source file is part of the project
+HyperSheetsPreprocessor (HSPP) - Optimizer and minifier for CSS
+Copyright (C) 2019 Waldemar Zimpel <hspp@utilizer.de>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://www.gnu.org/licenses/>.
+*******************************************************************************/
+
+#include "Parallel.h"
+#include "DataContainer.h"
+#include "config/Config.h"
+#include <atomic>
+#include <thread>
+
+/*static*/ uint32_t
+Parallel::
+threadCount()
+{
+    if (cfg.threads() != 0)
+        return cfg.threads();
+
+    const uint32_t hardware_threads = thread::hardware_concurrency();
+
+    return hardware_threads != 0 ? hardware_threads : 1;
+}
+
+/*static*/ void
+Parallel::
+forEach(const uint64_t count, const function<void(const uint64_t index)> &function)
+{
+    atomic<uint64_t> next_index {0};
+
+    const auto work = [&]() {
+        for (uint64_t index = next_index++; index < count; index = next_index++)
+            function(index);
+    };
+
+    const uint64_t thread_count = min<uint64_t>(threadCount(), count);
+    DataContainer<thread> threads;
+
+    for (uint64_t i = 1; i < thread_count; ++i)
+        threads.emplace_back(work);
+
+    work();
+
+    for (auto &worker : threads)
+        worker.join();
+}
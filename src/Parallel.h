@@ -0,0 +1,40 @@
+/******************************************************************************
+This source file is part of the project
+HyperSheetsPreprocessor (HSPP) - Optimizer and minifier for CSS
+Copyright (C) 2019 Waldemar Zimpel <hspp@utilizer.de>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://www.gnu.org/licenses/>.
+*******************************************************************************/
+
+#ifndef PARALLEL_H
+#define PARALLEL_H
+#include <cstdint>
+#include <functional>
+using namespace std;
+
+/// Runs independent work items on multiple threads
+class Parallel final
+{
+public:
+    /// Number of threads configured by the "threads" setting
+    static uint32_t
+    threadCount();
+
+    /// Calls the function once for every index in [0, count). The calling
+    /// thread takes part in the work. Returns when all calls are finished.
+    static void
+    forEach(const uint64_t count, const function<void(const uint64_t index)> &function);
+};
+
+#endif // PARALLEL_H
@@ -0,0 +1,642 @@
+/******************************************************************************
+This source file is part of the project
+HyperSheetsPreprocessor (HSPP) - Optimizer and minifier for CSS
+Copyright (C) 2019 Waldemar Zimpel <hspp@utilizer.de>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://www.gnu.org/licenses/>.
+*******************************************************************************/
+
+#include "Statistics.h"
+#include "DataContainer.h"
+#include "String.h"
+#include "defs.h"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stack>
+
+#ifdef WIN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+using namespace std::chrono;
+
+struct PhaseRecord
+{
+    uint64_t wall_time {0}, cpu_time {0}, calls {0};
+};
+
+struct FileRecord
+{
+    string name;
+    steady_clock::time_point begin;
+    PhaseRecord phases[Statistics::PHASE_COUNT];
+    uint64_t bytes_in {0}, bytes_out {0};
+    map<string, map<string, uint64_t> > counters;
+};
+
+/// Phase timer, which is running on the current thread
+struct TimerFrame
+{
+    Statistics::Phase phase;
+    uint64_t file;
+    steady_clock::time_point wall_begin;
+    uint64_t cpu_begin;
+    uint64_t nested_wall_time, nested_cpu_time;
+};
+
+static bool s_enabled = false;
+static bool s_json = false;
+static bool s_tracing = false;
+static mutex s_mutex;
+static DataContainer<FileRecord> s_files;
+static stack<uint64_t> s_file_stack;
+static thread_local stack<TimerFrame> s_timer_frames;
+
+/// Index of the file record on top of s_file_stack, read by the phase
+/// timers without locking
+constexpr uint64_t NO_FILE = UINT64_MAX;
+static atomic<uint64_t> s_current_file {NO_FILE};
+
+/// Span of a phase or of a whole file (PHASE_COUNT) in the trace
+struct TraceEvent
+{
+    uint8_t phase;
+    uint64_t file, begin, duration;
+};
+
+struct FilePhases
+{
+    PhaseRecord phases[Statistics::PHASE_COUNT];
+};
+
+/// Spans and phase times recorded by one thread. Only the owning thread
+/// appends to it, so recording doesn't need any locking. The phase times
+/// are added to the file records, when the report is written.
+struct ThreadRecord
+{
+    uint64_t thread;
+    DataContainer<TraceEvent> events;
+    /// Indexed like s_files
+    DataContainer<FilePhases> files;
+};
+
+static steady_clock::time_point s_trace_begin;
+static DataContainer<shared_ptr<ThreadRecord> > s_thread_records;
+static thread_local shared_ptr<ThreadRecord> s_thread_record;
+
+/// Returns the record of the current thread. The lock is only taken on the
+/// first call of each thread.
+static ThreadRecord &threadRecord()
+{
+    if (!s_thread_record) {
+        s_thread_record = make_shared<ThreadRecord>();
+
+        lock_guard<mutex> lock(s_mutex);
+        s_thread_record->thread = s_thread_records.size() + 1;
+        s_thread_records.emplace_back(s_thread_record);
+    }
+
+    return *s_thread_record;
+}
+
+static void addTraceEvent(const uint8_t phase, const uint64_t file,
+                          const steady_clock::time_point begin, const uint64_t duration)
+{
+    threadRecord().events.push_back({
+        phase, file, uint64_t(duration_cast<microseconds>(begin - s_trace_begin).count()), duration
+    });
+}
+
+/// CPU time of the current thread in microseconds. Other threads working
+/// at the same time aren't counted, unlike with clock().
+static uint64_t threadCpuTime()
+{
+#ifdef WIN
+    FILETIME creation_time, exit_time, kernel_time, user_time;
+
+    if (!GetThreadTimes(GetCurrentThread(), &creation_time, &exit_time, &kernel_time, &user_time))
+        return 0;
+
+    // In units of 100 nanoseconds
+    const auto ticks = [](const FILETIME &time) -> uint64_t {
+        return (uint64_t(time.dwHighDateTime) << 32) | time.dwLowDateTime;
+    };
+
+    return (ticks(kernel_time) + ticks(user_time)) / 10;
+#else
+    timespec time;
+
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time) != 0)
+        return 0;
+
+    return uint64_t(time.tv_sec) * 1000000 + uint64_t(time.tv_nsec) / 1000;
+#endif
+}
+
+static string jsonString(const string &value)
+{
+    string result = "\"";
+
+    for (const auto &chr : value) {
+        if (chr == '"' || chr == '\\')
+            result += '\\';
+
+        result += chr;
+    }
+
+    return result + '"';
+}
+
+/// Phase, which the allocations of the current thread are counted for.
+/// PHASE_COUNT stands for allocations outside of any phase.
+static thread_local uint8_t s_allocation_phase = Statistics::PHASE_COUNT;
+static thread_local uint64_t s_thread_allocated_bytes = 0;
+
+#ifdef HSPP_ALLOC_STATS
+struct AllocationCounter
+{
+    atomic<uint64_t> count, bytes, live_bytes, peak_live_bytes;
+};
+
+/// Counters of each phase, the last one counts allocations outside of any phase
+static AllocationCounter s_allocations[Statistics::PHASE_COUNT + 1];
+static AllocationCounter s_total_allocations;
+
+/// Stored in front of every allocated memory block, so that the
+/// deallocation can be subtracted from the counters it was added to
+struct AllocationHeader
+{
+    uint64_t size;
+    uint8_t phase;
+};
+
+constexpr size_t ALLOCATION_HEADER_SIZE = sizeof(AllocationHeader) > alignof(max_align_t)
+                                          ? sizeof(AllocationHeader) : alignof(max_align_t);
+
+static void addAllocation(AllocationCounter &counter, const uint64_t size)
+{
+    counter.count.fetch_add(1, memory_order_relaxed);
+    counter.bytes.fetch_add(size, memory_order_relaxed);
+
+    const uint64_t live_bytes = counter.live_bytes.fetch_add(size, memory_order_relaxed) + size;
+    uint64_t peak_live_bytes = counter.peak_live_bytes.load(memory_order_relaxed);
+
+    while (live_bytes > peak_live_bytes &&
+           !counter.peak_live_bytes.compare_exchange_weak(peak_live_bytes, live_bytes, memory_order_relaxed));
+}
+
+static void writeAllocations(ostream &stream, const bool json)
+{
+    if (json) {
+        stream << ",\"allocations\":{\"peak_live_bytes\":"
+               << s_total_allocations.peak_live_bytes.load() << ",\"phases\":{";
+
+        for (uint8_t phase = 0; phase <= Statistics::PHASE_COUNT; ++phase) {
+            const auto &counter = s_allocations[phase];
+
+            stream << (phase != 0 ? "," : "") << "\"" << Statistics::phaseName(Statistics::Phase(phase))
+                   << "\":{\"count\":" << counter.count.load()
+                   << ",\"bytes\":" << counter.bytes.load()
+                   << ",\"peak_live_bytes\":" << counter.peak_live_bytes.load() << "}";
+        }
+
+        stream << "}}";
+        return;
+    }
+
+    const auto alignRight = [](const string &value, const uint64_t width) -> string {
+        return value.length() < width ? String::repeatChar(' ', width - value.length()) + value : value;
+    };
+
+    stream << "Allocations" NEWLINE
+           << "    Phase           " << alignRight("Count", 12) << alignRight("Bytes", 14)
+           << alignRight("Peak live bytes", 18) << NEWLINE;
+
+    for (uint8_t phase = 0; phase <= Statistics::PHASE_COUNT; ++phase) {
+        const auto &counter = s_allocations[phase];
+        const string name = Statistics::phaseName(Statistics::Phase(phase));
+
+        stream << "    " << name << String::repeatChar(' ', 16 - name.length())
+               << alignRight(to_string(counter.count.load()), 12)
+               << alignRight(to_string(counter.bytes.load()), 14)
+               << alignRight(to_string(counter.peak_live_bytes.load()), 18) << NEWLINE;
+    }
+
+    stream << "    Peak live bytes of all phases: " << s_total_allocations.peak_live_bytes.load() << NEWLINE LINE;
+}
+#endif
+
+/// Returns the index of the file record, the counters are added to.
+/// s_mutex has to be locked.
+static uint64_t currentFile()
+{
+    if (s_file_stack.empty()) {
+        s_file_stack.push(s_files.size());
+        s_files.emplace_back();
+        s_current_file = s_file_stack.top();
+    }
+
+    return s_file_stack.top();
+}
+
+/// Adds the phase times, which the threads have recorded, to the file
+/// records. s_mutex has to be locked and no phase may be running on
+/// other threads.
+static void mergeThreadRecords()
+{
+    for (const auto &thread_record : s_thread_records) {
+        for (uint64_t file = 0; file < thread_record->files.size(); ++file)
+            for (uint8_t phase = 0; phase < Statistics::PHASE_COUNT; ++phase) {
+                const auto &source = thread_record->files.at(file).phases[phase];
+                auto &target = s_files.at(file).phases[phase];
+
+                target.wall_time += source.wall_time;
+                target.cpu_time += source.cpu_time;
+                target.calls += source.calls;
+            }
+
+        thread_record->files.clear();
+    }
+}
+
+Statistics::PhaseTimer::PhaseTimer(const Phase phase) :
+    m_running(s_enabled || s_tracing)
+{
+    if (!m_running) return;
+
+    auto file = s_current_file.load();
+
+    // Only the first phase outside of any file creates a record for it
+    if (file == NO_FILE) {
+        lock_guard<mutex> lock(s_mutex);
+        file = currentFile();
+    }
+
+    s_timer_frames.push({phase, file, steady_clock::now(), threadCpuTime(), 0, 0});
+    s_allocation_phase = phase;
+}
+
+Statistics::PhaseTimer::~PhaseTimer()
+{
+    stop();
+}
+
+void
+Statistics::PhaseTimer::
+stop()
+{
+    if (!m_running) return;
+
+    m_running = false;
+
+    const auto frame = s_timer_frames.top();
+    s_timer_frames.pop();
+    s_allocation_phase = s_timer_frames.empty() ? PHASE_COUNT : s_timer_frames.top().phase;
+
+    const uint64_t wall_time = uint64_t(duration_cast<microseconds>(steady_clock::now() - frame.wall_begin).count());
+    const uint64_t cpu_end = threadCpuTime();
+    const uint64_t cpu_time = cpu_end - min(cpu_end, frame.cpu_begin);
+
+    if (s_tracing)
+        addTraceEvent(frame.phase, frame.file, frame.wall_begin, wall_time);
+
+    // The enclosing phase doesn't count the time of this one
+    if (!s_timer_frames.empty()) {
+        s_timer_frames.top().nested_wall_time += wall_time;
+        s_timer_frames.top().nested_cpu_time += cpu_time;
+    }
+
+    if (!s_enabled) return;
+
+    auto &files = threadRecord().files;
+
+    if (files.size() <= frame.file)
+        files.resize(frame.file + 1);
+
+    auto &record = files.at(frame.file).phases[frame.phase];
+
+    record.wall_time += wall_time - min(wall_time, frame.nested_wall_time);
+    record.cpu_time += cpu_time - min(cpu_time, frame.nested_cpu_time);
+    ++record.calls;
+}
+
+/*static*/ void
+Statistics::
+enable(const bool json)
+{
+    s_enabled = true;
+    s_json = json;
+}
+
+/*static*/ void
+Statistics::
+enableTrace()
+{
+    s_tracing = true;
+    s_trace_begin = steady_clock::now();
+}
+
+/*static*/ bool
+Statistics::
+isEnabled()
+{
+    return s_enabled;
+}
+
+/*static*/ uint64_t
+Statistics::
+threadAllocatedBytes()
+{
+    return s_thread_allocated_bytes;
+}
+
+/*static*/ void
+Statistics::
+beginFile(const string &file_name)
+{
+    if (!s_enabled && !s_tracing) return;
+
+    lock_guard<mutex> lock(s_mutex);
+
+    s_file_stack.push(s_files.size());
+    s_files.emplace_back();
+    s_files.back().name = file_name;
+    s_files.back().begin = steady_clock::now();
+    s_current_file = s_file_stack.top();
+}
+
+/*static*/ void
+Statistics::
+endFile()
+{
+    if (!s_enabled && !s_tracing) return;
+
+    uint64_t file;
+    steady_clock::time_point begin;
+
+    {
+        lock_guard<mutex> lock(s_mutex);
+
+        if (s_file_stack.empty())
+            return;
+
+        file = s_file_stack.top();
+        begin = s_files.at(file).begin;
+        s_file_stack.pop();
+        s_current_file = s_file_stack.empty() ? NO_FILE : s_file_stack.top();
+    }
+
+    if (s_tracing)
+        addTraceEvent(PHASE_COUNT, file, begin,
+                      uint64_t(duration_cast<microseconds>(steady_clock::now() - begin).count()));
+}
+
+/*static*/ void
+Statistics::
+addBytesIn(const uint64_t bytes)
+{
+    if (!s_enabled) return;
+
+    lock_guard<mutex> lock(s_mutex);
+    s_files.at(currentFile()).bytes_in += bytes;
+}
+
+/*static*/ void
+Statistics::
+addBytesOut(const uint64_t bytes)
+{
+    if (!s_enabled) return;
+
+    lock_guard<mutex> lock(s_mutex);
+    s_files.at(currentFile()).bytes_out += bytes;
+}
+
+/*static*/ void
+Statistics::
+addCount(const string &group, const string &name, const uint64_t count)
+{
+    if (!s_enabled) return;
+
+    lock_guard<mutex> lock(s_mutex);
+    s_files.at(currentFile()).counters[group][name] += count;
+}
+
+/*static*/ void
+Statistics::
+writeTrace(ostream &stream)
+{
+    lock_guard<mutex> lock(s_mutex);
+
+    stream << "{\"traceEvents\":[{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,"
+              "\"args\":{\"name\":\"" APP_NAME "\"}}";
+
+    for (const auto &thread_record : s_thread_records) {
+        for (const auto &event : thread_record->events) {
+            const auto &file_name = s_files.at(event.file).name;
+
+            stream << ",{\"name\":" << jsonString(event.phase == PHASE_COUNT ? file_name : phaseName(Phase(event.phase)))
+                   << ",\"cat\":\"" << (event.phase == PHASE_COUNT ? "file" : "phase")
+                   << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread_record->thread
+                   << ",\"ts\":" << event.begin << ",\"dur\":" << event.duration
+                   << ",\"args\":{\"file\":" << jsonString(file_name) << "}}";
+        }
+    }
+
+    stream << "],\"displayTimeUnit\":\"ms\"}" << endl;
+}
+
+/*static*/ const char *
+Statistics::
+phaseName(const Phase phase)
+{
+    static const char *const names[] = {
+        "read", "tokenize", "parse", "modify", "restructure", "generate", "write", "other"
+    };
+
+    return names[phase];
+}
+
+/*static*/ void
+Statistics::
+writeReport(ostream &stream, const uint64_t total_wall_time)
+{
+    lock_guard<mutex> lock(s_mutex);
+    mergeThreadRecords();
+
+    if (s_json) {
+        stream << "{\"total_wall_time_us\":" << total_wall_time << ",\"files\":[";
+
+        for (const auto &file : s_files) {
+            stream << "{\"name\":" << jsonString(file.name)
+                   << ",\"bytes_in\":" << file.bytes_in
+                   << ",\"bytes_out\":" << file.bytes_out
+                   << ",\"phases\":{";
+
+            for (uint8_t phase = 0; phase < PHASE_COUNT; ++phase) {
+                const auto &record = file.phases[phase];
+
+                stream << (phase != 0 ? "," : "") << jsonString(phaseName(Phase(phase)))
+                       << ":{\"wall_time_us\":" << record.wall_time
+                       << ",\"cpu_time_us\":" << record.cpu_time
+                       << ",\"calls\":" << record.calls << "}";
+            }
+
+            stream << "}";
+
+            for (const auto &group : file.counters) {
+                stream << "," << jsonString(group.first) << ":{";
+
+                for (auto counter = group.second.begin(); counter != group.second.end(); ++counter)
+                    stream << (counter != group.second.begin() ? "," : "")
+                           << jsonString(counter->first) << ":" << counter->second;
+
+                stream << "}";
+            }
+
+            stream << "}" << (&file != &s_files.back() ? "," : "");
+        }
+
+        stream << "]";
+#ifdef HSPP_ALLOC_STATS
+        writeAllocations(stream, true);
+#endif
+        stream << "}" << endl;
+        return;
+    }
+
+    const auto milliseconds = [](const uint64_t microseconds) -> string {
+        return String::numberFormat(microseconds / 1e3, 3) + "ms";
+    };
+
+    const auto alignRight = [](const string &value, const uint64_t width) -> string {
+        return value.length() < width ? String::repeatChar(' ', width - value.length()) + value : value;
+    };
+
+    const auto alignLeft = [](const string &value, const uint64_t width) -> string {
+        return value.length() < width ? value + String::repeatChar(' ', width - value.length()) : value;
+    };
+
+    stream << NEWLINE "Statistics:" NEWLINE LINE;
+
+    for (const auto &file : s_files) {
+        stream << (file.name.empty() ? "(unnamed)" : file.name) << NEWLINE
+               << "    Input:  " << file.bytes_in << " bytes" NEWLINE
+               << "    Output: " << file.bytes_out << " bytes" DBLNEWLINE
+               << "    " << alignLeft("Phase", 16) << alignRight("Wall time", 14)
+               << alignRight("CPU time", 14) << alignRight("Calls", 8) << NEWLINE;
+
+        for (uint8_t phase = 0; phase < PHASE_COUNT; ++phase) {
+            const auto &record = file.phases[phase];
+
+            stream << "    " << alignLeft(phaseName(Phase(phase)), 16)
+                   << alignRight(milliseconds(record.wall_time), 14)
+                   << alignRight(milliseconds(record.cpu_time), 14)
+                   << alignRight(to_string(record.calls), 8) << NEWLINE;
+        }
+
+        for (const auto &group : file.counters) {
+            stream << NEWLINE "    " << group.first << NEWLINE;
+
+            for (const auto &counter : group.second)
+                stream << "        " << alignLeft(counter.first, 30)
+                       << alignRight(to_string(counter.second), 12) << NEWLINE;
+        }
+
+        stream << LINE;
+    }
+
+#ifdef HSPP_ALLOC_STATS
+    writeAllocations(stream, false);
+#endif
+
+    stream << "Total wall time: " << milliseconds(total_wall_time) << NEWLINE
+           << "Times of phases running on several threads at once are summed up." NEWLINE << endl;
+}
+
+#ifdef HSPP_ALLOC_STATS
+// Replacements of the global allocation functions, which count every
+// allocation for the phase running on the allocating thread
+
+void *operator new(size_t size)
+{
+    auto *memory = static_cast<char *>(malloc(size + ALLOCATION_HEADER_SIZE));
+
+    if (memory == nullptr)
+        throw bad_alloc();
+
+    const auto phase = s_allocation_phase;
+    new (memory) AllocationHeader {size, phase};
+
+    addAllocation(s_allocations[phase], size);
+    addAllocation(s_total_allocations, size);
+    s_thread_allocated_bytes += size;
+
+    return memory + ALLOCATION_HEADER_SIZE;
+}
+
+void operator delete(void *pointer) noexcept
+{
+    if (pointer == nullptr) return;
+
+    auto *memory = static_cast<char *>(pointer) - ALLOCATION_HEADER_SIZE;
+    const auto *header = reinterpret_cast<const AllocationHeader *>(memory);
+
+    s_allocations[header->phase].live_bytes.fetch_sub(header->size, memory_order_relaxed);
+    s_total_allocations.live_bytes.fetch_sub(header->size, memory_order_relaxed);
+
+    free(memory);
+}
+
+void *operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete[](void *pointer) noexcept
+{
+    operator delete(pointer);
+}
+
+void *operator new(size_t size, const nothrow_t &) noexcept
+{
+    try {
+        return operator new(size);
+    } catch (const bad_alloc &) {
+        return nullptr;
+    }
+}
+
+void *operator new[](size_t size, const nothrow_t &) noexcept
+{
+    return operator new(size, nothrow);
+}
+
+void operator delete(void *pointer, const nothrow_t &) noexcept
+{
+    operator delete(pointer);
+}
+
+void operator delete[](void *pointer, const nothrow_t &) noexcept
+{
+    operator delete(pointer);
+}
+#endif
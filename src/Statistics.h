@@ -0,0 +1,90 @@
+/******************************************************************************
+This source file is part of the project
+HyperSheetsPreprocessor (HSPP) - Optimizer and minifier for CSS
+Copyright (C) 2019 Waldemar Zimpel <hspp@utilizer.de>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://www.gnu.org/licenses/>.
+*******************************************************************************/
+
+#ifndef STATISTICS_H
+#define STATISTICS_H
+#include <cstdint>
+#include <ostream>
+#include <string>
+using namespace std;
+
+/// Collects timings and counters of the processing phases, which are
+/// reported with the command line argument '--stats', and records the
+/// phases as spans for '--trace-file'
+class Statistics final
+{
+public:
+    enum Phase : uint8_t {
+        READ, TOKENIZE, PARSE, MODIFY, RESTRUCTURE, GENERATE, WRITE, PHASE_COUNT
+    };
+
+    /// Measures the wall time and the CPU time of the current thread from its
+    /// construction until stop() is called or it is destructed. The time of
+    /// phases measured within is not counted twice.
+    class PhaseTimer final
+    {
+    public:
+        explicit
+        PhaseTimer(const Phase phase);
+        ~PhaseTimer();
+
+        PhaseTimer(const PhaseTimer &) = delete;
+        PhaseTimer &operator=(const PhaseTimer &) = delete;
+
+        void
+        stop();
+
+    private:
+        bool m_running;
+    };
+
+    /// Enables collecting. The report is written as JSON, if json is true.
+    static void
+    enable(const bool json = false),
+
+    /// Records a span for every phase and file from now on
+    enableTrace(),
+
+    /// Counts the following phases and counters for the file,
+    /// until endFile() is called
+    beginFile(const string &file_name),
+    endFile(),
+
+    addBytesIn(const uint64_t bytes),
+    addBytesOut(const uint64_t bytes),
+    addCount(const string &group, const string &name, const uint64_t count = 1),
+
+    writeReport(ostream &stream, const uint64_t total_wall_time),
+
+    /// Writes the recorded spans in the Chrome trace event format
+    writeTrace(ostream &stream);
+
+    static bool
+    isEnabled();
+
+    /// Bytes allocated through operator new by the current thread so far.
+    /// Allocations are only counted, if built with HSPP_ALLOC_STATS.
+    static uint64_t
+    threadAllocatedBytes();
+
+    static const char *
+    phaseName(const Phase phase);
+};
+
+#endif // STATISTICS_H
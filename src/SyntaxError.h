@@ -0,0 +1,79 @@
+/******************************************************************************
+This source file is part of the project
+HyperSheetsPreprocessor (HSPP) - Optimizer and minifier for CSS
+Copyright (C) 2019 Waldemar Zimpel <hspp@utilizer.de>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://www.gnu.org/licenses/>.
+*******************************************************************************/
+
+#ifndef SYNTAXERROR_H
+#define SYNTAXERROR_H
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+using namespace std;
+
+/// Error in an input file, which the tokenizers and parsers report. While
+/// worker threads tokenize and parse parts of a file, printing the report
+/// and ending the program on one of them would race with the others, so
+/// the error is thrown instead and reported by the calling thread.
+class SyntaxError final : public runtime_error
+{
+public:
+    explicit
+    SyntaxError(const string &report) : runtime_error(report) {}
+
+    /// Errors raised on the current thread are thrown during the lifetime
+    /// of the scope instead of ending the program
+    class DeferScope final
+    {
+    public:
+        DeferScope() : m_deferred(isDeferred()) { isDeferred() = true; }
+        ~DeferScope() { isDeferred() = m_deferred; }
+
+    private:
+        const bool m_deferred;
+    };
+
+    /// Prints the report and ends the program, or throws the error within
+    /// a DeferScope
+    [[noreturn]] static void
+    raise(const string &report);
+
+private:
+    static bool &
+    isDeferred();
+};
+
+inline /*static*/ void
+SyntaxError::
+raise(const string &report)
+{
+    if (isDeferred())
+        throw SyntaxError(report);
+
+    cout << report << flush;
+    exit(1);
+}
+
+inline /*static*/ bool &
+SyntaxError::
+isDeferred()
+{
+    static thread_local bool deferred = false;
+    return deferred;
+}
+
+#endif // SYNTAXERROR_H
@@ -31,11 +31,22 @@ Config::Config() : m_bool_settings(0)
 
     const uint8_t TAB_WIDTH = 4;
 
+    /// Number of threads used for parsing, modifying and generating
+    /// large stylesheets. 0 uses one thread per available CPU core.
+    const uint8_t THREADS = 1;
+
     /// Default comment terms. Comments containing this terms are kept.
     const DataContainer<string> CSS_COMMENT_TERMS {
         "copyright", "license"
     };
 
+    /// Default browser targets, pairs of a browser and its oldest supported
+    /// version. Vendor prefixes, which none of them needs, are removed.
+    const DataContainer<string> CSS_BROWSER_TARGETS {
+        "chrome", "109", "edge", "109", "firefox", "115", "safari", "15.6",
+        "ios_saf", "15.6", "opera", "95", "samsung", "20"
+    };
+
     /// Default minification settings
     constexpr uint32_t DEFAULT_BOOL_SETTINGS =
         (1U << (Config::CSS__REMOVE_COMMENTS - 1U)) |
@@ -56,8 +67,10 @@ Config::Config() : m_bool_settings(0)
 
     setListSetting(GENERAL__CSS_FILE_EXTENSIONS, CSS_FILE_EXTENSIONS);
     setNumericSetting(GENERAL__TAB_WIDTH, TAB_WIDTH);
+    setNumericSetting(GENERAL__THREADS, THREADS);
 
     setListSetting(CSS__COMMENT_TERMS, CSS_COMMENT_TERMS);
+    setListSetting(CSS__BROWSER_TARGETS, CSS_BROWSER_TARGETS);
     setBoolSettings(DEFAULT_BOOL_SETTINGS);
 }
 
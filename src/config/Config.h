@@ -38,6 +38,7 @@ public:
         GENERAL__USE_UTF8_BOM                       ,
         GENERAL__CREATE_JSON_FILE                   ,
         GENERAL__BEAUTIFY_OUTPUT                    ,
+        GENERAL__PIPELINE                           ,
         CSS__INCLUDE_EXTERNAL_STYLESHEETS           ,
         CSS__REMOVE_COMMENTS                        ,
         CSS__MINIFY_NUMBERS                         ,
@@ -51,6 +52,15 @@ public:
         CSS__REWRITE_FUNCTIONS                      ,
         CSS__REMOVE_EMPTY_RULES                     ,
         CSS__MERGE_MEDIA_RULES                      ,
+        CSS__MERGE_RULES                            ,
+        CSS__MERGE_LONGHANDS                        ,
+        CSS__REMOVE_OVERRIDDEN_DECLARATIONS         ,
+        CSS__REMOVE_UNUSED_DEFINITIONS              ,
+        CSS__INLINE_CUSTOM_PROPERTIES               ,
+        CSS__SIMPLIFY_MATH_FUNCTIONS                ,
+        CSS__REWRITE_VALUES                         ,
+        CSS__REMOVE_VENDOR_PREFIXES                 ,
+        CSS__EVALUATE_SUPPORTS                      ,
 
         // string settings
         GENERAL__INPUT_WORKING_DIRECTORY            ,
@@ -62,10 +72,13 @@ public:
         GENERAL__PHP_CUSTOM_PROPERTY_ARRAY_NAME     ,
         GENERAL__PHP_ANIMATION_ARRAY_NAME           ,
         GENERAL__TAB_WIDTH                          ,
+        GENERAL__THREADS                            ,
 
         // list settings
         GENERAL__CSS_FILE_EXTENSIONS                ,
-        CSS__COMMENT_TERMS
+        CSS__COMMENT_TERMS                          ,
+        CSS__KEEP_DEFINITIONS                       ,
+        CSS__BROWSER_TARGETS
     };
 
     Config();
@@ -84,6 +97,7 @@ public:
     setJsonCustomPropertyObjectName(const string &name),
     setJsonAnimationObjectName(const string &name),
     setTabWidth(const uint8_t tab_width),
+    setThreads(const uint8_t threads),
     enable(const Setting setting),
     disable(const Setting setting),
     setUsingPipingFlag();
@@ -97,7 +111,9 @@ public:
 
     inline const DataContainer<string>
     cssFileExtensions() const,
-    cssCommentTerms() const;
+    cssCommentTerms() const,
+    cssKeepDefinitions() const,
+    cssBrowserTargets() const;
 
     inline const string
     &configFilePath() const,
@@ -111,7 +127,8 @@ public:
     &jsonAnimationObjectName() const;
 
     inline uint8_t
-    tabWidth() const;
+    tabWidth() const,
+    threads() const;
 
     inline bool
     isRead() const;
@@ -176,6 +193,7 @@ private:
                 { "general_use_utf8_bom",                   Config::GENERAL__USE_UTF8_BOM },
                 { "general_create_json_file",               Config::GENERAL__CREATE_JSON_FILE },
                 { "general_beautify_output",                Config::GENERAL__BEAUTIFY_OUTPUT },
+                { "general_pipeline",                       Config::GENERAL__PIPELINE },
 
                 { "css_include_external_stylesheets",       Config::CSS__INCLUDE_EXTERNAL_STYLESHEETS },
                 { "css_remove_comments",                    Config::CSS__REMOVE_COMMENTS },
@@ -189,7 +207,16 @@ private:
                 { "css_minify_animation_names",             Config::CSS__MINIFY_ANIMATION_NAMES },
                 { "css_rewrite_functions",                  Config::CSS__REWRITE_FUNCTIONS },
                 { "css_remove_empty_rules",                 Config::CSS__REMOVE_EMPTY_RULES },
-                { "css_merge_media_rules",                  Config::CSS__MERGE_MEDIA_RULES }
+                { "css_merge_media_rules",                  Config::CSS__MERGE_MEDIA_RULES },
+                { "css_merge_rules",                        Config::CSS__MERGE_RULES },
+                { "css_merge_longhands",                    Config::CSS__MERGE_LONGHANDS },
+                { "css_remove_overridden_declarations",     Config::CSS__REMOVE_OVERRIDDEN_DECLARATIONS },
+                { "css_remove_unused_definitions",          Config::CSS__REMOVE_UNUSED_DEFINITIONS },
+                { "css_inline_custom_properties",           Config::CSS__INLINE_CUSTOM_PROPERTIES },
+                { "css_simplify_math_functions",            Config::CSS__SIMPLIFY_MATH_FUNCTIONS },
+                { "css_rewrite_values",                     Config::CSS__REWRITE_VALUES },
+                { "css_remove_vendor_prefixes",             Config::CSS__REMOVE_VENDOR_PREFIXES },
+                { "css_evaluate_supports",                  Config::CSS__EVALUATE_SUPPORTS }
             }),
             string_settings({
                 { "general_input_working_directory",        Config::GENERAL__INPUT_WORKING_DIRECTORY },
@@ -203,10 +230,13 @@ private:
             }),
             list_settings({
                 { "general_css_file_extensions",            Config::GENERAL__CSS_FILE_EXTENSIONS },
-                { "css_comment_terms",                      Config::CSS__COMMENT_TERMS }
+                { "css_comment_terms",                      Config::CSS__COMMENT_TERMS },
+                { "css_keep_definitions",                   Config::CSS__KEEP_DEFINITIONS },
+                { "css_browser_targets",                    Config::CSS__BROWSER_TARGETS }
             }),
             numeric_settings({
-                { "general_tab_width",                      Config::GENERAL__TAB_WIDTH }
+                { "general_tab_width",                      Config::GENERAL__TAB_WIDTH },
+                { "general_threads",                        Config::GENERAL__THREADS }
             }) {}
 
         const DataContainer<string>
@@ -259,6 +289,20 @@ cssCommentTerms() const
     return m_list_settings.find(CSS__COMMENT_TERMS)->second;
 }
 
+inline const DataContainer<string>
+Config::
+cssKeepDefinitions() const
+{
+    return m_list_settings.find(CSS__KEEP_DEFINITIONS)->second;
+}
+
+inline const DataContainer<string>
+Config::
+cssBrowserTargets() const
+{
+    return m_list_settings.find(CSS__BROWSER_TARGETS)->second;
+}
+
 inline const string &
 Config::
 configFilePath() const
@@ -378,6 +422,20 @@ tabWidth() const
     return m_numeric_settings.find(GENERAL__TAB_WIDTH)->second;
 }
 
+inline void
+Config::
+setThreads(const uint8_t threads)
+{
+    setNumericSetting(GENERAL__THREADS, threads);
+}
+
+inline uint8_t
+Config::
+threads() const
+{
+    return m_numeric_settings.find(GENERAL__THREADS)->second;
+}
+
 inline void
 Config::
 setUsingPipingFlag()
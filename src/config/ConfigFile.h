@@ -67,7 +67,9 @@ inline void writeConfigFile()
         "json_animation_object_name     = anims\n\n"
 
         "use_utf8_bom                   = " + boolSettingValue(Config::GENERAL__USE_UTF8_BOM) + "\n"
-        "tab_width                      = " + to_string(cfg.tabWidth()) + "\n\n"
+        "tab_width                      = " + to_string(cfg.tabWidth()) + "\n"
+        "threads                        = " + to_string(cfg.threads()) + "\n"
+        "pipeline                       = " + boolSettingValue(Config::GENERAL__PIPELINE) + "\n\n"
 
         "[css]\n"
         "include_external_stylesheets   = " + boolSettingValue(Config::CSS__INCLUDE_EXTERNAL_STYLESHEETS) + "\n\n"
@@ -84,8 +86,19 @@ inline void writeConfigFile()
         "minify_custom_properties       = " + boolSettingValue(Config::CSS__MINIFY_CUSTOM_PROPERTIES) + "\n"
         "minify_animation_names         = " + boolSettingValue(Config::CSS__MINIFY_ANIMATION_NAMES) + "\n"
         "rewrite_functions              = " + boolSettingValue(Config::CSS__REWRITE_FUNCTIONS) + "\n"
+        "simplify_math_functions        = " + boolSettingValue(Config::CSS__SIMPLIFY_MATH_FUNCTIONS) + "\n"
+        "rewrite_values                 = " + boolSettingValue(Config::CSS__REWRITE_VALUES) + "\n"
+        "remove_vendor_prefixes         = " + boolSettingValue(Config::CSS__REMOVE_VENDOR_PREFIXES) + "\n"
+        "browser_targets                = " + writeListValues(cfg.cssBrowserTargets()) + "\n"
+        "evaluate_supports              = " + boolSettingValue(Config::CSS__EVALUATE_SUPPORTS) + "\n"
+        "remove_overridden_declarations = " + boolSettingValue(Config::CSS__REMOVE_OVERRIDDEN_DECLARATIONS) + "\n"
+        "merge_longhands                = " + boolSettingValue(Config::CSS__MERGE_LONGHANDS) + "\n"
         "remove_empty_rules             = " + boolSettingValue(Config::CSS__REMOVE_EMPTY_RULES) + "\n"
-        "merge_media_rules              = " + boolSettingValue(Config::CSS__MERGE_MEDIA_RULES);
+        "inline_custom_properties       = " + boolSettingValue(Config::CSS__INLINE_CUSTOM_PROPERTIES) + "\n"
+        "remove_unused_definitions      = " + boolSettingValue(Config::CSS__REMOVE_UNUSED_DEFINITIONS) + "\n"
+        "keep_definitions               = " + writeListValues(cfg.cssKeepDefinitions()) + "\n"
+        "merge_media_rules              = " + boolSettingValue(Config::CSS__MERGE_MEDIA_RULES) + "\n"
+        "merge_rules                    = " + boolSettingValue(Config::CSS__MERGE_RULES);
 
     FileSystemWorker::writeFile(CONFIG_FILE_PATH, config_file_content);
 }
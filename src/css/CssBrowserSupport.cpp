@@ -0,0 +1,408 @@
+/******************************************************************************
+This source file is part of the project
+HyperSheetsPreprocessor (HSPP) - Optimizer and minifier for CSS
+Copyright (C) 2019 Waldemar Zimpel <hspp@utilizer.de>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://www.gnu.org/licenses/>.
+*******************************************************************************/
+
+#include "CssBrowserSupport.h"
+#include "../config/Config.h"
+#include "../HashTable.h"
+#include "../String.h"
+#include <algorithm>
+#include <functional>
+
+using namespace CSS;
+
+enum Browser : uint8_t {
+    CHROME, EDGE, FIREFOX, IE, IOS_SAF, OPERA, SAFARI, SAMSUNG, BROWSER_COUNT
+};
+
+/// Names of the browsers in the setting browser_targets
+static const char *const s_browser_names[BROWSER_COUNT] = {
+    "chrome", "edge", "firefox", "ie", "ios_saf", "opera", "safari", "samsung"
+};
+
+/// Versions of a browser, which understand names with a vendor prefix
+struct PrefixRange
+{
+    Browser browser;
+    const char *prefix;
+    const char *since;
+    /// First version, which doesn't understand the prefix anymore. Empty,
+    /// if all later versions understand it.
+    const char *until;
+};
+
+static const PrefixRange s_prefix_ranges[] = {
+    {CHROME,  "-webkit-", "0",  ""},
+    {EDGE,    "-ms-",     "0",  "79"},
+    {EDGE,    "-webkit-", "0",  ""},
+    {FIREFOX, "-moz-",    "0",  ""},
+    {FIREFOX, "-webkit-", "49", ""},
+    {IE,      "-ms-",     "0",  ""},
+    {IOS_SAF, "-webkit-", "0",  ""},
+    {OPERA,   "-o-",      "0",  "15"},
+    {OPERA,   "-webkit-", "15", ""},
+    {SAFARI,  "-webkit-", "0",  ""},
+    {SAMSUNG, "-webkit-", "0",  ""}
+};
+
+/// Names of a feature and the first versions of each browser, which
+/// understand them without prefix. Versions are empty for browsers, which
+/// don't understand them or still need the prefix.
+/// https://caniuse.com
+struct Feature
+{
+    const char *names[16];
+    /// In the order of the enum Browser
+    const char *unprefixed[BROWSER_COUNT];
+};
+
+/// Properties, values and at-rules, which once needed vendor prefixes
+static const Feature s_prefixed_features[] = {
+    // chrome, edge, firefox, ie, ios_saf, opera, safari, samsung
+    {{"transition", "transition-property", "transition-duration", "transition-timing-function",
+      "transition-delay"},
+     {"26", "12", "16", "10", "9", "12.1", "9", "1.5"}},
+    {{"transform", "transform-origin", "perspective", "perspective-origin"},
+     {"36", "12", "16", "10", "9", "23", "9", "3"}},
+    {{"transform-style"},
+     {"36", "12", "16", "", "9", "23", "9", "3"}},
+    {{"backface-visibility"},
+     {"36", "12", "16", "10", "15.4", "23", "15.4", "3"}},
+    {{"animation", "animation-name", "animation-duration", "animation-timing-function",
+      "animation-delay", "animation-iteration-count", "animation-direction",
+      "animation-fill-mode", "animation-play-state", "keyframes"},
+     {"43", "12", "16", "10", "9", "30", "9", "4"}},
+    {{"border-radius", "border-top-left-radius", "border-top-right-radius",
+      "border-bottom-right-radius", "border-bottom-left-radius", "box-shadow"},
+     {"10", "12", "4", "9", "5", "10.5", "5.1", "1"}},
+    {{"background-size", "background-origin"},
+     {"4", "12", "4", "9", "5", "10.5", "5", "1"}},
+    {{"box-sizing"},
+     {"10", "12", "29", "8", "6", "10", "5.1", "1"}},
+    {{"columns", "column-count", "column-gap", "column-rule", "column-rule-color",
+      "column-rule-style", "column-rule-width", "column-width", "column-fill", "column-span"},
+     {"50", "12", "52", "10", "9", "37", "9", "5"}},
+    {{"flex", "flex-direction", "flex-wrap", "flex-flow", "flex-grow", "flex-shrink",
+      "flex-basis", "justify-content", "align-items", "align-self", "align-content", "order",
+      "inline-flex"},
+     {"29", "12", "28", "11", "9", "17", "9", "2"}},
+    {{"user-select"},
+     {"54", "79", "69", "", "", "41", "", "6.2"}},
+    {{"appearance"},
+     {"84", "84", "80", "", "15.4", "70", "15.4", "14"}},
+    {{"hyphens"},
+     {"88", "79", "43", "", "17", "74", "17", "15"}},
+    {{"filter"},
+     {"53", "12", "35", "", "9.3", "40", "9.1", "6.2"}},
+    {{"clip-path"},
+     {"55", "79", "3.5", "", "13.4", "42", "13.1", "6.2"}},
+    {{"tab-size"},
+     {"21", "79", "91", "", "7", "15", "7", "1.5"}},
+    {{"font-feature-settings"},
+     {"48", "12", "34", "10", "9.3", "35", "9.1", "5"}},
+    {{"backdrop-filter"},
+     {"76", "79", "103", "", "18", "63", "18", "12"}},
+    {{"mask", "mask-image", "mask-size", "mask-position", "mask-repeat", "mask-origin",
+      "mask-clip", "mask-composite", "mask-mode"},
+     {"120", "120", "53", "", "15.4", "106", "15.4", "25"}},
+    {{"text-overflow"},
+     {"1", "12", "7", "6", "2", "11", "1.3", "1"}},
+    {{"linear-gradient", "radial-gradient", "repeating-linear-gradient",
+      "repeating-radial-gradient"},
+     {"26", "12", "16", "10", "7", "12.1", "7", "1.5"}},
+    {{"calc"},
+     {"26", "12", "16", "9", "7", "15", "7", "1.5"}},
+    {{"sticky"},
+     {"56", "16", "32", "", "13", "42", "13", "6.2"}},
+    {{"min-content", "max-content", "fit-content"},
+     {"46", "79", "66", "", "11", "33", "11", "5"}},
+    {{"grab", "grabbing"},
+     {"68", "14", "27", "", "11", "55", "11", "10.1"}},
+    {{"zoom-in", "zoom-out"},
+     {"37", "12", "24", "", "11", "24", "11", "3"}}
+};
+
+/// Properties and declarations, which @supports conditions commonly test.
+/// A name "property:keyword" stands for the declaration with the keyword
+/// as value, a property name for the property without a value.
+static const Feature s_supported_features[] = {
+    // chrome, edge, firefox, ie, ios_saf, opera, safari, samsung
+    {{"display:flex", "display:inline-flex"},
+     {"29", "12", "28", "11", "9", "17", "9", "2"}},
+    {{"display:grid", "display:inline-grid", "grid", "grid-template", "grid-template-columns",
+      "grid-template-rows", "grid-template-areas", "grid-area", "grid-column", "grid-row",
+      "grid-auto-flow", "grid-auto-columns", "grid-auto-rows"},
+     {"57", "16", "52", "", "10.3", "44", "10.1", "6.2"}},
+    {{"grid-template-columns:subgrid", "grid-template-rows:subgrid"},
+     {"117", "117", "71", "", "16", "103", "16", "24"}},
+    {{"display:contents"},
+     {"65", "79", "37", "", "11.3", "52", "11.1", "9.2"}},
+    {{"display:flow-root"},
+     {"58", "79", "53", "", "13", "45", "13", "7.2"}},
+    {{"position:sticky"},
+     {"56", "16", "32", "", "13", "42", "13", "6.2"}},
+    {{"gap", "row-gap"},
+     {"66", "79", "61", "", "12", "53", "12", "9.2"}},
+    {{"--"},
+     {"49", "15", "31", "", "9.3", "36", "9.1", "5"}},
+    {{"object-fit", "object-position"},
+     {"32", "79", "36", "", "10", "19", "10", "2"}},
+    {{"will-change"},
+     {"36", "79", "36", "", "9.3", "24", "9.1", "3"}},
+    {{"isolation", "mix-blend-mode"},
+     {"41", "79", "32", "", "8", "29", "8", "4"}},
+    {{"touch-action"},
+     {"36", "12", "52", "11", "13", "23", "13", "3"}},
+    {{"caret-color"},
+     {"57", "79", "53", "", "11.3", "44", "11.1", "7.2"}},
+    {{"scroll-behavior"},
+     {"61", "79", "36", "", "15.4", "48", "15.4", "8.2"}},
+    {{"overscroll-behavior", "overscroll-behavior-x", "overscroll-behavior-y"},
+     {"63", "18", "59", "", "16", "50", "16", "8.2"}},
+    {{"inset"},
+     {"87", "87", "66", "", "14.5", "73", "14.1", "14"}},
+    {{"aspect-ratio"},
+     {"88", "88", "89", "", "15", "74", "15", "15"}},
+    {{"accent-color"},
+     {"93", "93", "92", "", "15.4", "79", "15.4", "17"}},
+    {{"content-visibility"},
+     {"85", "85", "125", "", "18", "71", "18", "14"}},
+    {{"container-type", "container-name", "container", "container-type:inline-size",
+      "container-type:size", "container-type:normal"},
+     {"105", "105", "110", "", "16", "91", "16", "20"}}
+};
+
+/// Pseudo-classes and forms of their arguments, which older target browsers
+/// don't understand. A selector list containing them is invalid there.
+static const Feature s_selector_features[] = {
+    // chrome, edge, firefox, ie, ios_saf, opera, safari, samsung
+    {{"nth-child of", "nth-last-child of"},
+     {"111", "111", "113", "", "9", "97", "9", "22"}},
+    // Example: :not(.a, .b) or :not(.a .b)
+    {{"not list"},
+     {"88", "88", "84", "", "9", "74", "9", "15"}},
+    {{"is", "where"},
+     {"88", "88", "78", "", "14", "74", "14", "15"}},
+    {{"has"},
+     {"105", "105", "121", "", "15.4", "91", "15.4", "20"}},
+    {{"focus-within"},
+     {"60", "79", "52", "", "10.3", "47", "10.1", "8.2"}},
+    {{"focus-visible"},
+     {"86", "86", "85", "", "15.4", "72", "15.4", "14"}}
+};
+
+/// Returns the version as a number, which compares like it. Example: 15.4 => 15004
+static uint64_t versionNumber(const string &version)
+{
+    const auto point = version.find('.');
+    uint64_t major = 0, minor = 0;
+
+    for (uint64_t i = 0; i < min(point, version.length()); ++i)
+        if (isdigit(version[i])) major = major*10 + uint64_t(version[i] - '0');
+
+    if (point != string::npos)
+        for (uint64_t i = point + 1; i < version.length(); ++i)
+            if (isdigit(version[i])) minor = minor*10 + uint64_t(version[i] - '0');
+
+    return major*1000 + minor;
+}
+
+/// Oldest supported versions of the target browsers, or UINT64_MAX for
+/// browsers, which aren't targeted
+static const uint64_t *targetVersions()
+{
+    static const struct Targets {
+        uint64_t versions[BROWSER_COUNT];
+
+        Targets()
+        {
+            fill(begin(versions), end(versions), UINT64_MAX);
+
+            const auto &targets = cfg.cssBrowserTargets();
+
+            // Example: chrome 109 safari 15.6
+            for (uint64_t i = 0; i + 1 < targets.size(); i += 2)
+                for (uint8_t browser = 0; browser < BROWSER_COUNT; ++browser)
+                    if (String::toLower(targets[i]) == s_browser_names[browser])
+                        versions[browser] = min(versions[browser], versionNumber(targets[i + 1]));
+        }
+    } targets;
+
+    return targets.versions;
+}
+
+/// Features of the table by their names
+template<size_t count>
+static HashTable<string, const Feature *> compileFeatures(const Feature (&table)[count])
+{
+    HashTable<string, const Feature *> compiled;
+
+    for (const auto &feature : table)
+        for (const auto &feature_name : feature.names) {
+            if (!feature_name) break;
+
+            compiled.emplace(feature_name, &feature);
+        }
+
+    return compiled;
+}
+
+static const Feature *findPrefixedFeature(const string &name)
+{
+    static const auto features = compileFeatures(s_prefixed_features);
+
+    const auto found = features.find(name);
+    return found != features.end() ? found->second : nullptr;
+}
+
+static const Feature *findSupportedFeature(const string &name)
+{
+    static const auto features = compileFeatures(s_supported_features);
+
+    const auto found = features.find(name);
+    return found != features.end() ? found->second : nullptr;
+}
+
+static const Feature *findSelectorFeature(const string &name)
+{
+    static const auto features = compileFeatures(s_selector_features);
+
+    const auto found = features.find(name);
+    return found != features.end() ? found->second : nullptr;
+}
+
+/// Counts the target browsers, which understand the feature
+static CssBrowserSupport::Support targetSupport(const Feature *feature)
+{
+    if (!feature) return CssBrowserSupport::PARTIALLY_SUPPORTED;
+
+    const auto versions = targetVersions();
+    uint8_t targets = 0, supporting_targets = 0;
+
+    for (uint8_t browser = 0; browser < BROWSER_COUNT; ++browser) {
+        if (versions[browser] == UINT64_MAX) continue;
+
+        ++targets;
+
+        if (*feature->unprefixed[browser] && versionNumber(feature->unprefixed[browser]) <= versions[browser])
+            ++supporting_targets;
+    }
+
+    if (!targets) return CssBrowserSupport::PARTIALLY_SUPPORTED;
+
+    return supporting_targets == targets ? CssBrowserSupport::SUPPORTED :
+           supporting_targets ? CssBrowserSupport::PARTIALLY_SUPPORTED : CssBrowserSupport::UNSUPPORTED;
+}
+
+/// Calls the callback with the first targeted version of each browser,
+/// which understands the prefix
+static bool anyPrefixUser(const string &prefix, const function<bool(Browser, uint64_t)> &callback)
+{
+    const auto versions = targetVersions();
+
+    for (const auto &range : s_prefix_ranges) {
+        const auto target = versions[range.browser];
+
+        if (target == UINT64_MAX || prefix != range.prefix ||
+            (*range.until && versionNumber(range.until) <= target))
+            continue;
+
+        if (callback(range.browser, max(target, versionNumber(range.since))))
+            return true;
+    }
+
+    return false;
+}
+
+/*static*/ string
+CssBrowserSupport::
+vendorPrefix(const string &name)
+{
+    // Custom properties start with two dashes
+    if (name.length() < 3 || name[0] != '-' || name[1] == '-') return string();
+
+    const auto end = name.find('-', 1);
+
+    if (end == string::npos || end + 1 == name.length()) return string();
+
+    const auto prefix = String::toLower(name.substr(0, end + 1));
+
+    // Only the prefixes of the browsers in the table, not e.g. -apple-system
+    for (const auto &range : s_prefix_ranges)
+        if (prefix == range.prefix)
+            return prefix;
+
+    return string();
+}
+
+/*static*/ bool
+CssBrowserSupport::
+usesPrefix(const string &prefix)
+{
+    return anyPrefixUser(prefix, [](Browser, uint64_t) -> bool {
+        return true;
+    });
+}
+
+/*static*/ bool
+CssBrowserSupport::
+needsPrefix(const string &prefix, const string &unprefixed_name)
+{
+    const auto feature = findPrefixedFeature(String::toLower(unprefixed_name));
+
+    return anyPrefixUser(prefix, [feature](const Browser browser, const uint64_t version) -> bool {
+        return !feature || !*feature->unprefixed[browser] ||
+               versionNumber(feature->unprefixed[browser]) > version;
+    });
+}
+
+/*static*/ CssBrowserSupport::Support
+CssBrowserSupport::
+supportsDeclaration(const string &property, const string &value_text)
+{
+    const auto name = String::toLower(property);
+    const auto value = String::toLower(value_text);
+
+    // Example: (-ms-ime-align: auto)
+    for (const auto &prefix : {vendorPrefix(name), vendorPrefix(value)})
+        if (!prefix.empty())
+            return usesPrefix(prefix) ? PARTIALLY_SUPPORTED : UNSUPPORTED;
+
+    const Feature *feature = nullptr;
+
+    if (name.compare(0, 2, "--") == 0)
+        feature = findSupportedFeature("--");
+    // Example: grid-template-rows: masonry isn't understood, where the property is
+    else if (!value.empty())
+        feature = findSupportedFeature(name + ':' + value);
+    else {
+        feature = findSupportedFeature(name);
+
+        if (!feature)
+            feature = findPrefixedFeature(name);
+    }
+
+    return targetSupport(feature);
+}
+
+/*static*/ CssBrowserSupport::Support
+CssBrowserSupport::
+supportsSelector(const string &feature)
+{
+    return targetSupport(findSelectorFeature(String::toLower(feature)));
+}
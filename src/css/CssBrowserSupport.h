@@ -0,0 +1,78 @@
+/******************************************************************************
+This source file is part of the project
+HyperSheetsPreprocessor (HSPP) - Optimizer and minifier for CSS
+Copyright (C) 2019 Waldemar Zimpel <hspp@utilizer.de>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://www.gnu.org/licenses/>.
+*******************************************************************************/
+
+#ifndef CSSBROWSERSUPPORT_H
+#define CSSBROWSERSUPPORT_H
+#include <string>
+
+namespace CSS {
+using namespace std;
+
+/// Decides by a compiled-in support table, which vendor prefixes the
+/// browsers of the setting browser_targets still need. A target is a
+/// browser and the oldest version of it, which the stylesheet supports.
+class CssBrowserSupport final
+{
+public:
+    /// Ordered, so that the minimum of two values is the support of both
+    /// features and the maximum the support of either of them
+    enum Support : uint8_t {
+        // None of the target browsers understands the feature
+        UNSUPPORTED,
+        // Some of the target browsers or, if the support table doesn't
+        // list the feature, possibly all or none of them
+        PARTIALLY_SUPPORTED,
+        // All target browsers understand the feature
+        SUPPORTED
+    };
+
+    /// Returns the vendor prefix of a property, value or at-rule name, or
+    /// an empty string. Example: -webkit-transform => -webkit-
+    static string
+    vendorPrefix(const string &name);
+
+    /// Returns true, if any target browser understands names with the prefix
+    static bool
+    usesPrefix(const string &prefix);
+
+    /// Returns true, if any target browser understands the prefixed name,
+    /// but not the unprefixed one. Names, which the support table doesn't
+    /// list, are needed by every browser using the prefix.
+    static bool
+    needsPrefix(const string &prefix, const string &unprefixed_name);
+
+    /// Returns, how many of the target browsers understand the declaration.
+    /// The value is empty, if only the property is asked about. Values,
+    /// which the support table doesn't list for the property, are
+    /// PARTIALLY_SUPPORTED, as they may be newer than the property.
+    /// Example: display, grid => SUPPORTED
+    static Support
+    supportsDeclaration(const string &property, const string &value);
+
+    /// Returns, how many of the target browsers understand the pseudo-class
+    /// or form of its argument. Pseudo-classes, which the support table
+    /// doesn't list, are PARTIALLY_SUPPORTED.
+    /// Example: nth-child of => :nth-child(odd of .item)
+    static Support
+    supportsSelector(const string &feature);
+};
+
+} // namespace CSS
+
+#endif // CSSBROWSERSUPPORT_H
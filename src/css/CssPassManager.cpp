@@ -0,0 +1,328 @@
+/******************************************************************************
+This source file is part of the project
+HyperSheetsPreprocessor (HSPP) - Optimizer and minifier for CSS
+Copyright (C) 2019 Waldemar Zimpel <hspp@utilizer.de>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://www.gnu.org/licenses/>.
+*******************************************************************************/
+
+
+#include "CssPassManager.h"
+#include "CssSizeReport.h"
+#include "../String.h"
+#include "../defs.h"
+#include <atomic>
+#include <cstring>
+
+using namespace CSS;
+using namespace std::chrono;
+
+struct PassInfo
+{
+    const char *name;
+    /// Setting of the configuration file, which enables the pass. Passes
+    /// without a setting (UNKNOWN) are enabled, unless a lower level is chosen.
+    Config::Setting setting;
+    CssPassManager::Level level;
+    /// Passes, which have to be enabled for this one to run
+    uint32_t dependencies;
+    /// Restructuring passes, which may find more to do after they changed the stylesheet
+    bool repeatable;
+};
+
+#define PASS_BIT(pass) (1U << CssPassManager::pass)
+
+static const PassInfo s_passes[CssPassManager::PASS_COUNT] = {
+    {"remove_comments",                Config::CSS__REMOVE_COMMENTS,                CssPassManager::LEVEL_0, 0,                         false},
+    {"minify_numbers",                 Config::CSS__MINIFY_NUMBERS,                 CssPassManager::LEVEL_1, 0,                         false},
+    {"minify_dimensions",              Config::UNKNOWN,                             CssPassManager::LEVEL_1, 0,                         false},
+    {"rewrite_angles",                 Config::CSS__REWRITE_ANGLES,                 CssPassManager::LEVEL_1, PASS_BIT(MINIFY_NUMBERS),  false},
+    {"minify_colors",                  Config::CSS__MINIFY_COLORS,                  CssPassManager::LEVEL_1, 0,                         false},
+    {"use_rgba_hex_notation",          Config::CSS__USE_RGBA_HEX_NOTATION,          CssPassManager::LEVEL_1, PASS_BIT(MINIFY_COLORS),   false},
+    {"rewrite_functions",              Config::CSS__REWRITE_FUNCTIONS,              CssPassManager::LEVEL_1, 0,                         false},
+    {"simplify_math_functions",        Config::CSS__SIMPLIFY_MATH_FUNCTIONS,        CssPassManager::LEVEL_1, 0,                         false},
+    {"rewrite_values",                 Config::CSS__REWRITE_VALUES,                 CssPassManager::LEVEL_1, 0,                         false},
+    {"remove_vendor_prefixes",         Config::CSS__REMOVE_VENDOR_PREFIXES,         CssPassManager::LEVEL_2, 0,                         false},
+    {"rewrite_shorthands",             Config::UNKNOWN,                             CssPassManager::LEVEL_1, 0,                         false},
+    {"remove_overridden_declarations", Config::CSS__REMOVE_OVERRIDDEN_DECLARATIONS, CssPassManager::LEVEL_1, 0,                         false},
+    {"merge_longhands",                Config::CSS__MERGE_LONGHANDS,                CssPassManager::LEVEL_1, 0,                         false},
+    {"rewrite_selectors",              Config::UNKNOWN,                             CssPassManager::LEVEL_1, 0,                         false},
+    {"unquote_urls",                   Config::UNKNOWN,                             CssPassManager::LEVEL_1, 0,                         false},
+    {"remove_empty_rules",             Config::CSS__REMOVE_EMPTY_RULES,             CssPassManager::LEVEL_1, 0,                         false},
+    {"evaluate_supports",              Config::CSS__EVALUATE_SUPPORTS,              CssPassManager::LEVEL_2, 0,                         false},
+    {"inline_custom_properties",       Config::CSS__INLINE_CUSTOM_PROPERTIES,       CssPassManager::LEVEL_2, 0,                         true},
+    {"remove_unused_definitions",      Config::CSS__REMOVE_UNUSED_DEFINITIONS,      CssPassManager::LEVEL_2, 0,                         true},
+    {"minify_ids",                     Config::CSS__MINIFY_IDS,                     CssPassManager::LEVEL_2, 0,                         false},
+    {"minify_class_names",             Config::CSS__MINIFY_CLASS_NAMES,             CssPassManager::LEVEL_2, 0,                         false},
+    {"minify_custom_properties",       Config::CSS__MINIFY_CUSTOM_PROPERTIES,       CssPassManager::LEVEL_2, 0,                         false},
+    {"minify_animation_names",         Config::CSS__MINIFY_ANIMATION_NAMES,         CssPassManager::LEVEL_2, 0,                         false},
+    {"merge_media_rules",              Config::CSS__MERGE_MEDIA_RULES,              CssPassManager::LEVEL_2, 0,                         true},
+    {"merge_rules",                    Config::CSS__MERGE_RULES,                    CssPassManager::LEVEL_2, 0,                         true}
+};
+
+struct PassRecord
+{
+    atomic<uint64_t> time {0}, calls {0}, iterations {0};
+    atomic<int64_t> saved_bytes {0};
+    /// Set, if a repeatable pass was stopped because of the time budget
+    atomic<bool> out_of_budget {false};
+};
+
+// Upper bound of the runs of a repeatable pass on one stylesheet
+constexpr uint64_t MAX_ITERATIONS = 16;
+
+static PassRecord s_records[CssPassManager::PASS_COUNT];
+/// Passes without a setting, which are disabled by the level or a dependency
+static uint32_t s_disabled_passes = 0;
+static bool s_fixpoint = false, s_report = false, s_level_set = false;
+static CssPassManager::Level s_level = CssPassManager::LEVEL_2;
+static uint64_t s_time_budget = 0;
+
+static void setEnabled(const CssPassManager::Pass pass, const bool enabled)
+{
+    const auto &info = s_passes[pass];
+
+    if (info.setting != Config::UNKNOWN)
+        enabled ? cfg.enable(info.setting) : cfg.disable(info.setting);
+    else if (enabled)
+        s_disabled_passes &= ~(1U << pass);
+    else
+        s_disabled_passes |= 1U << pass;
+}
+
+CssPassManager::PassScope::
+PassScope(const Pass pass, const CssBaseElementPtr &element) :
+    m_pass(pass),
+    m_running(isCountingBytes())
+{
+    if (!m_running) return;
+
+    if (element) {
+        m_element = element;
+        m_size = CssSizeReport::generatedSize(element);
+    }
+
+    if (s_report)
+        m_begin = steady_clock::now();
+}
+
+CssPassManager::PassScope::
+~PassScope()
+{
+    stop();
+}
+
+void
+CssPassManager::PassScope::
+stop()
+{
+    if (!m_running) return;
+
+    m_running = false;
+
+    if (s_report)
+        addTime(m_pass, uint64_t(duration_cast<nanoseconds>(steady_clock::now() - m_begin).count()));
+
+    if (m_element) {
+        addSavedBytes(m_pass, int64_t(m_size) - int64_t(CssSizeReport::generatedSize(m_element)));
+        m_element.reset();
+    }
+}
+
+/*static*/ void
+CssPassManager::
+setLevel(const Level level)
+{
+    s_level = level;
+    s_level_set = true;
+
+    for (uint8_t pass = 0; pass < PASS_COUNT; ++pass)
+        setEnabled(Pass(pass), level >= s_passes[pass].level);
+}
+
+/*static*/ void
+CssPassManager::
+resolveDependencies()
+{
+    // Dependencies come before the passes depending on them
+    for (uint8_t pass = 0; pass < PASS_COUNT; ++pass)
+        for (uint8_t dependency = 0; dependency < pass; ++dependency)
+            if ((s_passes[pass].dependencies & (1U << dependency)) && !isEnabled(Pass(dependency)))
+                setEnabled(Pass(pass), false);
+}
+
+/*static*/ void
+CssPassManager::
+enableFixpoint()
+{
+    s_fixpoint = true;
+}
+
+/*static*/ void
+CssPassManager::
+setTimeBudget(const uint64_t milliseconds)
+{
+    s_time_budget = milliseconds * 1000000;
+}
+
+/*static*/ void
+CssPassManager::
+enableReport()
+{
+    s_report = true;
+}
+
+/*static*/ bool
+CssPassManager::
+isEnabled(const Pass pass)
+{
+    const auto &info = s_passes[pass];
+
+    return info.setting != Config::UNKNOWN ? cfg.isEnabled(info.setting) : !(s_disabled_passes & (1U << pass));
+}
+
+/*static*/ bool
+CssPassManager::
+isReportEnabled()
+{
+    return s_report;
+}
+
+/*static*/ bool
+CssPassManager::
+isCountingBytes()
+{
+    return s_report || CssSizeReport::isEnabled();
+}
+
+/*static*/ void
+CssPassManager::
+addSavedBytes(const Pass pass, const int64_t bytes)
+{
+    s_records[pass].saved_bytes += bytes;
+}
+
+/*static*/ void
+CssPassManager::
+addTime(const Pass pass, const uint64_t nanoseconds)
+{
+    s_records[pass].time += nanoseconds;
+    ++s_records[pass].calls;
+}
+
+/*static*/ int64_t
+CssPassManager::
+savedBytes(const Pass pass)
+{
+    return s_records[pass].saved_bytes;
+}
+
+/*static*/ bool
+CssPassManager::
+run(const Pass pass, const CssBaseElementPtr &stylesheet, const function<bool()> &pass_function)
+{
+    if (!isEnabled(pass)) return false;
+
+    const bool counting_bytes = isCountingBytes();
+    const uint64_t size = counting_bytes ? CssSizeReport::generatedSize(stylesheet) : 0;
+    const auto begin = steady_clock::now();
+
+    auto &record = s_records[pass];
+    bool changed = false;
+
+    for (uint64_t iteration = 1;; ++iteration) {
+        ++record.iterations;
+
+        if (!pass_function()) break;
+
+        changed = true;
+
+        if (!s_fixpoint || !s_passes[pass].repeatable || iteration == MAX_ITERATIONS) break;
+
+        if (s_time_budget && uint64_t(duration_cast<nanoseconds>(steady_clock::now() - begin).count()) > s_time_budget) {
+            record.out_of_budget = true;
+            break;
+        }
+    }
+
+    addTime(pass, uint64_t(duration_cast<nanoseconds>(steady_clock::now() - begin).count()));
+
+    if (counting_bytes)
+        addSavedBytes(pass, int64_t(size) - int64_t(CssSizeReport::generatedSize(stylesheet)));
+
+    return changed;
+}
+
+/*static*/ const char *
+CssPassManager::
+passName(const Pass pass)
+{
+    return s_passes[pass].name;
+}
+
+/*static*/ bool
+CssPassManager::
+hasSetting(const Pass pass)
+{
+    return s_passes[pass].setting != Config::UNKNOWN;
+}
+
+/*static*/ void
+CssPassManager::
+writeReport(ostream &stream)
+{
+    const auto alignRight = [](const string &value, const uint64_t width) -> string {
+        return value.length() < width ? String::repeatChar(' ', width - value.length()) + value : value;
+    };
+
+    const auto alignLeft = [](const string &value, const uint64_t width) -> string {
+        return value.length() < width ? value + String::repeatChar(' ', width - value.length()) : value;
+    };
+
+    // Fits the longest pass name
+    uint64_t name_width = 0;
+
+    for (const auto &info : s_passes)
+        name_width = max<uint64_t>(name_width, strlen(info.name));
+
+    name_width += 2;
+
+    stream << NEWLINE "Passes: " << (s_level_set ? "-O" + to_string(s_level) : string("configuration file"))
+           << ", fixpoint " << (s_fixpoint ? "on" : "off")
+           << ", budget " << (s_time_budget ? to_string(s_time_budget / 1000000) + "ms" : string("none")) << NEWLINE LINE
+           << alignLeft("Pass", name_width) << alignRight("Level", 6) << "  " << alignLeft("Status", 30)
+           << alignRight("Time", 12) << alignRight("Saved bytes", 13) << alignRight("Runs", 6) << NEWLINE;
+
+    for (uint8_t pass = 0; pass < PASS_COUNT; ++pass) {
+        const auto &info = s_passes[pass];
+        const auto &record = s_records[pass];
+
+        string status = isEnabled(Pass(pass)) ? "on" : "off";
+
+        for (uint8_t dependency = 0; dependency < pass; ++dependency)
+            if ((info.dependencies & (1U << dependency)) && !isEnabled(Pass(dependency)))
+                status += ", needs " + string(s_passes[dependency].name);
+
+        if (record.out_of_budget)
+            status += ", out of budget";
+
+        stream << alignLeft(info.name, name_width) << alignRight(to_string(info.level), 6) << "  " << alignLeft(status, 30)
+               << alignRight(record.calls ? String::numberFormat(record.time / 1e6, 3) + "ms" : "-", 12)
+               << alignRight(to_string(record.saved_bytes.load()), 13)
+               << alignRight(info.repeatable && record.iterations ? to_string(record.iterations.load()) : "-", 6)
+               << NEWLINE;
+    }
+
+    stream << LINE << endl;
+}
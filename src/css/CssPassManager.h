@@ -0,0 +1,131 @@
+/******************************************************************************
+This source file is part of the project
+HyperSheetsPreprocessor (HSPP) - Optimizer and minifier for CSS
+Copyright (C) 2019 Waldemar Zimpel <hspp@utilizer.de>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://www.gnu.org/licenses/>.
+*******************************************************************************/
+
+
+#ifndef CSSPASSMANAGER_H
+#define CSSPASSMANAGER_H
+#include "../config/Config.h"
+#include "parser/elements/CssBaseElement.h"
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+
+namespace CSS {
+using namespace CSS::Parsing::Elements;
+
+/// Names the optimization passes, decides which of them run and collects
+/// the time and the saved bytes of each. Local passes are fused into the
+/// single traversal of the modifier, restructuring passes run on the whole
+/// stylesheet afterwards and may be repeated until they change nothing.
+class CssPassManager final
+{
+public:
+    enum Pass : uint8_t {
+        REMOVE_COMMENTS, MINIFY_NUMBERS, MINIFY_DIMENSIONS, REWRITE_ANGLES,
+        MINIFY_COLORS, USE_RGBA_HEX_NOTATION, REWRITE_FUNCTIONS, SIMPLIFY_MATH_FUNCTIONS,
+        REWRITE_VALUES, REMOVE_VENDOR_PREFIXES, REWRITE_SHORTHANDS, REMOVE_OVERRIDDEN_DECLARATIONS,
+        MERGE_LONGHANDS, REWRITE_SELECTORS, UNQUOTE_URLS, REMOVE_EMPTY_RULES,
+        EVALUATE_SUPPORTS, INLINE_CUSTOM_PROPERTIES, REMOVE_UNUSED_DEFINITIONS, MINIFY_IDS,
+        MINIFY_CLASS_NAMES, MINIFY_CUSTOM_PROPERTIES, MINIFY_ANIMATION_NAMES, MERGE_MEDIA_RULES,
+        MERGE_RULES, PASS_COUNT
+    };
+
+    /// Presets of the command line argument '-O'
+    enum Level : uint8_t {
+        // Only white space and comments are removed
+        LEVEL_0,
+        // Values and rules are rewritten in place
+        LEVEL_1,
+        // Identifiers are renamed and the stylesheet is restructured
+        LEVEL_2
+    };
+
+    /// Measures the time of a local pass from its construction until stop()
+    /// is called or it is destructed, and the bytes, by which the element
+    /// got shorter in the meantime
+    class PassScope final
+    {
+    public:
+        explicit
+        PassScope(const Pass pass, const CssBaseElementPtr &element = nullptr);
+        ~PassScope();
+
+        PassScope(const PassScope &) = delete;
+        PassScope &operator=(const PassScope &) = delete;
+
+        void
+        stop();
+
+    private:
+        const Pass m_pass;
+        bool m_running;
+        CssBaseElementPtr m_element;
+        uint64_t m_size {0};
+        chrono::steady_clock::time_point m_begin;
+    };
+
+    static void
+    /// Enables the passes up to the level and disables the others
+    setLevel(const Level level),
+
+    /// Disables the passes, whose dependencies are disabled. Called once,
+    /// after the configuration file and the command line have been read.
+    resolveDependencies(),
+
+    /// Repeatable passes are run again, until they change nothing
+    enableFixpoint(),
+
+    /// Repeatable passes aren't run again, after they took this long
+    setTimeBudget(const uint64_t milliseconds),
+
+    /// Enables measuring the time and the saved bytes of every pass
+    enableReport(),
+
+    addSavedBytes(const Pass pass, const int64_t bytes),
+    addTime(const Pass pass, const uint64_t nanoseconds),
+
+    /// Writes the status, the time and the saved bytes of every pass
+    writeReport(ostream &stream);
+
+    static bool
+    isEnabled(const Pass pass),
+    isReportEnabled(),
+
+    /// True, if the pass is switched by a setting of the configuration file
+    /// with the name of the pass
+    hasSetting(const Pass pass),
+
+    /// True, if the bytes saved by the passes are counted
+    isCountingBytes(),
+
+    /// Runs a restructuring pass on the stylesheet. The pass returns true,
+    /// if it changed anything.
+    run(const Pass pass, const CssBaseElementPtr &stylesheet, const function<bool()> &pass_function);
+
+    static int64_t
+    savedBytes(const Pass pass);
+
+    static const char *
+    passName(const Pass pass);
+};
+
+} // namespace CSS
+
+#endif // CSSPASSMANAGER_H
@@ -0,0 +1,416 @@
+/******************************************************************************
+This source file is part of the project
+HyperSheetsPreprocessor (HSPP) - Optimizer and minifier for CSS
+Copyright (C) 2019 Waldemar Zimpel <hspp@utilizer.de>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://www.gnu.org/licenses/>.
+*******************************************************************************/
+
+
+#include "CssSelectorReport.h"
+#include "generator/CssGenerator.h"
+#include "parser/elements/CssSelectorAttribute.h"
+#include "parser/elements/CssSelectorCombinator.h"
+#include "../String.h"
+#include "../defs.h"
+#include <algorithm>
+#include <map>
+#include <mutex>
+
+using namespace CSS;
+using namespace CSS::Generation;
+
+/// Selectors with the same text and finding in the same file
+struct FindingRecord
+{
+    string file, selector;
+    CssSelectorReport::Finding finding;
+    uint64_t count {0}, bytes {0};
+};
+
+/// Elements, which the compound selector at the right end of a selector
+/// chain matches, from the broadest to the narrowest
+enum KeyKind : uint8_t { MATCHES_ANY, MATCHES_TYPE, MATCHES_ID_OR_CLASS };
+
+// Selector chains of more compound selectors are reported as deep
+constexpr uint64_t MAX_COMPOUND_SELECTORS = 4;
+
+static bool s_enabled = false;
+static mutex s_mutex;
+static map<const CssBaseElement *, string> s_imported_files;
+static map<string, FindingRecord> s_findings;
+static uint64_t s_selector_count = 0, s_flagged_selector_count = 0;
+static uint64_t s_finding_counts[CssSelectorReport::FINDING_COUNT] = {};
+
+static string jsonString(const string &value)
+{
+    string result = "\"";
+
+    for (const auto &chr : value) {
+        if (chr == '"' || chr == '\\')
+            result += '\\';
+
+        result += chr;
+    }
+
+    return result + '"';
+}
+
+static bool isPseudoClass(const CssSelectorPtr &selector, const initializer_list<string> names)
+{
+    if (!selector->isOfType(CssSelector::PSEUDO_CLASS)) return false;
+
+    const auto name = String::toLower(selector->name());
+
+    return find(names.begin(), names.end(), name) != names.end();
+}
+
+static KeyKind keyKind(const CssBaseElementPtr &element);
+
+static KeyKind compoundKind(const CssSelectorPtr &compound)
+{
+    KeyKind kind = MATCHES_ANY;
+
+    // The simple selectors of a compound selector are linked from the last to the first
+    for (auto selector = compound; selector; selector = selector->parentalSelector()) {
+        switch (selector->selectorType()) {
+        case CssSelector::ID:
+        case CssSelector::CLASS:
+            return MATCHES_ID_OR_CLASS;
+        case CssSelector::TYPE:
+        case CssSelector::ATTRIBUTE:
+            kind = max(kind, MATCHES_TYPE);
+            break;
+        case CssSelector::PSEUDO_CLASS:
+            // :is() and :where() match, what the broadest of their arguments matches
+            if (isPseudoClass(selector, {"is", "where"}) &&
+                selector->subSelectors() && !selector->subSelectors()->empty()) {
+                KeyKind broadest = MATCHES_ID_OR_CLASS;
+
+                for (const auto &subselector : *selector->subSelectors())
+                    broadest = min(broadest, keyKind(subselector));
+
+                kind = max(kind, broadest);
+            }
+            break;
+        default:;
+        }
+    }
+
+    return kind;
+}
+
+static KeyKind keyKind(const CssBaseElementPtr &element)
+{
+    auto key = element;
+
+    // Combinators are nested to the left, the key is the rightmost compound selector
+    while (key->isOfType(CssBaseElement::SELECTOR_COMBINATOR))
+        key = static_pointer_cast<CssSelectorCombinator>(key)->right();
+
+    return compoundKind(CssSelector::fromBase(key));
+}
+
+static void findInChain(const CssBaseElementPtr &element, bool findings[], const bool is_argument);
+
+/// Findings within a single compound selector and its pseudo-class arguments
+static void findInCompound(const CssSelectorPtr &compound, bool findings[])
+{
+    const bool matches_id_or_class = compoundKind(compound) == MATCHES_ID_OR_CLASS;
+
+    for (auto selector = compound; selector; selector = selector->parentalSelector()) {
+        if (selector->isOfType(CssSelector::ATTRIBUTE) && !matches_id_or_class) {
+            // Substring matches compare the value of every element with the attribute
+            switch (CssSelectorAttribute::fromBase(selector)->operation()) {
+            case CssSelectorAttribute::ROOF_EQUAL:
+            case CssSelectorAttribute::DOLLAR_EQUAL:
+            case CssSelectorAttribute::ASTERISK_EQUAL:
+                findings[CssSelectorReport::ATTRIBUTE_SUBSTRING] = true;
+                break;
+            default:;
+            }
+        }
+
+        if (isPseudoClass(selector, {"has"}))
+            findings[CssSelectorReport::HAS_PSEUDO_CLASS] = true;
+
+        if (selector->subSelectors())
+            for (const auto &subselector : *selector->subSelectors())
+                findInChain(subselector, findings, true);
+    }
+}
+
+/// Findings of a selector chain. The arguments of pseudo-classes are only
+/// searched for expensive compound selectors, their keys are matched
+/// against the already matched element.
+static void findInChain(const CssBaseElementPtr &element, bool findings[], const bool is_argument)
+{
+    uint64_t compounds = 1;
+    bool descendant_or_sibling = false;
+    auto current = element;
+
+    while (current->isOfType(CssBaseElement::SELECTOR_COMBINATOR)) {
+        const auto combinator = static_pointer_cast<CssSelectorCombinator>(current);
+
+        ++compounds;
+        descendant_or_sibling = descendant_or_sibling ||
+            combinator->combinatorType() == CssSelectorCombinator::DESCENDANCY ||
+            combinator->combinatorType() == CssSelectorCombinator::SUBSEQUENT_SIBLING;
+
+        findInCompound(CssSelector::fromBase(combinator->right()), findings);
+        current = combinator->left();
+    }
+
+    findInCompound(CssSelector::fromBase(current), findings);
+
+    if (is_argument) return;
+
+    if (compounds > MAX_COMPOUND_SELECTORS)
+        findings[CssSelectorReport::DEEP_CHAIN] = true;
+
+    // Browsers match from right to left, a broad key is tested against the
+    // ancestors or siblings of every element it matches
+    if (compounds > 1) {
+        switch (keyKind(element)) {
+        case MATCHES_ANY:
+            findings[CssSelectorReport::UNIVERSAL_KEY] = true;
+            break;
+        case MATCHES_TYPE:
+            if (descendant_or_sibling)
+                findings[CssSelectorReport::UNQUALIFIED_KEY] = true;
+            break;
+        default:;
+        }
+    }
+}
+
+static void analyzeSelector(const CssBaseElementPtr &selector, const string &file)
+{
+    bool findings[CssSelectorReport::FINDING_COUNT] = {};
+    findInChain(selector, findings, false);
+
+    ++s_selector_count;
+
+    if (find(begin(findings), end(findings), true) == end(findings)) return;
+
+    ++s_flagged_selector_count;
+
+    string generated;
+    CssGenerator css_generator(generated);
+    selector->accept(css_generator);
+
+    for (uint8_t finding = 0; finding < CssSelectorReport::FINDING_COUNT; ++finding) {
+        if (!findings[finding]) continue;
+
+        ++s_finding_counts[finding];
+
+        auto &record = s_findings[file + '\n' + to_string(finding) + '\n' + generated];
+
+        if (record.count == 0) {
+            record.file = file;
+            record.selector = generated;
+            record.finding = CssSelectorReport::Finding(finding);
+        }
+
+        ++record.count;
+        record.bytes += generated.length();
+    }
+}
+
+static void analyzeElements(const CssBlockPtr &block, string file);
+
+static void analyzeElement(const CssBaseElementPtr &element, const string &file)
+{
+    // @import rules, which are replaced by the imported stylesheet
+    if (element->replacementElement()) {
+        const auto &replacement = element->replacementElement();
+
+        if (replacement->isOfType(CssBaseElement::BLOCK))
+            analyzeElements(static_pointer_cast<CssBlock>(replacement), file);
+        else
+            analyzeElement(replacement, file);
+
+        return;
+    }
+
+    if (element->isOfType(CssBaseElement::QUALIFIED_RULE)) {
+        for (const auto &selector : static_pointer_cast<CssQualifiedRule>(element)->selectors()) {
+            // The selectors of keyframes aren't matched against elements
+            if (selector->isOfType(CssBaseElement::SELECTOR) &&
+                CssSelector::fromBase(selector)->isOfType(CssSelector::KEYFRAMES))
+                continue;
+
+            analyzeSelector(selector, file);
+        }
+    }
+    else if (element->isAtRule()) {
+        const auto at_rule = static_pointer_cast<CssAtRule>(element);
+
+        if (at_rule->block())
+            analyzeElements(at_rule->block(), file);
+    }
+}
+
+static void analyzeElements(const CssBlockPtr &block, string file)
+{
+    const auto imported_file = s_imported_files.find(&*block);
+
+    if (imported_file != s_imported_files.end())
+        file = imported_file->second;
+
+    for (const auto &element : block->elements())
+        analyzeElement(element, file);
+}
+
+/*static*/ void
+CssSelectorReport::
+enable()
+{
+    s_enabled = true;
+}
+
+/*static*/ bool
+CssSelectorReport::
+isEnabled()
+{
+    return s_enabled;
+}
+
+/*static*/ void
+CssSelectorReport::
+setImportedFile(const CssBaseElementPtr &imported_stylesheet, const string &file_path)
+{
+    lock_guard<mutex> lock(s_mutex);
+    s_imported_files[&*imported_stylesheet] = file_path;
+}
+
+/*static*/ void
+CssSelectorReport::
+addStyleSheet(const CssBaseElementPtr &stylesheet, const string &file_path)
+{
+    lock_guard<mutex> lock(s_mutex);
+    analyzeElements(static_pointer_cast<CssBlock>(stylesheet), file_path);
+}
+
+/*static*/ const char *
+CssSelectorReport::
+findingName(const Finding finding)
+{
+    static const char *const names[FINDING_COUNT] = {
+        "universal_key", "unqualified_key", "deep_chain", "has_pseudo_class", "attribute_substring"
+    };
+
+    return names[finding];
+}
+
+/*static*/ const char *
+CssSelectorReport::
+findingDescription(const Finding finding)
+{
+    static const char *const descriptions[FINDING_COUNT] = {
+        "The rightmost compound selector matches any element",
+        "Type or attribute key behind a descendant or sibling combinator",
+        "More than 4 compound selectors in a row",
+        "Matching :has() walks the descendants or siblings of the element",
+        "Substring match of an attribute without an ID or class"
+    };
+
+    return descriptions[finding];
+}
+
+/// The findings, which occur most often, first and the longer of equally
+/// frequent ones first
+static DataContainer<FindingRecord> sortedFindings()
+{
+    DataContainer<FindingRecord> findings;
+    findings.reserve(s_findings.size());
+
+    for (const auto &finding : s_findings)
+        findings.emplace_back(finding.second);
+
+    stable_sort(findings.begin(), findings.end(), [](const FindingRecord &a, const FindingRecord &b) {
+        return a.count != b.count ? a.count > b.count : a.bytes > b.bytes;
+    });
+
+    return findings;
+}
+
+/*static*/ void
+CssSelectorReport::
+writeJson(ostream &stream)
+{
+    lock_guard<mutex> lock(s_mutex);
+
+    stream << "{\"selectors\":" << s_selector_count
+           << ",\"flagged_selectors\":" << s_flagged_selector_count << ",\"finding_counts\":{";
+
+    for (uint8_t finding = 0; finding < FINDING_COUNT; ++finding)
+        stream << (finding != 0 ? "," : "") << jsonString(findingName(Finding(finding)))
+               << ":" << s_finding_counts[finding];
+
+    stream << "},\"findings\":[";
+
+    const auto findings = sortedFindings();
+
+    for (const auto &finding : findings)
+        stream << (&finding != &findings.front() ? "," : "") << NEWLINE
+               << "{\"file\":" << jsonString(finding.file)
+               << ",\"finding\":" << jsonString(findingName(finding.finding))
+               << ",\"selector\":" << jsonString(finding.selector)
+               << ",\"count\":" << finding.count
+               << ",\"bytes\":" << finding.bytes << "}";
+
+    stream << "]}" << endl;
+}
+
+/*static*/ void
+CssSelectorReport::
+writeSummary(ostream &stream)
+{
+    // Number of findings listed in the summary, all of them are in the JSON file
+    constexpr uint64_t SUMMARY_FINDING_COUNT = 20;
+    // Selector texts are cut to this length in the summary
+    constexpr uint64_t LABEL_LENGTH = 48;
+
+    lock_guard<mutex> lock(s_mutex);
+
+    const auto alignRight = [](const string &value, const uint64_t width) -> string {
+        return value.length() < width ? String::repeatChar(' ', width - value.length()) + value : value;
+    };
+
+    const auto alignLeft = [](string value, const uint64_t width) -> string {
+        if (value.length() > width)
+            value = value.substr(0, width - 3) + "...";
+
+        return value + String::repeatChar(' ', width - value.length() + 1);
+    };
+
+    stream << NEWLINE "Selectors: " << s_selector_count << ", flagged: " << s_flagged_selector_count << NEWLINE LINE
+           << alignLeft("Finding", 20) << alignRight("Count", 8) << "  Description" NEWLINE;
+
+    for (uint8_t finding = 0; finding < FINDING_COUNT; ++finding)
+        stream << alignLeft(findingName(Finding(finding)), 20) << alignRight(to_string(s_finding_counts[finding]), 8)
+               << "  " << findingDescription(Finding(finding)) << NEWLINE;
+
+    stream << NEWLINE << alignLeft("Most frequent findings", LABEL_LENGTH) << alignLeft("Finding", 20)
+           << alignRight("Count", 8) << alignRight("Bytes", 10) << NEWLINE;
+
+    const auto findings = sortedFindings();
+
+    for (uint64_t i = 0; i < findings.size() && i < SUMMARY_FINDING_COUNT; ++i)
+        stream << alignLeft(findings[i].selector, LABEL_LENGTH) << alignLeft(findingName(findings[i].finding), 20)
+               << alignRight(to_string(findings[i].count), 8) << alignRight(to_string(findings[i].bytes), 10) << NEWLINE;
+
+    stream << LINE << endl;
+}
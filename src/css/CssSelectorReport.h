@@ -0,0 +1,68 @@
+/******************************************************************************
+This source file is part of the project
+HyperSheetsPreprocessor (HSPP) - Optimizer and minifier for CSS
+Copyright (C) 2019 Waldemar Zimpel <hspp@utilizer.de>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://www.gnu.org/licenses/>.
+*******************************************************************************/
+
+
+#ifndef CSSSELECTORREPORT_H
+#define CSSSELECTORREPORT_H
+#include "parser/elements/CssBaseElement.h"
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+namespace CSS {
+using namespace CSS::Parsing::Elements;
+
+/// Flags selectors, which are likely to be expensive for the style matching
+/// of browsers, and ranks them by occurrence and output size. Reported with
+/// the command line argument '--selector-report'.
+class CssSelectorReport final
+{
+public:
+    enum Finding : uint8_t {
+        UNIVERSAL_KEY, UNQUALIFIED_KEY, DEEP_CHAIN, HAS_PSEUDO_CLASS,
+        ATTRIBUTE_SUBSTRING, FINDING_COUNT
+    };
+
+    static void
+    enable(),
+
+    /// Marks the parsed content of an @import rule, which is included
+    /// into the importing stylesheet, as coming from file_path
+    setImportedFile(const CssBaseElementPtr &imported_stylesheet, const string &file_path),
+
+    /// Analyzes the selectors of the minified stylesheet of file_path
+    addStyleSheet(const CssBaseElementPtr &stylesheet, const string &file_path),
+
+    writeJson(ostream &stream),
+
+    /// Writes the number of findings per kind and the most frequent findings
+    writeSummary(ostream &stream);
+
+    static bool
+    isEnabled();
+
+    static const char
+    *findingName(const Finding finding),
+    /// What makes the selectors of the finding expensive to match
+    *findingDescription(const Finding finding);
+};
+
+} // namespace CSS
+
+#endif // CSSSELECTORREPORT_H
@@ -0,0 +1,353 @@
+/******************************************************************************
+This source file is part of the project
+HyperSheetsPreprocessor (HSPP) - Optimizer and minifier for CSS
+Copyright (C) 2019 Waldemar Zimpel <hspp@utilizer.de>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://www.gnu.org/licenses/>.
+*******************************************************************************/
+
+#include "CssSizeReport.h"
+#include "CssPassManager.h"
+#include "CssVendorPrefixes.h"
+#include "generator/CssGenerator.h"
+#include "../String.h"
+#include "../defs.h"
+#include <algorithm>
+#include <map>
+#include <mutex>
+
+using namespace CSS;
+using namespace CSS::Generation;
+
+/// Output bytes of the rules with the same text in the same context of a file
+struct RuleRecord
+{
+    string file, context, rule;
+    uint64_t count {0}, bytes {0};
+};
+
+static bool s_enabled = false;
+static mutex s_mutex;
+static map<const CssBaseElement *, string> s_imported_files;
+static map<string, uint64_t> s_file_bytes, s_context_bytes;
+static map<string, RuleRecord> s_rules;
+static uint64_t s_output_bytes = 0, s_unattributed_bytes = 0;
+
+static string jsonString(const string &value)
+{
+    string result = "\"";
+
+    for (const auto &chr : value) {
+        if (chr == '"' || chr == '\\')
+            result += '\\';
+
+        result += chr;
+    }
+
+    return result + '"';
+}
+
+/// Generated text of a rule up to its block, with collapsed white space
+static string ruleLabel(const string &generated)
+{
+    string label;
+
+    for (const auto &chr : generated.substr(0, generated.find('{'))) {
+        if (isspace(chr)) {
+            if (!label.empty() && label.back() != ' ')
+                label += ' ';
+        } else label += chr;
+    }
+
+    while (!label.empty() && (label.back() == ' ' || label.back() == ';'))
+        label.pop_back();
+
+    return label;
+}
+
+/// At-rules, whose rules are attributed separately in the context of the at-rule
+static bool isGroupingRule(const CssAtRulePtr &at_rule)
+{
+    static const Vendor vendor;
+
+    for (const auto &keyword : {"media", "supports", "document", "layer", "container"})
+        if (vendor.maybePrefixedKeyword(at_rule->keyword(), keyword))
+            return true;
+
+    return false;
+}
+
+static void addRule(const string &file, const string &context, const string &rule, const uint64_t bytes)
+{
+    s_file_bytes[file] += bytes;
+    s_context_bytes[context] += bytes;
+
+    auto &record = s_rules[file + '\n' + context + '\n' + rule];
+
+    if (record.count == 0) {
+        record.file = file;
+        record.context = context;
+        record.rule = rule;
+    }
+
+    ++record.count;
+    record.bytes += bytes;
+}
+
+static uint64_t attributeElement(const CssBaseElementPtr &element, const string &file, const string &context);
+
+/// Attributes the elements of the block and returns their number of bytes
+static uint64_t attributeElements(const CssBlockPtr &block, string file, const string &context)
+{
+    const auto imported_file = s_imported_files.find(&*block);
+
+    if (imported_file != s_imported_files.end())
+        file = imported_file->second;
+
+    uint64_t bytes = 0;
+
+    for (const auto &element : block->elements())
+        bytes += attributeElement(element, file, context);
+
+    return bytes;
+}
+
+static uint64_t attributeElement(const CssBaseElementPtr &element, const string &file, const string &context)
+{
+    // @import rules, which are replaced by the imported stylesheet
+    if (element->replacementElement()) {
+        const auto &replacement = element->replacementElement();
+
+        if (replacement->isOfType(CssBaseElement::BLOCK))
+            return attributeElements(static_pointer_cast<CssBlock>(replacement), file, context);
+
+        return attributeElement(replacement, file, context);
+    }
+
+    string generated;
+    CssGenerator css_generator(generated);
+    element->accept(css_generator);
+
+    uint64_t bytes = generated.length();
+
+    if (element->isAtRule()) {
+        const auto at_rule = static_pointer_cast<CssAtRule>(element);
+
+        if (at_rule->block() && isGroupingRule(at_rule)) {
+            const auto prelude = ruleLabel(generated);
+            const auto rule_bytes =
+                attributeElements(at_rule->block(), file, context.empty() ? prelude : context + " > " + prelude);
+
+            // Only the prelude and the braces remain for the at-rule itself
+            bytes = bytes > rule_bytes ? bytes - rule_bytes : 0;
+            addRule(file, context, prelude + "{}", bytes);
+
+            return bytes + rule_bytes;
+        }
+    }
+
+    addRule(file, context, element->isComment() ? "(comment)" : ruleLabel(generated), bytes);
+
+    return bytes;
+}
+
+/*static*/ void
+CssSizeReport::
+enable()
+{
+    s_enabled = true;
+}
+
+/*static*/ bool
+CssSizeReport::
+isEnabled()
+{
+    return s_enabled;
+}
+
+/*static*/ void
+CssSizeReport::
+setImportedFile(const CssBaseElementPtr &imported_stylesheet, const string &file_path)
+{
+    lock_guard<mutex> lock(s_mutex);
+    s_imported_files[&*imported_stylesheet] = file_path;
+}
+
+/*static*/ void
+CssSizeReport::
+addStyleSheet(const CssBaseElementPtr &stylesheet, const string &file_path, const uint64_t output_size)
+{
+    lock_guard<mutex> lock(s_mutex);
+
+    const auto bytes = attributeElements(static_pointer_cast<CssBlock>(stylesheet), file_path, string());
+
+    s_output_bytes += output_size;
+    // The file header and the separators between the rules
+    s_unattributed_bytes += output_size > bytes ? output_size - bytes : 0;
+}
+
+/*static*/ uint64_t
+CssSizeReport::
+generatedSize(const CssBaseElementPtr &element)
+{
+    string generated;
+    CssGenerator css_generator(generated);
+    element->accept(css_generator);
+
+    return generated.length();
+}
+
+/// Entries of the table sorted by their number of bytes, the largest first
+static DataContainer<pair<string, uint64_t> > sortedBySize(const map<string, uint64_t> &table)
+{
+    DataContainer<pair<string, uint64_t> > entries(table.begin(), table.end());
+
+    stable_sort(entries.begin(), entries.end(), [](const pair<string, uint64_t> &a, const pair<string, uint64_t> &b) {
+        return a.second > b.second;
+    });
+
+    return entries;
+}
+
+static DataContainer<RuleRecord> sortedRules()
+{
+    DataContainer<RuleRecord> rules;
+    rules.reserve(s_rules.size());
+
+    for (const auto &rule : s_rules)
+        rules.emplace_back(rule.second);
+
+    stable_sort(rules.begin(), rules.end(), [](const RuleRecord &a, const RuleRecord &b) {
+        return a.bytes > b.bytes;
+    });
+
+    return rules;
+}
+
+static DataContainer<pair<string, int64_t> > sortedSavings()
+{
+    DataContainer<pair<string, int64_t> > savings;
+
+    for (uint8_t pass = 0; pass < CssPassManager::PASS_COUNT; ++pass)
+        savings.emplace_back(CssPassManager::passName(CssPassManager::Pass(pass)),
+                             CssPassManager::savedBytes(CssPassManager::Pass(pass)));
+
+    stable_sort(savings.begin(), savings.end(), [](const pair<string, int64_t> &a, const pair<string, int64_t> &b) {
+        return a.second > b.second;
+    });
+
+    return savings;
+}
+
+/*static*/ void
+CssSizeReport::
+writeJson(ostream &stream)
+{
+    lock_guard<mutex> lock(s_mutex);
+
+    stream << "{\"output_bytes\":" << s_output_bytes
+           << ",\"unattributed_bytes\":" << s_unattributed_bytes << ",\"files\":[";
+
+    const auto files = sortedBySize(s_file_bytes);
+
+    for (const auto &file : files)
+        stream << (&file != &files.front() ? "," : "") << NEWLINE
+               << "{\"file\":" << jsonString(file.first) << ",\"bytes\":" << file.second << "}";
+
+    stream << "],\"contexts\":[";
+
+    const auto contexts = sortedBySize(s_context_bytes);
+
+    for (const auto &context : contexts)
+        stream << (&context != &contexts.front() ? "," : "") << NEWLINE
+               << "{\"context\":" << jsonString(context.first) << ",\"bytes\":" << context.second << "}";
+
+    stream << "],\"rules\":[";
+
+    const auto rules = sortedRules();
+
+    for (const auto &rule : rules)
+        stream << (&rule != &rules.front() ? "," : "") << NEWLINE
+               << "{\"file\":" << jsonString(rule.file)
+               << ",\"context\":" << jsonString(rule.context)
+               << ",\"rule\":" << jsonString(rule.rule)
+               << ",\"count\":" << rule.count
+               << ",\"bytes\":" << rule.bytes << "}";
+
+    stream << "],\"saved_bytes\":{";
+
+    for (uint8_t pass = 0; pass < CssPassManager::PASS_COUNT; ++pass)
+        stream << (pass != 0 ? "," : "") << jsonString(CssPassManager::passName(CssPassManager::Pass(pass)))
+               << ":" << CssPassManager::savedBytes(CssPassManager::Pass(pass));
+
+    stream << "}}" << endl;
+}
+
+/*static*/ void
+CssSizeReport::
+writeSummary(ostream &stream)
+{
+    // Number of rules listed in the summary, all of them are in the JSON file
+    constexpr uint64_t SUMMARY_RULE_COUNT = 20;
+    // Rule and context texts are cut to this length in the summary
+    constexpr uint64_t LABEL_LENGTH = 56;
+
+    lock_guard<mutex> lock(s_mutex);
+
+    const auto alignRight = [](const string &value, const uint64_t width) -> string {
+        return value.length() < width ? String::repeatChar(' ', width - value.length()) + value : value;
+    };
+
+    const auto alignLeft = [](string value, const uint64_t width) -> string {
+        if (value.length() > width)
+            value = value.substr(0, width - 3) + "...";
+
+        return value + String::repeatChar(' ', width - value.length() + 1);
+    };
+
+    const auto percentage = [](const uint64_t bytes) -> string {
+        return String::numberFormat(s_output_bytes ? 100.0 * bytes / s_output_bytes : 0, 1) + "%";
+    };
+
+    stream << NEWLINE "Output size: " << s_output_bytes << " bytes" NEWLINE LINE
+           << alignLeft("File", LABEL_LENGTH) << alignRight("Bytes", 12) << alignRight("Share", 9) << NEWLINE;
+
+    for (const auto &file : sortedBySize(s_file_bytes))
+        stream << alignLeft(file.first, LABEL_LENGTH) << alignRight(to_string(file.second), 12)
+               << alignRight(percentage(file.second), 9) << NEWLINE;
+
+    stream << alignLeft("(file headers and separators)", LABEL_LENGTH) << alignRight(to_string(s_unattributed_bytes), 12)
+           << alignRight(percentage(s_unattributed_bytes), 9) << DBLNEWLINE
+           << alignLeft("Context", LABEL_LENGTH) << alignRight("Bytes", 12) << alignRight("Share", 9) << NEWLINE;
+
+    for (const auto &context : sortedBySize(s_context_bytes))
+        stream << alignLeft(context.first.empty() ? "(top level)" : context.first, LABEL_LENGTH)
+               << alignRight(to_string(context.second), 12) << alignRight(percentage(context.second), 9) << NEWLINE;
+
+    stream << NEWLINE << alignLeft("Largest rules", LABEL_LENGTH) << alignRight("Bytes", 12)
+           << alignRight("Share", 9) << alignRight("Count", 8) << NEWLINE;
+
+    const auto rules = sortedRules();
+
+    for (uint64_t i = 0; i < rules.size() && i < SUMMARY_RULE_COUNT; ++i)
+        stream << alignLeft(rules[i].context.empty() ? rules[i].rule : rules[i].context + " > " + rules[i].rule, LABEL_LENGTH) << alignRight(to_string(rules[i].bytes), 12)
+               << alignRight(percentage(rules[i].bytes), 9) << alignRight(to_string(rules[i].count), 8) << NEWLINE;
+
+    stream << NEWLINE << alignLeft("Pass", LABEL_LENGTH) << alignRight("Saved bytes", 12) << NEWLINE;
+
+    for (const auto &saving : sortedSavings())
+        stream << alignLeft(saving.first, LABEL_LENGTH) << alignRight(to_string(saving.second), 12) << NEWLINE;
+
+    stream << LINE << endl;
+}
@@ -0,0 +1,62 @@
+/******************************************************************************
+This source file is part of the project
+HyperSheetsPreprocessor (HSPP) - Optimizer and minifier for CSS
+Copyright (C) 2019 Waldemar Zimpel <hspp@utilizer.de>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://www.gnu.org/licenses/>.
+*******************************************************************************/
+
+#ifndef CSSSIZEREPORT_H
+#define CSSSIZEREPORT_H
+#include "parser/elements/CssBaseElement.h"
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+namespace CSS {
+using namespace CSS::Parsing::Elements;
+
+/// Attributes the bytes of the output to the source files, top-level rules
+/// and at-rule contexts they come from, and lists the bytes saved by the
+/// single passes. Reported with the command line argument '--size-report'.
+class CssSizeReport final
+{
+public:
+    static void
+    enable(),
+
+    /// Marks the parsed content of an @import rule, which is included
+    /// into the importing stylesheet, as coming from file_path
+    setImportedFile(const CssBaseElementPtr &imported_stylesheet, const string &file_path),
+
+    /// Attributes the elements of the minified stylesheet of file_path,
+    /// whose whole output is output_size bytes long
+    addStyleSheet(const CssBaseElementPtr &stylesheet, const string &file_path, const uint64_t output_size),
+
+    writeJson(ostream &stream),
+
+    /// Writes the files, contexts, rules and passes sorted by size
+    writeSummary(ostream &stream);
+
+    static bool
+    isEnabled();
+
+    /// Number of bytes the generator writes for the element
+    static uint64_t
+    generatedSize(const CssBaseElementPtr &element);
+};
+
+} // namespace CSS
+
+#endif // CSSSIZEREPORT_H
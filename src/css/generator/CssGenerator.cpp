@@ -20,8 +20,9 @@ along with this program. If not, see <https://www.gnu.org/licenses/>.
 #include "CssGenerator.h"
 using namespace CSS::Generation;
 
+// The buffer is owned by the caller, so it must not be deleted with the generator
 CssGenerator::CssGenerator(string &minified_content) :
-    m_output_buffer_ptr(make_shared<string>(minified_content)) {}
+    m_output_buffer_ptr(&minified_content, [](string *) {}) {}
 
 CssGenerator::CssGenerator(shared_ptr<string> minified_content) :
     m_output_buffer_ptr(move(minified_content)) {}
@@ -70,15 +71,15 @@ visit(const CssAtRulePtr &at_rule)
 
         if (m_beautify) {
             m_output_buffer += '\n';
-            if (at_rule->expressions()->size() > 1)
+            if (at_rule->expressions() && at_rule->expressions()->size() > 1)
                 m_output_buffer += '\n';
 
-            ++s_indent_width;
+            ++m_indent_width;
         }
 
         for (const auto &element : at_rule->block()->elements()) {
             if (m_beautify)
-                m_output_buffer += String::repeatChar('\t', s_indent_width);
+                m_output_buffer += String::repeatChar('\t', m_indent_width);
 
             element->accept(*this);
 
@@ -94,8 +95,8 @@ visit(const CssAtRulePtr &at_rule)
         }
 
         if (m_beautify) {
-            --s_indent_width;
-            m_output_buffer += String::repeatChar('\t', s_indent_width);
+            --m_indent_width;
+            m_output_buffer += String::repeatChar('\t', m_indent_width);
         }
 
         if (m_output_buffer.back() == '\n' && *(m_output_buffer.end()-2) == '\n')
@@ -115,8 +116,7 @@ CssGenerator::
 visit(const CssBlockPtr &block)
 {
     if (block->blockType() == CssBlock::STYLESHEET)
-        if (!m_beautify)
-            m_output_buffer += OUTPUT_FILE_HEADER "\n";
+        beginStyleSheet();
 
     switch (block->blockType()) {
     case CssBlock::CURLY:
@@ -127,7 +127,7 @@ visit(const CssBlockPtr &block)
 
         if (m_beautify) {
             m_output_buffer += '\n';
-            ++s_indent_width;
+            ++m_indent_width;
         }
 
         break;
@@ -140,38 +140,15 @@ visit(const CssBlockPtr &block)
     default:;
     }
 
-    for (const auto &element : block->elements()) {
-        if (m_beautify)
-            m_output_buffer += String::repeatChar('\t', s_indent_width);
-
-        if (element->isIdentifier() && block->elements().size() != 1 && &element != &block->elements().front())
-            m_output_buffer += ' ';
-
-        element->accept(*this);
-
-        if (&element != &block->elements().back() &&
-            element->isDeclaration()) {
-            m_output_buffer += ';';
-        }
-
-        if (m_beautify && block->blockType() == CssBlock::CURLY) {
-            m_output_buffer += '\n';
-
-            if (&element == &block->elements().back()) {
-                --s_indent_width;
-                m_output_buffer += String::repeatChar('\t', s_indent_width);
-            }
-        }
-
-        if (element->isIdentifier() && block->elements().size() != 1)
-            m_output_buffer += ' ';
-    }
+    if (block->blockType() == CssBlock::STYLESHEET)
+        generateStyleSheetElements(block);
+    else
+        for (const auto &element : block->elements())
+            visitBlockElement(block, element);
 
     switch (block->blockType()) {
     case CssBlock::STYLESHEET:
-        while (m_output_buffer.back() == '\n')
-            m_output_buffer.pop_back();
-
+        endStyleSheet();
         break;
     case CssBlock::CURLY:
         m_output_buffer += '}';
@@ -190,6 +167,127 @@ visit(const CssBlockPtr &block)
     }
 }
 
+void
+CssGenerator::
+beginStyleSheet()
+{
+    if (!m_beautify)
+        m_output_buffer += OUTPUT_FILE_HEADER "\n";
+}
+
+void
+CssGenerator::
+endStyleSheet()
+{
+    while (!m_output_buffer.empty() && m_output_buffer.back() == '\n')
+        m_output_buffer.pop_back();
+}
+
+void
+CssGenerator::
+visitBlockElement(const CssBlockPtr &block, const CssBaseElementPtr &element)
+{
+    // The element has to be a reference to an element of the block
+    if (m_beautify)
+        m_output_buffer += String::repeatChar('\t', m_indent_width);
+
+    if (element->isIdentifier() && block->elements().size() != 1 && &element != &block->elements().front())
+        m_output_buffer += ' ';
+
+    element->accept(*this);
+
+    if (&element != &block->elements().back() &&
+        element->isDeclaration()) {
+        m_output_buffer += ';';
+    }
+
+    if (m_beautify && block->blockType() == CssBlock::CURLY) {
+        m_output_buffer += '\n';
+
+        if (&element == &block->elements().back()) {
+            --m_indent_width;
+            m_output_buffer += String::repeatChar('\t', m_indent_width);
+        }
+    }
+
+    if (element->isIdentifier() && block->elements().size() != 1)
+        m_output_buffer += ' ';
+}
+
+void
+CssGenerator::
+generateStyleSheetElements(const CssBlockPtr &stylesheet)
+{
+    // Stylesheets with fewer top-level elements are always generated on a single thread
+    constexpr uint64_t MIN_RANGE_SIZE = 256;
+
+    const auto &elements = stylesheet->elements();
+    const auto thread_count = Parallel::threadCount();
+    const auto range_count = min<uint64_t>(thread_count * 4, elements.size() / MIN_RANGE_SIZE);
+
+    if (thread_count < 2 || range_count < 2) {
+        for (const auto &element : elements)
+            visitBlockElement(stylesheet, element);
+
+        return;
+    }
+
+    // Comments, delimiters and imported stylesheets look at the preceding
+    // output, so a range may only begin at a rule
+    const auto isRangeBegin = [&](const uint64_t index) -> bool {
+        const auto &element = elements.at(index);
+
+        return element->isQualifiedRule() ||
+            (element->isAtRule() && !static_pointer_cast<CssAtRule>(element)->replacementElement());
+    };
+
+    DataContainer<uint64_t> bounds(range_count + 1);
+    bounds.appendElement(0);
+
+    for (uint64_t i = 1; i < range_count; ++i) {
+        auto bound = max<uint64_t>(elements.size() * i / range_count, bounds.back());
+
+        while (bound < elements.size() && !isRangeBegin(bound))
+            ++bound;
+
+        bounds.appendElement(bound);
+    }
+
+    bounds.appendElement(elements.size());
+
+    // The first range is generated into this buffer, each of the other
+    // ranges into a buffer of its own. They are concatenated in order.
+    DataContainer<shared_ptr<string> > buffers(range_count);
+    buffers.appendElement(m_output_buffer_ptr);
+
+    for (uint64_t i = 1; i < range_count; ++i)
+        buffers.appendElement(make_shared<string>());
+
+    Parallel::forEach(range_count, [&](const uint64_t index) {
+        if (index == 0) {
+            for (auto i = bounds.at(0); i < bounds.at(1); ++i)
+                visitBlockElement(stylesheet, elements.at(i));
+
+            return;
+        }
+
+        CssGenerator css_generator(buffers.at(index));
+
+        for (auto i = bounds.at(index); i < bounds.at(index + 1); ++i)
+            css_generator.visitBlockElement(stylesheet, elements.at(i));
+    });
+
+    uint64_t output_size = 0;
+
+    for (const auto &buffer : buffers)
+        output_size += buffer->size();
+
+    m_output_buffer.reserve(output_size);
+
+    for (uint64_t i = 1; i < range_count; ++i)
+        m_output_buffer += *buffers.at(i);
+}
+
 void
 CssGenerator::
 visit(const CssDeclarationPtr &declaration)
@@ -368,7 +466,7 @@ visit(const CssQualifiedRulePtr &qualified_rule)
 
             if (m_beautify) {
                 m_output_buffer += '\n';
-                m_output_buffer += String::repeatChar('\t', s_indent_width);
+                m_output_buffer += String::repeatChar('\t', m_indent_width);
             }
         }
     }
@@ -23,6 +23,7 @@ along with this program. If not, see <https://www.gnu.org/licenses/>.
 #include "../../defs.h"
 #include "../../general/visitor/VisitorInterface.h"
 #include "../parser/includes.h"
+#include "../../Parallel.h"
 #include <stack>
 
 namespace CSS {
@@ -66,6 +67,13 @@ public:
     visit(const CssSupportsConditionPtr &)    override,
     visit(const CssCommentPtr &)              override;
 
+    // Used by the pipelined minifier. The top-level elements of the
+    // stylesheet are generated in batches, as soon as they are modified.
+    void
+    beginStyleSheet(),
+    generateStyleSheetElements(const CssBlockPtr &stylesheet),
+    endStyleSheet();
+
     inline const string &
     outputBuffer() const;
 
@@ -87,12 +95,16 @@ private:
     context(const Context context) const,
     context(const initializer_list<Context> candidates) const;
 
+    void
+    visitBlockElement(const CssBlockPtr &block, const CssBaseElementPtr &element);
+
     stack<Context> m_context_stack {{STYLESHEET}};
 
     bool m_beautify {cfg.isEnabled(Config::GENERAL__BEAUTIFY_OUTPUT)};
-};
 
-static uint8_t s_indent_width = 0;
+    /// Current indentation level of beautified output
+    uint8_t m_indent_width {0};
+};
 
 inline void
 CssGenerator::
@@ -18,7 +18,11 @@ along with this program. If not, see <https://www.gnu.org/licenses/>.
 ******************************************************************************/
 
 #include "CssMinifier.h"
+#include "../../SyntaxError.h"
 #include "../../config/Config.h"
+#include "../CssSelectorReport.h"
+#include "../CssSizeReport.h"
+#include <thread>
 
 using namespace CSS::Minification;
 using namespace CSS::Generation;
@@ -30,6 +34,16 @@ CssMinifier::CssMinifier(const CssBaseElementPtr &&ast) :
 CssMinifier::
 minify(const shared_ptr<string> &content)
 {
+    // Size of the chunks the content is split into for the pipeline
+    constexpr uint64_t PIPELINE_SEGMENT_SIZE = 16 * 1024;
+
+    if (cfg.isEnabled(Config::GENERAL__PIPELINE)) {
+        const auto segments = CssTokenizer::splitTopLevelRules(*content, PIPELINE_SEGMENT_SIZE);
+
+        if (segments.size() > 1)
+            return CssMinifier(make_shared<CssBlock>(CssBlock::STYLESHEET)).minifyPipelined(content, segments);
+    }
+
     const auto ast = CssParser::parse(content);
     return CssMinifier(ast).minify();
 }
@@ -49,8 +63,137 @@ minify()
     CssModifier css_modifier;
     CssGenerator css_generator(outputBuffer());
 
+    Statistics::PhaseTimer modify_timer(Statistics::MODIFY);
     m_parse_tree->accept(css_modifier);
+    modify_timer.stop();
+
+    Statistics::PhaseTimer generate_timer(Statistics::GENERATE);
     m_parse_tree->accept(css_generator);
+    generate_timer.stop();
+
+    if (CssSizeReport::isEnabled())
+        CssSizeReport::addStyleSheet(m_parse_tree, cfg.inputPath(), outputBuffer()->length());
+
+    if (CssSelectorReport::isEnabled())
+        CssSelectorReport::addStyleSheet(m_parse_tree, cfg.inputPath());
+
+    return outputBuffer();
+}
+
+const shared_ptr<string>
+CssMinifier::
+minifyPipelined(const shared_ptr<string> &content, const DataContainer<CssTokenizer::Segment> &segments)
+{
+    // Number of chunks, which may wait between two stages
+    constexpr size_t QUEUE_CAPACITY = 4;
+
+    // Tokenizing, parsing, modifying and generating run on threads of their
+    // own, connected by queues. Each chunk of top-level rules is passed on
+    // to the next stage as soon as it is done.
+    BoundedQueue<GeneralTokenStreamPtr> token_streams(QUEUE_CAPACITY);
+    BoundedQueue<CssBlockPtr> parsed_rules(QUEUE_CAPACITY), modified_rules(QUEUE_CAPACITY);
+
+    const auto stylesheet = static_pointer_cast<CssBlock>(m_parse_tree);
+
+    CssModifier css_modifier;
+    CssGenerator css_generator(outputBuffer());
+
+    // If the modifier needs to see the whole stylesheet, generating has to
+    // wait until all rules are modified
+    const bool barrier = css_modifier.needsWholeStyleSheet();
+
+    // Syntax errors of the tokenizing and parsing stages, which are reported
+    // on this thread after all stages have finished
+    string tokenizer_error, parser_error;
+
+    thread tokenizer([&]() {
+        SyntaxError::DeferScope defer_errors;
+
+        try {
+            for (const auto &segment : segments)
+                token_streams.push(CssTokenizer::tokenize(content->substr(segment.begin, segment.end - segment.begin),
+                                                          segment.begin_row, segment.begin_column));
+        } catch (const SyntaxError &error) {
+            tokenizer_error = error.what();
+        }
+
+        token_streams.close();
+    });
+
+    thread parser([&]() {
+        SyntaxError::DeferScope defer_errors;
+        GeneralTokenStreamPtr token_stream;
+
+        try {
+            while (token_streams.pop(token_stream))
+                parsed_rules.push(CssParser::parse(token_stream));
+        } catch (const SyntaxError &error) {
+            parser_error = error.what();
+
+            // Let the tokenizer finish
+            while (token_streams.pop(token_stream));
+        }
+
+        parsed_rules.close();
+    });
+
+    thread modifier([&]() {
+        CssBlockPtr rules;
+
+        css_modifier.beginStyleSheet(stylesheet);
+
+        while (parsed_rules.pop(rules)) {
+            Statistics::PhaseTimer modify_timer(Statistics::MODIFY);
+            css_modifier.modifyStyleSheetElements(rules);
+            modify_timer.stop();
+
+            if (!barrier)
+                modified_rules.push(rules);
+        }
+
+        Statistics::PhaseTimer modify_timer(Statistics::MODIFY);
+        css_modifier.endStyleSheet();
+        modify_timer.stop();
+
+        modified_rules.close();
+    });
+
+    CssBlockPtr rules;
+
+    if (!barrier)
+        css_generator.beginStyleSheet();
+
+    while (modified_rules.pop(rules)) {
+        Statistics::PhaseTimer generate_timer(Statistics::GENERATE);
+        css_generator.generateStyleSheetElements(rules);
+    }
+
+    tokenizer.join();
+    parser.join();
+    modifier.join();
+
+    // The parser only gets the segments before an erroneous one from the
+    // tokenizer, so its error comes first in document order
+    if (!parser_error.empty())
+        SyntaxError::raise(parser_error);
+
+    if (!tokenizer_error.empty())
+        SyntaxError::raise(tokenizer_error);
+
+    Statistics::PhaseTimer generate_timer(Statistics::GENERATE);
+
+    if (barrier)
+        stylesheet->accept(css_generator);
+    else
+        css_generator.endStyleSheet();
+
+    generate_timer.stop();
+
+    if (CssSizeReport::isEnabled())
+        CssSizeReport::addStyleSheet(stylesheet, cfg.inputPath(), outputBuffer()->length());
+
+    if (CssSelectorReport::isEnabled())
+        CssSelectorReport::addStyleSheet(stylesheet, cfg.inputPath());
 
     return outputBuffer();
 }
@@ -19,6 +19,7 @@ along with this program. If not, see <https://www.gnu.org/licenses/>.
 
 #ifndef CSSMINIFIER_H
 #define CSSMINIFIER_H
+#include "../../BoundedQueue.h"
 #include "../../config/Config.h"
 #include "../../general/minifier/GeneralMinifier.h"
 #include "../generator/CssGenerator.h"
@@ -46,6 +47,9 @@ public:
     minify(const string &content);
 
 private:
+    const shared_ptr<string>
+    minifyPipelined(const shared_ptr<string> &content, const DataContainer<CssTokenizer::Segment> &segments);
+
     CssBaseElementPtr m_parse_tree;
 };
 
@@ -19,33 +19,90 @@ along with this program. If not, see <https://www.gnu.org/licenses/>.
 
 #include "CssModifier.h"
 #include "../../filesystem/FileSystemWorker.h"
+#include "../generator/CssGenerator.h"
+#include "../CssBrowserSupport.h"
+#include <array>
 using namespace CSS::Minification;
 
-shared_ptr<HashTable<string, IdentInfo<shared_ptr<string> > > >
+static uint64_t identifierLength(const shared_ptr<string> &identifier)
+{
+    return identifier->length();
+}
+
+static uint64_t identifierLength(const CssIdentifierPtr &identifier)
+{
+    return identifier->value().length();
+}
+
+/// Bytes saved by renaming every occurrence of the identifiers of the
+/// replacement list, whose keys are the original names
+template<class T>
+static int64_t renamedBytes(const HashTable<string, IdentInfo<T> > &replacement_list)
+{
+    int64_t bytes = 0;
+
+    for (const auto &pair : replacement_list)
+        bytes += (int64_t(pair.first.length()) - int64_t(identifierLength(pair.second.identifier))) * pair.second.count;
+
+    return bytes;
+}
+
+thread_local shared_ptr<HashTable<string, IdentInfo<shared_ptr<string> > > >
 CSS::Minification::g_id_replacement_list = make_shared<HashTable<string, IdentInfo<shared_ptr<string> > > >(),
 CSS::Minification::g_class_replacement_list = make_shared<HashTable<string, IdentInfo<shared_ptr<string> > > >();
 
-shared_ptr<HashTable<string, IdentInfo<CssIdentifierPtr> > >
+thread_local shared_ptr<HashTable<string, IdentInfo<CssIdentifierPtr> > >
 CSS::Minification::g_cprop_replacement_list = make_shared<HashTable<string, IdentInfo<CssIdentifierPtr> > >(),
 CSS::Minification::g_anim_replacement_list = make_shared<HashTable<string, IdentInfo<CssIdentifierPtr> > >();
 
+bool
+CssModifier::s_minify_dimensions = false,
+CssModifier::s_simplify_math_functions = false,
+CssModifier::s_rewrite_values = false,
+CssModifier::s_remove_vendor_prefixes = false,
+CssModifier::s_rewrite_shorthands = false,
+CssModifier::s_merge_longhands = false,
+CssModifier::s_remove_overridden_declarations = false,
+CssModifier::s_rewrite_selectors = false,
+CssModifier::s_unquote_urls = false;
+
 CssModifier::CssModifier()
+{
+    readSettings();
+}
+
+// The flags are only written by the modifier of the whole stylesheet,
+// before the modifiers of the ranges are visiting on other threads
+CssModifier::CssModifier(RangeModifier) {}
+
+/*static*/ void
+CssModifier::
+readSettings()
 {
     s_output_to_stdo                = cfg.isEnabled(Config::GENERAL__OUTPUT_TO_STDO);
     s_use_utf8_bom                  = cfg.isEnabled(Config::GENERAL__USE_UTF8_BOM);
     s_create_json_file              = cfg.isEnabled(Config::GENERAL__CREATE_JSON_FILE);
     s_include_external_stylesheets  = cfg.isEnabled(Config::CSS__INCLUDE_EXTERNAL_STYLESHEETS);
-    s_remove_comments               = cfg.isEnabled(Config::CSS__REMOVE_COMMENTS);
-    s_remove_empty_rules            = cfg.isEnabled(Config::CSS__REMOVE_EMPTY_RULES);
-    s_minify_ids                    = cfg.isEnabled(Config::CSS__MINIFY_IDS);
-    s_minify_class_names            = cfg.isEnabled(Config::CSS__MINIFY_CLASS_NAMES);
-    s_minify_custom_properties      = cfg.isEnabled(Config::CSS__MINIFY_CUSTOM_PROPERTIES);
-    s_minify_animation_names        = cfg.isEnabled(Config::CSS__MINIFY_ANIMATION_NAMES);
-    s_minify_numbers                = cfg.isEnabled(Config::CSS__MINIFY_NUMBERS);
-    s_minify_colors                 = cfg.isEnabled(Config::CSS__MINIFY_COLORS);
-    s_rewrite_angles                = cfg.isEnabled(Config::CSS__REWRITE_ANGLES);
-    s_use_rgba_hex_color_notation   = cfg.isEnabled(Config::CSS__USE_RGBA_HEX_NOTATION);
-    s_rewrite_functions             = cfg.isEnabled(Config::CSS__REWRITE_FUNCTIONS);
+    s_remove_comments               = CssPassManager::isEnabled(CssPassManager::REMOVE_COMMENTS);
+    s_remove_empty_rules            = CssPassManager::isEnabled(CssPassManager::REMOVE_EMPTY_RULES);
+    s_minify_ids                    = CssPassManager::isEnabled(CssPassManager::MINIFY_IDS);
+    s_minify_class_names            = CssPassManager::isEnabled(CssPassManager::MINIFY_CLASS_NAMES);
+    s_minify_custom_properties      = CssPassManager::isEnabled(CssPassManager::MINIFY_CUSTOM_PROPERTIES);
+    s_minify_animation_names        = CssPassManager::isEnabled(CssPassManager::MINIFY_ANIMATION_NAMES);
+    s_minify_numbers                = CssPassManager::isEnabled(CssPassManager::MINIFY_NUMBERS);
+    s_minify_dimensions             = CssPassManager::isEnabled(CssPassManager::MINIFY_DIMENSIONS);
+    s_minify_colors                 = CssPassManager::isEnabled(CssPassManager::MINIFY_COLORS);
+    s_rewrite_angles                = CssPassManager::isEnabled(CssPassManager::REWRITE_ANGLES);
+    s_use_rgba_hex_color_notation   = CssPassManager::isEnabled(CssPassManager::USE_RGBA_HEX_NOTATION);
+    s_rewrite_functions             = CssPassManager::isEnabled(CssPassManager::REWRITE_FUNCTIONS);
+    s_simplify_math_functions       = CssPassManager::isEnabled(CssPassManager::SIMPLIFY_MATH_FUNCTIONS);
+    s_rewrite_values                = CssPassManager::isEnabled(CssPassManager::REWRITE_VALUES);
+    s_remove_vendor_prefixes        = CssPassManager::isEnabled(CssPassManager::REMOVE_VENDOR_PREFIXES);
+    s_rewrite_shorthands            = CssPassManager::isEnabled(CssPassManager::REWRITE_SHORTHANDS);
+    s_merge_longhands               = CssPassManager::isEnabled(CssPassManager::MERGE_LONGHANDS);
+    s_remove_overridden_declarations = CssPassManager::isEnabled(CssPassManager::REMOVE_OVERRIDDEN_DECLARATIONS);
+    s_rewrite_selectors             = CssPassManager::isEnabled(CssPassManager::REWRITE_SELECTORS);
+    s_unquote_urls                  = CssPassManager::isEnabled(CssPassManager::UNQUOTE_URLS);
 }
 
 void
@@ -64,7 +121,7 @@ visit(const CssAtRulePtr &at_rule)
 
         if (s_use_utf8_bom) {
             if (charset->value() == "utf-8") {
-                m_block_stack.top()->removeElement(at_rule);
+                removeVisitedElement();
                 return;
             }
 
@@ -80,7 +137,7 @@ visit(const CssAtRulePtr &at_rule)
             while (true) {
                 switch (choice) {
                 case 1:
-                    m_block_stack.top()->removeElement(at_rule);
+                    removeVisitedElement();
                     Console::writeLine("UTF8 BOM has been written." NEWLINE
                                        "@charset rule has been removed." NEWLINE);
                     return;
@@ -124,6 +181,7 @@ visit(const CssAtRulePtr &at_rule)
                             found->second.defined = true;
                         } else {
                             auto ident_info = IdentInfo<CssIdentifierPtr>(identifier, true);
+                            ident_info.index = g_anim_replacement_list->size();
                             g_anim_replacement_list->emplace(identifier->value(), ident_info);
                         }
                     }
@@ -137,7 +195,10 @@ visit(const CssAtRulePtr &at_rule)
             if (m_vendor.maybePrefixedKeyword(at_rule->keyword(), "keyframes"))
                 popContextIf(KEYFRAMES_BLOCK);
         } else if (s_remove_empty_rules) {
-            m_block_stack.top()->removeElement(at_rule);
+            if (CssPassManager::isCountingBytes())
+                CssPassManager::addSavedBytes(CssPassManager::REMOVE_EMPTY_RULES, int64_t(CssSizeReport::generatedSize(at_rule)));
+
+            removeVisitedElement();
             return;
         }
     }
@@ -178,89 +239,317 @@ visit(const CssBlockPtr &block)
 
     m_block_stack.emplace(block);
 
-    block->elements().iterateAll([&](const CssBaseElementPtr &element) -> void {
-        element->accept(*this);
-    });
+    if (block->blockType() == CssBlock::STYLESHEET && m_stylesheets.size() == 1)
+        visitStyleSheetElements(block);
+    else
+        visitElements(block);
 
     m_block_stack.pop();
 
-    if (block->blockType() == CssBlock::STYLESHEET) {
-        if (useUtf8Bom()) {
-            const auto &utf8_bom = make_shared<CssString>("\xef\xbb\xbf", true);
-            block->prependElement(utf8_bom);
+    if (block->blockType() == CssBlock::STYLESHEET)
+        finishStyleSheet(block);
+
+    popContextIf({STYLESHEET, CURLY_BLOCK, PAREN_BLOCK, SQUARE_BLOCK, DEFAULT_BLOCK});
+}
+
+void
+CssModifier::
+finishStyleSheet(const CssBlockPtr &stylesheet)
+{
+    if (useUtf8Bom()) {
+        const auto &utf8_bom = make_shared<CssString>("\xef\xbb\xbf", true);
+        stylesheet->prependElement(utf8_bom);
+    }
+
+    // Supports rules are evaluated, custom properties are inlined and
+    // unused definitions are removed before the remaining names are renamed
+    if (m_stylesheets.size() == 1) {
+        Statistics::PhaseTimer restructure_timer(Statistics::RESTRUCTURE);
+        m_restructuring.setStyleSheet(m_stylesheets.top());
+        m_restructuring.evaluateSupportsRules();
+        m_restructuring.inlineCustomProperties();
+        m_restructuring.removeUnusedDefinitions();
+        m_restructuring.removeVendorPrefixedRules();
+    }
+
+    if (!s_output_to_stdo &&
+        // Make sure, the file is written only on the initial input file
+        m_stylesheets.size() == 1) {
+
+        if (s_minify_ids) {
+            CssPassManager::PassScope pass(CssPassManager::MINIFY_IDS);
+            generateIds();
+        }
+        if (s_minify_class_names) {
+            CssPassManager::PassScope pass(CssPassManager::MINIFY_CLASS_NAMES);
+            generateClassNames();
+        }
+        if (s_minify_custom_properties) {
+            CssPassManager::PassScope pass(CssPassManager::MINIFY_CUSTOM_PROPERTIES);
+            generateCustomPropertyNames();
+        }
+        if (s_minify_animation_names) {
+            CssPassManager::PassScope pass(CssPassManager::MINIFY_ANIMATION_NAMES);
+            generateAnimationNames();
+        }
+
+        if (CssPassManager::isCountingBytes()) {
+            CssPassManager::addSavedBytes(CssPassManager::MINIFY_IDS, renamedBytes(*g_id_replacement_list));
+            CssPassManager::addSavedBytes(CssPassManager::MINIFY_CLASS_NAMES, renamedBytes(*g_class_replacement_list));
+            CssPassManager::addSavedBytes(CssPassManager::MINIFY_CUSTOM_PROPERTIES, renamedBytes(*g_cprop_replacement_list));
+            CssPassManager::addSavedBytes(CssPassManager::MINIFY_ANIMATION_NAMES, renamedBytes(*g_anim_replacement_list));
         }
 
-        if (!s_output_to_stdo &&
+        if ((!g_id_replacement_list->empty() ||
+            !g_class_replacement_list->empty() ||
+            !g_cprop_replacement_list->empty() ||
+            !g_anim_replacement_list->empty()) &&
             // Make sure, the file is written only on the initial input file
-            m_stylesheets.size() == 1) {
-
-            if (s_minify_ids)
-                generateIds();
-            if (s_minify_class_names)
-                generateClassNames();
-            if (s_minify_custom_properties)
-                generateCustomPropertyNames();
-            if (s_minify_animation_names)
-                generateAnimationNames();
-
-            if ((!g_id_replacement_list->empty() ||
-                !g_class_replacement_list->empty() ||
-                !g_cprop_replacement_list->empty() ||
-                !g_anim_replacement_list->empty()) &&
-                // Make sure, the file is written only on the initial input file
-                (m_stylesheets.size() == 1 && !s_output_to_stdo)) {
-
-                writeJsonFile(APP_NAME ".json");
-            }
+            (m_stylesheets.size() == 1 && !s_output_to_stdo)) {
+
+            writeJsonFile(APP_NAME ".json");
         }
+    }
 
-        if (!s_output_to_stdo && m_stylesheets.size() == 1) {
+    if (!s_output_to_stdo && m_stylesheets.size() == 1) {
 
-            string
-            id_count = to_string(g_id_replacement_list->size()),
-            class_count = to_string(g_class_replacement_list->size()),
-            cprop_count = to_string(g_cprop_replacement_list->size()),
-            anim_count = to_string(g_anim_replacement_list->size());
+        string
+        id_count = to_string(g_id_replacement_list->size()),
+        class_count = to_string(g_class_replacement_list->size()),
+        cprop_count = to_string(g_cprop_replacement_list->size()),
+        anim_count = to_string(g_anim_replacement_list->size());
 
-            DataContainer<string> counter_data = {
-                id_count, class_count, cprop_count, anim_count
-            };
+        DataContainer<string> counter_data = {
+            id_count, class_count, cprop_count, anim_count
+        };
 
-            sort(counter_data.begin(), counter_data.end(),
-            [](const string &a, const string &b) {
-                return a.length() > b.length();
-            });
+        sort(counter_data.begin(), counter_data.end(),
+        [](const string &a, const string &b) {
+            return a.length() > b.length();
+        });
+
+        auto max_len = static_cast<uint8_t>(counter_data.front().length());
+
+        cout << "\n" << String::repeatChar('-', max_len + 18U) << "\n"
+             << "Found:\n"
+             << String::repeatChar('-', max_len + 18U) << "\n"
+             << String::repeatChar(' ', max_len - id_count.length())
+             << id_count
+             << " ids\n"
+             << String::repeatChar(' ', max_len - class_count.length())
+             << class_count
+             << " classes\n"
+             << String::repeatChar(' ', max_len - cprop_count.length())
+             << cprop_count
+             << " custom properties\n"
+             << String::repeatChar(' ', max_len - anim_count.length())
+             << anim_count
+             << " animation names\n"
+             << String::repeatChar('-', max_len + 18U) << "\n"
+             << endl;
+    }
 
-            auto max_len = static_cast<uint8_t>(counter_data.front().length());
+    if (m_stylesheets.size() == 1) {
+        Statistics::PhaseTimer restructure_timer(Statistics::RESTRUCTURE);
+        m_restructuring.setStyleSheet(m_stylesheets.top());
+        m_restructuring.restructure();
+        restructure_timer.stop();
+
+        Statistics::addCount("idents", "ids", g_id_replacement_list->size());
+        Statistics::addCount("idents", "classes", g_class_replacement_list->size());
+        Statistics::addCount("idents", "custom_properties", g_cprop_replacement_list->size());
+        Statistics::addCount("idents", "animation_names", g_anim_replacement_list->size());
+        Statistics::addCount("restructuring", "merged_media_rules", m_restructuring.mergedMediaRules());
+        Statistics::addCount("restructuring", "merged_rules", m_restructuring.mergedRules());
+        Statistics::addCount("restructuring", "removed_definitions", m_restructuring.removedDefinitions());
+        Statistics::addCount("restructuring", "inlined_custom_properties", m_restructuring.inlinedCustomProperties());
+        Statistics::addCount("restructuring", "removed_prefixed_rules", m_restructuring.removedPrefixedRules());
+        Statistics::addCount("restructuring", "evaluated_supports_rules", m_restructuring.evaluatedSupportsRules());
+    }
 
-            cout << "\n" << String::repeatChar('-', max_len + 18U) << "\n"
-                 << "Found:\n"
-                 << String::repeatChar('-', max_len + 18U) << "\n"
-                 << String::repeatChar(' ', max_len - id_count.length())
-                 << id_count
-                 << " ids\n"
-                 << String::repeatChar(' ', max_len - class_count.length())
-                 << class_count
-                 << " classes\n"
-                 << String::repeatChar(' ', max_len - cprop_count.length())
-                 << cprop_count
-                 << " custom properties\n"
-                 << String::repeatChar(' ', max_len - anim_count.length())
-                 << anim_count
-                 << " animation names\n"
-                 << String::repeatChar('-', max_len + 18U) << "\n"
-                 << endl;
-        }
+    m_stylesheets.pop();
+}
+
+void
+CssModifier::
+beginStyleSheet(const CssBlockPtr &stylesheet)
+{
+    m_stylesheets.push(stylesheet);
+    pushContext(STYLESHEET);
+    m_block_stack.emplace(stylesheet);
+}
+
+void
+CssModifier::
+modifyStyleSheetElements(const CssBlockPtr &elements)
+{
+    m_block_stack.emplace(elements);
+    visitElements(elements);
+    m_block_stack.pop();
+
+    for (const auto &element : elements->elements())
+        m_stylesheets.top()->appendElement(element);
+}
+
+void
+CssModifier::
+endStyleSheet()
+{
+    m_block_stack.pop();
+    finishStyleSheet(m_stylesheets.top());
+    popContextIf(STYLESHEET);
+}
+
+bool
+CssModifier::
+needsWholeStyleSheet() const
+{
+    // Replacement names are generated from the number of occurrences,
+    // media and qualified rules are merged, supports rules are evaluated,
+    // custom properties are inlined, unused definitions and prefixed
+    // keyframes are removed across the stylesheet and the UTF8 BOM is
+    // prepended to the stylesheet after it has been visited
+    return s_use_utf8_bom ||
+           (!s_output_to_stdo &&
+            (s_minify_ids || s_minify_class_names || s_minify_custom_properties || s_minify_animation_names)) ||
+           cfg.isEnabled(Config::CSS__MERGE_MEDIA_RULES) ||
+           cfg.isEnabled(Config::CSS__MERGE_RULES) ||
+           cfg.isEnabled(Config::CSS__REMOVE_UNUSED_DEFINITIONS) ||
+           cfg.isEnabled(Config::CSS__INLINE_CUSTOM_PROPERTIES) ||
+           cfg.isEnabled(Config::CSS__REMOVE_VENDOR_PREFIXES) ||
+           cfg.isEnabled(Config::CSS__EVALUATE_SUPPORTS);
+}
+
+void
+CssModifier::
+visitElements(const CssBlockPtr &block)
+{
+    auto &elements = block->elements();
+    DataContainer<uint64_t> removed_elements;
+
+    // Elements, which mark themselves for removal while being visited
+    // (e.g. empty rules), are removed together after the loop, instead
+    // of erasing each of them separately
+    for (uint64_t i = 0; i < elements.size(); ++i) {
+        const auto element = elements.at(i);
+
+        m_remove_visited_element = false;
+        element->accept(*this);
+
+        if (m_remove_visited_element)
+            removed_elements.emplace_back(i);
+    }
 
-        if (m_stylesheets.size() == 1) {
-            m_restructuring.setStyleSheet(m_stylesheets.top());
-            m_restructuring.restructure();
+    m_remove_visited_element = false;
+
+    if (removed_elements.empty())
+        return;
+
+    uint64_t kept_elements = 0;
+
+    for (uint64_t i = 0, removed = 0; i < elements.size(); ++i) {
+        if (removed < removed_elements.size() && removed_elements.at(removed) == i) {
+            ++removed;
+            continue;
         }
 
-        m_stylesheets.pop();
+        if (kept_elements != i)
+            elements.at(kept_elements) = move(elements.at(i));
+
+        ++kept_elements;
     }
 
-    popContextIf({STYLESHEET, CURLY_BLOCK, PAREN_BLOCK, SQUARE_BLOCK, DEFAULT_BLOCK});
+    elements.resize(kept_elements);
+}
+
+void
+CssModifier::
+visitStyleSheetElements(const CssBlockPtr &stylesheet)
+{
+    // Stylesheets with fewer top-level elements are always modified on a single thread
+    constexpr uint64_t MIN_RANGE_SIZE = 256;
+
+    auto &elements = stylesheet->elements();
+    const auto thread_count = Parallel::threadCount();
+    const auto range_count = min<uint64_t>(thread_count * 4, elements.size() / MIN_RANGE_SIZE);
+
+    // @import and @charset rules read files and may ask the user,
+    // so they are only handled on this thread at the beginning of the stylesheet
+    const auto isSequentialRule = [&](const CssBaseElementPtr &element) -> bool {
+        return element->isAtRule() &&
+            (m_vendor.maybePrefixedKeyword(static_pointer_cast<CssAtRule>(element)->keyword(), "import") ||
+             m_vendor.maybePrefixedKeyword(static_pointer_cast<CssAtRule>(element)->keyword(), "charset"));
+    };
+
+    auto head_end = elements.begin();
+    while (head_end != elements.end() && (isSequentialRule(*head_end) || (*head_end)->isComment())) ++head_end;
+
+    if (thread_count < 2 || range_count < 2 || any_of(head_end, elements.end(), isSequentialRule)) {
+        visitElements(stylesheet);
+        return;
+    }
+
+    DataContainer<CssBaseElementPtr> tail(head_end, elements.end());
+    elements.erase(head_end, elements.end());
+
+    visitElements(stylesheet);
+
+    // Split the remaining elements into ranges, each of them is visited by
+    // a modifier of its own. Identifiers are counted in separate lists and
+    // merged afterwards in document order.
+    struct Range
+    {
+        CssBlockPtr block = make_shared<CssBlock>(CssBlock::STYLESHEET);
+        shared_ptr<CssModifier> modifier = shared_ptr<CssModifier>(new CssModifier(RangeModifier()));
+
+        shared_ptr<HashTable<string, IdentInfo<shared_ptr<string> > > >
+        ids = make_shared<HashTable<string, IdentInfo<shared_ptr<string> > > >(),
+        classes = make_shared<HashTable<string, IdentInfo<shared_ptr<string> > > >();
+
+        shared_ptr<HashTable<string, IdentInfo<CssIdentifierPtr> > >
+        cprops = make_shared<HashTable<string, IdentInfo<CssIdentifierPtr> > >(),
+        anims = make_shared<HashTable<string, IdentInfo<CssIdentifierPtr> > >();
+    };
+
+    DataContainer<Range> ranges;
+    ranges.resize(range_count);
+
+    for (uint64_t i = 0; i < range_count; ++i) {
+        const auto begin = tail.begin() + int64_t(tail.size() * i / range_count);
+        const auto end = tail.begin() + int64_t(tail.size() * (i + 1) / range_count);
+
+        ranges.at(i).block->setElements(DataContainer<CssBaseElementPtr>(begin, end));
+    }
+
+    Parallel::forEach(range_count, [&](const uint64_t index) {
+        auto &range = ranges.at(index);
+
+        swap(g_id_replacement_list, range.ids);
+        swap(g_class_replacement_list, range.classes);
+        swap(g_cprop_replacement_list, range.cprops);
+        swap(g_anim_replacement_list, range.anims);
+
+        range.modifier->pushContext(STYLESHEET);
+        range.modifier->m_block_stack.emplace(range.block);
+        range.modifier->visitElements(range.block);
+
+        swap(g_id_replacement_list, range.ids);
+        swap(g_class_replacement_list, range.classes);
+        swap(g_cprop_replacement_list, range.cprops);
+        swap(g_anim_replacement_list, range.anims);
+    });
+
+    for (const auto &range : ranges) {
+        mergeIdentInfos(*g_id_replacement_list, *range.ids);
+        mergeIdentInfos(*g_class_replacement_list, *range.classes);
+        mergeIdentInfos(*g_cprop_replacement_list, *range.cprops);
+        mergeIdentInfos(*g_anim_replacement_list, *range.anims);
+
+        for (const auto &at_rule_media : range.modifier->m_restructuring.mediaRules())
+            m_restructuring.appendAtRuleMedia(at_rule_media);
+
+        elements.insert(elements.end(), range.block->elements().begin(), range.block->elements().end());
+    }
 }
 
 void
@@ -275,6 +564,12 @@ visit(const CssDeclarationPtr &declaration)
     if (declaration->name({"z-index"}))
         return;
 
+    // Rewrite the values before they are visited, so that their replacements are minified as well
+    if (s_rewrite_values) {
+        CssPassManager::PassScope pass(CssPassManager::REWRITE_VALUES, declaration);
+        rewriteValues(declaration);
+    }
+
     for (const auto &list : declaration->values())
         for (const auto &value : list)
             value->accept(*this);
@@ -289,6 +584,7 @@ visit(const CssDeclarationPtr &declaration)
                 found->second.defined = true;
             } else {
                 auto ident_info = IdentInfo<CssIdentifierPtr>(declaration->namePtr(), true);
+                ident_info.index = g_cprop_replacement_list->size();
                 g_cprop_replacement_list->emplace(declaration->name(), ident_info);
             }
         }
@@ -304,51 +600,16 @@ visit(const CssDeclarationPtr &declaration)
                 ++found->second.count;
             } else {
                 auto ident_info = IdentInfo<CssIdentifierPtr>(identifier, false);
+                ident_info.index = g_anim_replacement_list->size();
                 g_anim_replacement_list->emplace(identifier->value(), ident_info);
             }
         }
     }
 
     // Rewrite shorthands
-    if (declaration->name({"margin", "padding", "border-width", "border-radius"})) {
-        if (declaration->values().size() == 1) {
-            auto &values = declaration->values().front();
-
-            switch (values.size()) {
-            case 2:
-                // Example: margin: 10px 10px => margin: 10px
-                if (values[0] == values[1])
-                    values.pop_back();
-
-                break;
-            case 3:
-                if (values[0] == values[2]) {
-                    if (values[0] == values[1])
-                        // Example: margin: 10px 10px 10px => margin: 10px
-                        while (&values.front() != &values.back())
-                            values.pop_back();
-                    else
-                        // Example: margin: 10px 20px 10px => margin: 10px 20px
-                        values.pop_back();
-                }
-
-                break;
-            case 4:
-                if (values[0] == values[2] &&
-                    values[1] == values[3]) {
-                    // Example: margin: 10px 10px 10px 10px => margin: 10px
-                    if (values[0] == values[3])
-                        while (&values.front() != &values.back())
-                            values.pop_back();
-                    else
-                        // Example: margin: 10px 20px 10px 20px => margin: 10px 20px
-                        while (&values.at(1) != &values.back())
-                            values.pop_back();
-                }
-
-                break;
-            }
-        }
+    if (s_rewrite_shorthands) {
+        CssPassManager::PassScope pass(CssPassManager::REWRITE_SHORTHANDS, declaration);
+        shortenShorthand(declaration);
     }
 
     m_declaration = nullptr;
@@ -361,6 +622,7 @@ visit(const CssNumberPtr &number)
     // Try to minify numbers, if this is enabled in the config file or by default
     if (s_minify_numbers) {
         // https://drafts.csswg.org/css-values-3/#numbers
+        CssPassManager::PassScope pass(CssPassManager::MINIFY_NUMBERS, number);
 
         number->setNumber(getShortNumber(number->value()));
         replaceNumberWithScientificNotation(number);
@@ -385,7 +647,8 @@ visit(const CssDimensionPtr &dimension)
 
     visit(static_pointer_cast<CssNumber>(dimension));
 
-    if (m_declaration) {
+    if (m_declaration && s_minify_dimensions) {
+        CssPassManager::PassScope pass(CssPassManager::MINIFY_DIMENSIONS, dimension);
 
         // https://www.w3.org/TR/css-values-3/#lengths
 
@@ -428,14 +691,40 @@ visit(const CssFunctionPtr &function)
     // This is important for unquoted URLs
     if (function->name("url")) pushContext(FUNCTION_URL);
 
+    if (s_simplify_math_functions && function->name({"calc", "min", "max", "clamp"})) {
+        CssPassManager::PassScope pass(CssPassManager::SIMPLIFY_MATH_FUNCTIONS, function);
+        simplifyMathFunction(function);
+        pass.stop();
+
+        if (function->replacementElement()) {
+            function->replacementElement()->accept(*this);
+            return;
+        }
+    }
+
     for (const auto &list : function->parameters())
         for (const auto &element : list)
             element->accept(*this);
 
+    // Rewrite the angle of the gradient line. Example: linear-gradient(.5turn, ...) => linear-gradient(180deg, ...)
+    if (s_rewrite_angles && function->name({"linear-gradient", "repeating-linear-gradient"}) &&
+        !function->parameters().empty() && function->parameters().front().size() == 1 &&
+        function->parameters().front().front()->isDimension()) {
+        const auto dimension = static_pointer_cast<CssDimension>(function->parameters().front().front());
+
+        if (dimension->unit({"deg", "grad", "rad", "turn"})) {
+            CssPassManager::PassScope pass(CssPassManager::REWRITE_ANGLES, dimension);
+            minifyAngle(dimension);
+        }
+    }
+
     if (s_rewrite_functions) {
         // Rewrite hsl()/hsla() functions to rgb()/rgba() functions
         if (function->name({"hsl", "hsla"})) {
+            CssPassManager::PassScope pass(CssPassManager::REWRITE_FUNCTIONS, function);
             maybeManipulateHslaFunction(function);
+            pass.stop();
+
             if (function->replacementElement()) {
                 function->replacementElement()->accept(*this);
                 return;
@@ -443,13 +732,17 @@ visit(const CssFunctionPtr &function)
         }
         // Rewrite rgb()/rgba() functions to rgb/rgba hex color notation
         else if (function->name({"rgb", "rgba"})) {
+            CssPassManager::PassScope pass(CssPassManager::REWRITE_FUNCTIONS, function);
             replaceRgbaFuncWithRgbaHexColor(function);
+            pass.stop();
+
             if (function->replacementElement()) {
                 function->replacementElement()->accept(*this);
                 return;
             }
         }
         else if (function->name("linear-gradient")) {
+            CssPassManager::PassScope pass(CssPassManager::REWRITE_FUNCTIONS, function);
             maybeRewriteLinearGradientFunction(function);
         }
     }
@@ -480,6 +773,7 @@ visit(const CssCustomPropertyPtr &custom_property)
             ++found->second.count;
         } else {
             auto ident_info = IdentInfo<CssIdentifierPtr>(custom_property);
+            ident_info.index = g_cprop_replacement_list->size();
             g_cprop_replacement_list->emplace(custom_property->value(), ident_info);
         }
     }
@@ -491,6 +785,8 @@ visit(const CssColorPtr &color)
 {
     // Try to minify colors, if this is enabled in the config file or by default
     if (s_minify_colors) {
+        CssPassManager::PassScope pass(CssPassManager::MINIFY_COLORS, color);
+
         if (color->colorType() == CssColor::PREDEFINED_NAME) {
             if (s_use_rgba_hex_color_notation && color->value() == "transparent") {
                 color->setColorType(CssColor::HEX_LITERAL);
@@ -538,11 +834,30 @@ CssModifier::
 visit(const CssQualifiedRulePtr &qualified_rule)
 {
     if (qualified_rule->block()) {
-        if (!qualified_rule->block()->elements().empty())
+        if (s_remove_vendor_prefixes) {
+            CssPassManager::PassScope pass(CssPassManager::REMOVE_VENDOR_PREFIXES, qualified_rule);
+            removeVendorPrefixes(qualified_rule->block());
+        }
+
+        if (!qualified_rule->block()->elements().empty()) {
             qualified_rule->block()->accept(*this);
+
+            if (s_remove_overridden_declarations) {
+                CssPassManager::PassScope pass(CssPassManager::REMOVE_OVERRIDDEN_DECLARATIONS, qualified_rule);
+                removeOverriddenDeclarations(qualified_rule->block());
+            }
+
+            if (s_merge_longhands) {
+                CssPassManager::PassScope pass(CssPassManager::MERGE_LONGHANDS, qualified_rule);
+                mergeLonghands(qualified_rule->block());
+            }
+        }
         // Remove empty rules, if this is enabled in the config file or by default
         else if (s_remove_empty_rules) {
-            m_block_stack.top()->removeElement(qualified_rule);
+            if (CssPassManager::isCountingBytes())
+                CssPassManager::addSavedBytes(CssPassManager::REMOVE_EMPTY_RULES, int64_t(CssSizeReport::generatedSize(qualified_rule)));
+
+            removeVisitedElement();
             return;
         }
     }
@@ -557,7 +872,8 @@ CssModifier::
 visit(const CssStringPtr &string_ptr)
 {
     // If the string is a param of the url() function, unquote the string.
-    if (context(FUNCTION_URL)) {
+    if (s_unquote_urls && context(FUNCTION_URL)) {
+        CssPassManager::PassScope pass(CssPassManager::UNQUOTE_URLS, string_ptr);
         string_ptr->setUnquotedFlag();
 
         for (const auto &c : string_ptr->value()) {
@@ -595,7 +911,9 @@ CssModifier::
 visit(const CssSelectorPtr &selector)
 {
     // If current selector is a keyframes selector
-    if (hasContext(KEYFRAMES_BLOCK)) {
+    if (s_rewrite_selectors && hasContext(KEYFRAMES_BLOCK)) {
+        CssPassManager::PassScope pass(CssPassManager::REWRITE_SELECTORS, selector);
+
         // Replace "from" with "0%"
         if (selector->name() == "from")
             selector->setName("0%");
@@ -613,6 +931,7 @@ visit(const CssSelectorPtr &selector)
             ++found->second.count;
         } else {
             auto ident_info = IdentInfo<shared_ptr<string> >(selector->namePtr());
+            ident_info.index = g_id_replacement_list->size();
             g_id_replacement_list->emplace(selector->name(), ident_info);
         }
 
@@ -626,6 +945,7 @@ visit(const CssSelectorPtr &selector)
             ++found->second.count;
         } else {
             auto ident_info = IdentInfo<shared_ptr<string> >(selector->namePtr());
+            ident_info.index = g_class_replacement_list->size();
             g_class_replacement_list->emplace(selector->name(), ident_info);
         }
 
@@ -634,7 +954,9 @@ visit(const CssSelectorPtr &selector)
     default:;
     }
 
-    if (selector->selectorType() == CssSelector::AN_PLUS_B) {
+    if (s_rewrite_selectors && selector->selectorType() == CssSelector::AN_PLUS_B) {
+        CssPassManager::PassScope pass(CssPassManager::REWRITE_SELECTORS, selector);
+
         if (selector->name() == "even")
             selector->setName("2n");
         else if (selector->name() == "2n+1")
@@ -806,14 +1128,18 @@ generateIds()
         sort(vect.rbegin(), vect.rend(), sorting_condition);
 
         // Generate replacement IDs for all the entries in the container
-        for (const auto &pair : vect)
+        for (const auto &pair : vect) {
             *pair.identifier = getShortId(m_id_replacement_name);
+            renameAliases(pair);
+        }
 
         return;
     }
 
-    for (const auto &pair : *g_id_replacement_list)
+    for (const auto &pair : *g_id_replacement_list) {
         *pair.second.identifier = getShortId(m_id_replacement_name);
+        renameAliases(pair.second);
+    }
 }
 
 void
@@ -837,14 +1163,18 @@ generateClassNames()
         sort(vect.rbegin(), vect.rend(), sorting_condition);
 
         // Generate replacement IDs for all the entries in the container
-        for (const auto &pair : vect)
+        for (const auto &pair : vect) {
             *pair.identifier = getShortId(m_class_replacement_name);
+            renameAliases(pair);
+        }
 
         return;
     }
 
-    for (const auto &pair : *g_class_replacement_list)
+    for (const auto &pair : *g_class_replacement_list) {
         *pair.second.identifier = getShortId(m_class_replacement_name);
+        renameAliases(pair.second);
+    }
 }
 
 void
@@ -879,6 +1209,7 @@ generateCustomPropertyNames()
                 tmp_name = pair.identifier->value();
 
             pair.identifier->setValue(getShortId(m_cprop_replacement_name));
+            renameAliases(pair);
 
             if (!pair.defined) {
                 writeUndeclaredCPropMsg(tmp_name, pair.identifier->value());
@@ -891,6 +1222,7 @@ generateCustomPropertyNames()
 
     for (const auto &pair : *g_cprop_replacement_list) {
         pair.second.identifier->setValue(getShortId(m_cprop_replacement_name));
+        renameAliases(pair.second);
 
         if (!pair.second.defined)
             writeUndeclaredCPropMsg(pair.first, pair.second.identifier->value());
@@ -929,6 +1261,7 @@ generateAnimationNames()
                 tmp_name = pair.identifier->value();
 
             pair.identifier->setValue(getShortId(m_animation_replacement_name));
+            renameAliases(pair);
 
             if (!pair.defined) {
                 writeUndeclaredAnimNameMsg(tmp_name, pair.identifier->value());
@@ -941,6 +1274,7 @@ generateAnimationNames()
 
     for (const auto &pair : *g_anim_replacement_list) {
         pair.second.identifier->setValue(getShortId(m_animation_replacement_name));
+        renameAliases(pair.second);
 
         if (!pair.second.defined)
             writeUndeclaredAnimNameMsg(pair.first, pair.second.identifier->value());
@@ -1399,12 +1733,25 @@ maybeImportStyleSheet(const CssAtRulePtr &at_rule_import)
         if (!s_output_to_stdo)
             Console::writeLine("Processing import file '" + base_name + "'", indentation);
 
+        Statistics::beginFile(absolute_input_path);
+        Statistics::PhaseTimer modify_timer(Statistics::MODIFY);
+
         string file_content;
+        Statistics::PhaseTimer read_timer(Statistics::READ);
         FileSystemWorker::readFile(absolute_input_path, file_content);
+        read_timer.stop();
+
+        Statistics::addBytesIn(file_content.length());
         FileSystemWorker::addInputFile(absolute_input_path);
 
         const auto &ast = CssParser::parse(file_content);
 
+        if (CssSizeReport::isEnabled())
+            CssSizeReport::setImportedFile(ast, absolute_input_path);
+
+        if (CssSelectorReport::isEnabled())
+            CssSelectorReport::setImportedFile(ast, absolute_input_path);
+
         if ((!at_rule_import->expressions()->empty() && at_rule_import->expressions()->at(0)->size() > 1) ||
              at_rule_import->expressions()->size() > 1) {
 
@@ -1440,6 +1787,8 @@ maybeImportStyleSheet(const CssAtRulePtr &at_rule_import)
             if (!s_output_to_stdo)
                 Console::writeLine("[Done] Processing import file '" + base_name + "'", indentation);
 
+            modify_timer.stop();
+            Statistics::endFile();
             return;
         }
 
@@ -1447,7 +1796,16 @@ maybeImportStyleSheet(const CssAtRulePtr &at_rule_import)
 
         file_content.clear();
         CssGenerator css_generator(file_content);
+
+        Statistics::PhaseTimer generate_timer(Statistics::GENERATE);
         ast->accept(css_generator);
+        generate_timer.stop();
+
+        if (CssSizeReport::isEnabled())
+            CssSizeReport::addStyleSheet(ast, absolute_input_path, file_content.length());
+
+        if (CssSelectorReport::isEnabled())
+            CssSelectorReport::addStyleSheet(ast, absolute_input_path);
 
         string absolute_output_path, relative_path;
 
@@ -1474,12 +1832,19 @@ maybeImportStyleSheet(const CssAtRulePtr &at_rule_import)
 
         FileSystemWorker::createPath(FileSystem::getParentPath(absolute_output_path));
 
+        Statistics::PhaseTimer write_timer(Statistics::WRITE);
         FileSystemWorker::writeFile(absolute_output_path, file_content);
+        write_timer.stop();
+
+        Statistics::addBytesOut(file_content.length());
 
         Console::writeLine("[Done] Processing import file '" + base_name + "'", indentation);
         Console::writeFileSizeDifference(FileSystem::getFileSize(absolute_input_path),
                                          FileSystem::getFileSize(absolute_output_path),
                                          indentation);
+
+        modify_timer.stop();
+        Statistics::endFile();
     }
 
     --s_import_depth;
@@ -1679,3 +2044,1144 @@ minifyAngle(const CssDimensionPtr &dimension)
     // If no case applies, signal that no changes have been made by returning false
     return false;
 }
+
+/// Text of an element, as it's written to the output
+static string generatedText(const CssBaseElementPtr &element)
+{
+    string generated;
+    CSS::Generation::CssGenerator css_generator(generated);
+    element->accept(css_generator);
+
+    return generated;
+}
+
+static const CssShorthandInfo *findShorthand(const string &name)
+{
+    for (const auto &shorthand : s_css_shorthand_table)
+        if (name == shorthand.name)
+            return &shorthand;
+
+    return nullptr;
+}
+
+/// Returns true, if the longhand is set by the shorthand
+static bool isLonghandOf(const CssShorthandInfo &shorthand, const string &longhand)
+{
+    for (const auto &name : shorthand.longhands)
+        if (name && longhand == name)
+            return true;
+
+    return false;
+}
+
+/// Returns true, if the value may stand for something else than a single
+/// component value: CSS-wide keywords and substitution functions
+static bool isSubstitutedValue(const CssBaseElementPtr &value)
+{
+    if (value->isIdentifier()) {
+        const auto keyword = String::toLower(static_pointer_cast<CssIdentifier>(value)->value());
+
+        return keyword == "inherit" || keyword == "initial" || keyword == "unset" ||
+               keyword == "revert" || keyword == "revert-layer";
+    }
+
+    if (value->isFunction()) {
+        const auto function = static_pointer_cast<CssFunction>(value);
+
+        if (function->name({"var", "env", "attr"}))
+            return true;
+
+        for (const auto &list : function->parameters())
+            for (const auto &argument : list)
+                if (isSubstitutedValue(argument))
+                    return true;
+    }
+
+    return false;
+}
+
+/// Returns true, if the declaration may set a property, which the
+/// shorthand sets as well, without being one of its longhands
+static bool overlapsShorthand(const CssShorthandInfo &shorthand, const string &property)
+{
+    if (isLonghandOf(shorthand, property) ||
+        cssPropertyFamily(property) != cssPropertyFamily(shorthand.name))
+        return false;
+
+    // Another shorthand of the table overlaps, if it shares a longhand
+    const auto other_shorthand = findShorthand(property);
+
+    if (other_shorthand) {
+        if (!other_shorthand->longhands[0])
+            return true;
+
+        for (const auto &longhand : other_shorthand->longhands)
+            if (longhand && isLonghandOf(shorthand, longhand))
+                return true;
+
+        return false;
+    }
+
+    // Longhands of the table set nothing else
+    for (const auto &other : s_css_shorthand_table)
+        if (isLonghandOf(other, property))
+            return false;
+
+    return true;
+}
+
+/// Value rewrite table, compiled to look rules up by the property or by the
+/// function name first and by the text of the value then
+struct CssValueRewrites
+{
+    HashTable<string, HashTable<string, const char *> >
+    by_property,
+    by_function;
+};
+
+static const CssValueRewrites &valueRewrites()
+{
+    static const CssValueRewrites rewrites = [] {
+        CssValueRewrites compiled;
+
+        for (const auto &rule : s_css_value_rewrite_table) {
+            if (!rule.properties[0]) {
+                const string pattern = rule.pattern;
+                compiled.by_function[pattern.substr(0, pattern.find('('))][pattern] = rule.replacement;
+            }
+
+            for (const auto &property : rule.properties) {
+                if (!property) break;
+
+                compiled.by_property[property][rule.pattern] = rule.replacement;
+            }
+        }
+
+        return compiled;
+    }();
+
+    return rewrites;
+}
+
+/// Text of a value, as the patterns of the value rewrite table are written
+static string ruleText(const CssBaseElementPtr &element)
+{
+    if (element->replacementElement()) return ruleText(element->replacementElement());
+
+    if (element->isNumber() || element->isPercentage() || element->isDimension()) {
+        const auto &number = static_pointer_cast<CssNumber>(element);
+        string text = CssModifier::getShortNumber(number->value()) + number->scientificPostfix();
+
+        if (number->isNegative()) text.insert(0, 1, '-');
+
+        if (element->isPercentage()) {
+            text += '%';
+        } else if (element->isDimension()) {
+            const auto &dimension = static_pointer_cast<CssDimension>(element);
+
+            if (text != "0" || !dimension->unit({"px", "em", "rem", "pt", "vw", "vh", "ex", "ch",
+                                                 "vmin", "vmax", "cm", "mm", "Q", "in", "pc"}))
+                text += String::toLower(dimension->unit());
+        }
+
+        return text;
+    }
+
+    if (element->isIdentifier())
+        return String::toLower(static_pointer_cast<CssIdentifier>(element)->value());
+
+    if (element->isFunction()) {
+        auto &parameters = static_pointer_cast<CssFunction>(element)->parameters();
+        string text = String::toLower(static_pointer_cast<CssFunction>(element)->name()) + '(';
+
+        for (const auto &parameter : parameters) {
+            if (&parameter != &parameters.front()) text += ',';
+
+            for (const auto &value : parameter) {
+                if (&value != &parameter.front()) text += ' ';
+                text += ruleText(value);
+            }
+        }
+
+        return text + ')';
+    }
+
+    return generatedText(element);
+}
+
+/// Creates a value of a replacement of the value rewrite table
+static CssBaseElementPtr createRuleValue(const string &text)
+{
+    const auto parenthesis = text.find('(');
+
+    if (parenthesis != string::npos) {
+        const auto function = make_shared<CssFunction>(text.substr(0, parenthesis));
+
+        for (const auto &argument : String::split(text.substr(parenthesis + 1, text.length() - parenthesis - 2), ',')) {
+            DataContainer<CssBaseElementPtr> values;
+
+            for (const auto &value : String::splitByWhiteSpace(argument))
+                values.emplace_back(createRuleValue(value));
+
+            function->appendParameter(values);
+        }
+
+        return function;
+    }
+
+    const auto unit = text.find_first_not_of("0123456789.");
+
+    if (unit == 0) return make_shared<CssIdentifier>(text);
+    if (unit == string::npos) return make_shared<CssNumber>(text);
+    if (text[unit] == '%') return make_shared<CssPercentage>(text.substr(0, unit));
+
+    return make_shared<CssDimension>(text.substr(0, unit), text.substr(unit));
+}
+
+/*static*/ void
+CssModifier::
+rewriteValues(const CssDeclarationPtr &declaration)
+{
+    if (!declaration->importantHack().empty() || declaration->namePtr()->isCustomProperty())
+        return;
+
+    const auto &rewrites = valueRewrites();
+    const auto property_rules = rewrites.by_property.find(String::toLower(declaration->name()));
+
+    for (auto &list : declaration->values()) {
+        // Functions are rewritten in the values of every property
+        for (auto &value : list) {
+            if (!value->isFunction()) continue;
+
+            const auto function_rules = rewrites.by_function.find(
+                        String::toLower(static_pointer_cast<CssFunction>(value)->name()));
+
+            if (function_rules == rewrites.by_function.end()) continue;
+
+            const auto rule = function_rules->second.find(ruleText(value));
+
+            if (rule != function_rules->second.end())
+                value = createRuleValue(rule->second);
+        }
+
+        if (property_rules == rewrites.by_property.end() || list.empty()) continue;
+
+        const auto first_value = ruleText(list.front());
+        string text = first_value;
+
+        for (auto itr = list.begin() + 1; itr != list.end(); ++itr) {
+            text += ' ';
+            text += ruleText(*itr);
+        }
+
+        auto rule = property_rules->second.find(text);
+
+        // Patterns, which start with any value. Example: 10px center => 10px
+        // A substitution function may stand for several values, so that the
+        // rest of the list doesn't mean the same without it.
+        // Example: var(--x) center
+        if (rule == property_rules->second.end() && !isSubstitutedValue(list.front()))
+            rule = property_rules->second.find('*' + text.substr(first_value.length()));
+
+        if (rule == property_rules->second.end()) continue;
+
+        DataContainer<CssBaseElementPtr> values;
+
+        for (const auto &value : String::splitByWhiteSpace(rule->second))
+            values.emplace_back(value == "*" ? list.front() : createRuleValue(value));
+
+        list = values;
+    }
+}
+
+/*static*/ void
+CssModifier::
+shortenShorthand(const CssDeclarationPtr &declaration)
+{
+    const auto shorthand = findShorthand(String::toLower(declaration->name()));
+
+    if (!shorthand || shorthand->syntax == CssShorthandInfo::SEQUENCE || declaration->values().size() != 1)
+        return;
+
+    auto &values = declaration->values().front();
+    DataContainer<string> texts;
+
+    for (const auto &value : values) {
+        // Example: border-radius: 10px 10px / 5px
+        if (value->isDelimiter()) return;
+
+        texts.emplace_back(generatedText(value));
+    }
+
+    if (shorthand->syntax == CssShorthandInfo::PAIR) {
+        // Example: gap: 10px 10px => gap: 10px
+        if (values.size() == 2 && texts[0] == texts[1])
+            values.pop_back();
+
+        return;
+    }
+
+    // Example: margin: 10px 20px 30px 20px => margin: 10px 20px 30px
+    if (values.size() == 4 && texts[1] == texts[3])
+        values.pop_back();
+
+    // Example: margin: 10px 20px 10px => margin: 10px 20px
+    if (values.size() == 3 && texts[0] == texts[2])
+        values.pop_back();
+
+    // Example: margin: 10px 10px => margin: 10px
+    if (values.size() == 2 && texts[0] == texts[1])
+        values.pop_back();
+}
+
+/*static*/ void
+CssModifier::
+mergeLonghands(const CssBlockPtr &block)
+{
+    auto &elements = block->elements();
+    HashTable<const CssBaseElement *, bool> merged_longhands;
+
+    // Declarations by their lower case property name. Properties, which
+    // are declared more than once, e.g. as fallbacks, aren't merged.
+    HashTable<string, CssDeclarationPtr> declarations;
+
+    for (const auto &element : elements) {
+        if (!element->isDeclaration()) continue;
+
+        const auto declaration = static_pointer_cast<CssDeclaration>(element);
+
+        // Custom properties are stored without their leading dashes
+        if (declaration->namePtr()->isCustomProperty()) continue;
+
+        const auto inserted = declarations.emplace(String::toLower(declaration->name()), declaration);
+
+        if (!inserted.second)
+            inserted.first->second = nullptr;
+    }
+
+    if (declarations.size() < 2) return;
+
+    for (const auto &shorthand : s_css_shorthand_table) {
+        DataContainer<CssDeclarationPtr> longhands;
+        bool complete = shorthand.longhands[0] != nullptr;
+
+        for (const auto &name : shorthand.longhands) {
+            if (!name || !complete) break;
+
+            const auto found = declarations.find(name);
+            complete = found != declarations.end() && found->second;
+
+            if (complete)
+                longhands.emplace_back(found->second);
+        }
+
+        if (!complete) continue;
+
+        const auto &first = longhands.front();
+
+        // The longhands have to share their importance and have single values,
+        // which are known while parsing
+        for (const auto &longhand : longhands)
+            complete = complete &&
+                longhand->isImportant() == first->isImportant() &&
+                longhand->importantHack() == first->importantHack() &&
+                longhand->values().size() == 1 &&
+                longhand->values().front().size() == 1 &&
+                !isSubstitutedValue(longhand->values().front().front());
+
+        // Other declarations could override the shorthand partially or be overridden by it
+        for (const auto &declaration : declarations)
+            complete = complete && !overlapsShorthand(shorthand, declaration.first);
+
+        if (!complete) continue;
+
+        const auto merged = make_shared<CssDeclaration>(string(shorthand.name));
+
+        for (const auto &longhand : longhands) {
+            merged->appendValue(longhand->values().front().front());
+            merged_longhands.appendElement(&*longhand, true);
+            declarations.erase(String::toLower(longhand->name()));
+        }
+
+        if (first->isImportant())
+            merged->setImportantFlag();
+        else if (!first->importantHack().empty())
+            merged->setImportantHack(first->importantHack());
+
+        shortenShorthand(merged);
+
+        // The shorthand takes the place of the first longhand
+        *find(elements.begin(), elements.end(), CssBaseElementPtr(first)) = merged;
+        declarations.emplace(shorthand.name, merged);
+    }
+
+    if (!merged_longhands.empty())
+        elements.removeElements([&merged_longhands](const CssBaseElementPtr &element) -> bool {
+            return merged_longhands.find(&*element) != merged_longhands.end();
+        });
+}
+
+static bool containsName(const initializer_list<const char *> &names, const string &name)
+{
+    for (const auto &candidate : names)
+        if (name == candidate)
+            return true;
+
+    return false;
+}
+
+/// Collects the features of the values, which some browsers may not
+/// understand. Values of CSS 2.1 are understood by every browser and
+/// aren't collected.
+static void collectValueFeatures(const DataContainer<CssBaseElementPtr> &values, DataContainer<string> &features)
+{
+    for (const auto &value : values) {
+        if (value->isDimension()) {
+            const auto unit = String::toLower(static_pointer_cast<CssDimension>(value)->unit());
+
+            if (!containsName(s_css_basic_units, unit))
+                features.emplace_back("u:" + unit);
+        }
+        else if (value->isOfType({CssBaseElement::NUMBER, CssBaseElement::PERCENTAGE,
+                                  CssBaseElement::STRING, CssBaseElement::DELIMITER}))
+            continue;
+        else if (value->isColor()) {
+            const auto color = static_pointer_cast<CssColor>(value);
+
+            // Hex colors with alpha channel and rebeccapurple are of CSS Color 4
+            if (color->colorType() == CssColor::HEX_LITERAL) {
+                if (color->value().size() != 3 && color->value().size() != 6)
+                    features.emplace_back("c:#" + to_string(color->value().size()));
+            }
+            else if (String::toLower(color->value()) == "rebeccapurple")
+                features.emplace_back("c:rebeccapurple");
+        }
+        else if (value->isIdentifier()) {
+            const auto keyword = String::toLower(static_pointer_cast<CssIdentifier>(value)->value());
+
+            if (!containsName(s_css_basic_keywords, keyword))
+                features.emplace_back("i:" + keyword);
+        }
+        else if (value->isFunction()) {
+            const auto function = static_pointer_cast<CssFunction>(value);
+            const auto name = String::toLower(function->name());
+
+            if (name != "url")
+                features.emplace_back("f:" + name);
+
+            for (const auto &parameter : function->parameters())
+                collectValueFeatures(parameter, features);
+        }
+        else
+            features.emplace_back("e:" + generatedText(value));
+    }
+}
+
+/*static*/ void
+CssModifier::
+removeOverriddenDeclarations(const CssBlockPtr &block)
+{
+    // Later declarations, which set a property
+    struct Overriders
+    {
+        /// Set, if a later declaration uses CSS 2.1 values only
+        bool basic = false, basic_important = false;
+        /// Indexes of the features of the nearest later declarations
+        int64_t nearest = -1, nearest_important = -1;
+    };
+
+    auto &elements = block->elements();
+    HashTable<string, Overriders> overriders;
+    HashTable<const CssBaseElement *, bool> overridden_declarations;
+    DataContainer<DataContainer<string> > later_features;
+
+    // From the last declaration to the first one, so that the overriders of
+    // every property are known, when its declaration is reached
+    for (auto element = elements.rbegin(); element != elements.rend(); ++element) {
+        if (!(*element)->isDeclaration()) continue;
+
+        const auto declaration = static_pointer_cast<CssDeclaration>(*element);
+
+        // Hacks are meant for particular browsers, which may ignore the later declaration
+        if (!declaration->importantHack().empty()) continue;
+
+        // Custom properties are stored without their leading dashes and are case sensitive
+        const auto name = declaration->namePtr()->isCustomProperty() ?
+            "--" + declaration->name() : String::toLower(declaration->name());
+        const auto important = declaration->isImportant();
+
+        DataContainer<string> features;
+
+        for (const auto &values : declaration->values())
+            collectValueFeatures(values, features);
+
+        sort(features.begin(), features.end());
+        features.erase(unique(features.begin(), features.end()), features.end());
+
+        const auto found = overriders.find(name);
+
+        if (found != overriders.end()) {
+            // A normal declaration doesn't override an important one. The
+            // declaration is a fallback, unless every browser, which
+            // understands it, understands the later one as well.
+            const auto nearest = important ? found->second.nearest_important : found->second.nearest;
+            const auto overridden = (important ? found->second.basic_important : found->second.basic) ||
+                (nearest >= 0 && includes(features.begin(), features.end(),
+                                          later_features[nearest].begin(), later_features[nearest].end()));
+
+            if (overridden) {
+                overridden_declarations.appendElement(&*declaration, true);
+                continue;
+            }
+        }
+
+        const auto index = int64_t(later_features.size());
+        const auto basic = features.empty();
+        later_features.emplace_back(move(features));
+
+        const auto set_property = [&](const string &property) {
+            auto &later = overriders[property];
+
+            later.basic = later.basic || basic;
+
+            if (later.nearest < 0)
+                later.nearest = index;
+
+            if (important) {
+                later.basic_important = later.basic_important || basic;
+
+                if (later.nearest_important < 0)
+                    later.nearest_important = index;
+            }
+        };
+
+        set_property(name);
+
+        // Browsers supported 'column-gap' of multi-column layouts long before 'gap'
+        if (name != "gap")
+            forEachCssLonghand(name, set_property);
+    }
+
+    if (!overridden_declarations.empty())
+        elements.removeElements([&overridden_declarations](const CssBaseElementPtr &element) -> bool {
+            return overridden_declarations.find(&*element) != overridden_declarations.end();
+        });
+}
+
+/// Lowercase names of the functions and identifiers among the values, those
+/// of nested functions included
+static void collectValueNames(const DataContainer<CssBaseElementPtr> &values, DataContainer<string> &names)
+{
+    for (const auto &value : values) {
+        if (value->isFunction()) {
+            const auto &function = static_pointer_cast<CssFunction>(value);
+            names.emplace_back(String::toLower(function->name()));
+
+            for (const auto &parameter : function->parameters())
+                collectValueNames(parameter, names);
+        }
+        else if (value->isIdentifier())
+            names.emplace_back(String::toLower(static_pointer_cast<CssIdentifier>(value)->value()));
+    }
+}
+
+/// Returns true, if a later declaration of the block sets the property as
+/// well, at least as important, and with values containing all of the names
+static bool isFollowedBy(const DataContainer<CssBaseElementPtr> &elements, const uint64_t index,
+                         const string &property, const DataContainer<string> &names)
+{
+    const auto &declaration = static_pointer_cast<CssDeclaration>(elements[index]);
+
+    for (uint64_t i = index + 1; i < elements.size(); ++i) {
+        if (!elements[i]->isDeclaration()) continue;
+
+        const auto &later_declaration = static_pointer_cast<CssDeclaration>(elements[i]);
+
+        if (String::toLower(later_declaration->name()) != property || !later_declaration->importantHack().empty() ||
+            (declaration->isImportant() && !later_declaration->isImportant()))
+            continue;
+
+        DataContainer<string> later_names;
+
+        for (const auto &list : later_declaration->values())
+            collectValueNames(list, later_names);
+
+        if (all_of(names.begin(), names.end(), [&later_names](const string &name) -> bool {
+            return find(later_names.begin(), later_names.end(), name) != later_names.end();
+        }))
+            return true;
+    }
+
+    return false;
+}
+
+/// Removes the transitions of prefixed properties from a transition value,
+/// which no target browser needs. Example: transform .3s,-webkit-transform .3s => transform .3s
+static void removePrefixedTransitions(const CssDeclarationPtr &declaration)
+{
+    auto &values = declaration->values();
+    DataContainer<string> names;
+
+    for (const auto &list : values)
+        collectValueNames(list, names);
+
+    const auto isUnneeded = [&names](const DataContainer<CssBaseElementPtr> &list) -> bool {
+        for (const auto &value : list) {
+            if (!value->isIdentifier()) continue;
+
+            const auto property = String::toLower(static_pointer_cast<CssIdentifier>(value)->value());
+            const auto prefix = CSS::CssBrowserSupport::vendorPrefix(property);
+
+            if (prefix.empty()) continue;
+
+            const auto unprefixed_property = property.substr(prefix.length());
+
+            // Transitions of properties, which no target browser knows, are dropped as well
+            return !CSS::CssBrowserSupport::usesPrefix(prefix) ||
+                   (!CSS::CssBrowserSupport::needsPrefix(prefix, unprefixed_property) &&
+                    find(names.begin(), names.end(), unprefixed_property) != names.end());
+        }
+
+        return false;
+    };
+
+    // At least one transition is kept
+    if (!all_of(values.begin(), values.end(), isUnneeded))
+        values.removeElements(isUnneeded);
+}
+
+/*static*/ void
+CssModifier::
+removeVendorPrefixes(const CssBlockPtr &block)
+{
+    auto &elements = block->elements();
+    HashTable<const CssBaseElement *, bool> removed_declarations;
+
+    for (uint64_t i = 0; i < elements.size(); ++i) {
+        if (!elements[i]->isDeclaration()) continue;
+
+        const auto &declaration = static_pointer_cast<CssDeclaration>(elements[i]);
+
+        // Hacks address old browsers on purpose
+        if (declaration->namePtr()->isCustomProperty() || !declaration->importantHack().empty())
+            continue;
+
+        const auto property = String::toLower(declaration->name());
+        const auto prefix = CssBrowserSupport::vendorPrefix(property);
+        const auto unprefixed_property = property.substr(prefix.length());
+
+        if (unprefixed_property == "transition" && declaration->values().size() > 1)
+            removePrefixedTransitions(declaration);
+
+        // Example: -webkit-box-shadow: 0 0 1px #000; box-shadow: 0 0 1px #000
+        if (!prefix.empty()) {
+            if (!CssBrowserSupport::usesPrefix(prefix) ||
+                (!CssBrowserSupport::needsPrefix(prefix, unprefixed_property) &&
+                 isFollowedBy(elements, i, unprefixed_property, {})))
+                removed_declarations.emplace(&*declaration, true);
+
+            continue;
+        }
+
+        // Identifiers of these properties are names, which may start with a dash
+        if (containsName({"font", "font-family", "animation", "animation-name", "transition",
+                          "transition-property", "will-change", "counter-reset",
+                          "counter-increment", "list-style", "list-style-type"}, property))
+            continue;
+
+        // Example: display: -webkit-flex; display: flex
+        DataContainer<string> names, unprefixed_names;
+        bool is_needed = false, is_understood = true;
+
+        for (const auto &list : declaration->values())
+            collectValueNames(list, names);
+
+        for (const auto &name : names) {
+            const auto value_prefix = CssBrowserSupport::vendorPrefix(name);
+
+            if (value_prefix.empty()) continue;
+
+            // No target browser understands the declaration
+            if (!CssBrowserSupport::usesPrefix(value_prefix)) {
+                is_understood = false;
+                break;
+            }
+
+            unprefixed_names.emplace_back(name.substr(value_prefix.length()));
+            is_needed = is_needed || CssBrowserSupport::needsPrefix(value_prefix, unprefixed_names.back());
+        }
+
+        if (!is_understood || (!unprefixed_names.empty() && !is_needed &&
+                               isFollowedBy(elements, i, property, unprefixed_names)))
+            removed_declarations.emplace(&*declaration, true);
+    }
+
+    if (!removed_declarations.empty())
+        elements.removeElements([&removed_declarations](const CssBaseElementPtr &element) -> bool {
+            return removed_declarations.find(&*element) != removed_declarations.end();
+        });
+}
+
+/// Exact fraction, which math functions are evaluated with, so that folding
+/// them doesn't lose any precision
+struct CssRational
+{
+    int64_t numerator;
+    int64_t denominator;
+};
+
+/// Term of a math expression. The unit of a number is empty
+struct CssMathTerm
+{
+    string unit;
+    CssRational coefficient;
+};
+
+/// Sum of terms with distinct units, which a math expression resolves to
+using CssMathSum = DataContainer<CssMathTerm>;
+
+static int64_t greatestCommonDivisor(int64_t a, int64_t b)
+{
+    while (b != 0) {
+        const int64_t remainder = a % b;
+        a = b;
+        b = remainder;
+    }
+
+    return a < 0 ? -a : a;
+}
+
+/// Returns false, if the result overflows
+static bool makeRational(int64_t numerator, int64_t denominator, CssRational &result)
+{
+    if (denominator == 0 || numerator == INT64_MIN || denominator == INT64_MIN)
+        return false;
+
+    if (denominator < 0) {
+        numerator = -numerator;
+        denominator = -denominator;
+    }
+
+    const int64_t divisor = greatestCommonDivisor(numerator, denominator);
+    result.numerator = numerator/divisor;
+    result.denominator = denominator/divisor;
+
+    return true;
+}
+
+static bool addRationals(const CssRational &a, const CssRational &b, CssRational &result)
+{
+    int64_t numerator_a, numerator_b, numerator, denominator;
+
+    return !__builtin_mul_overflow(a.numerator, b.denominator, &numerator_a) &&
+           !__builtin_mul_overflow(b.numerator, a.denominator, &numerator_b) &&
+           !__builtin_add_overflow(numerator_a, numerator_b, &numerator) &&
+           !__builtin_mul_overflow(a.denominator, b.denominator, &denominator) &&
+           makeRational(numerator, denominator, result);
+}
+
+static bool multiplyRationals(const CssRational &a, const CssRational &b, CssRational &result)
+{
+    // Cancel crosswise first, so that the intermediate products stay small
+    const int64_t
+    divisor_1 = greatestCommonDivisor(a.numerator, b.denominator),
+    divisor_2 = greatestCommonDivisor(b.numerator, a.denominator);
+
+    int64_t numerator, denominator;
+
+    return !__builtin_mul_overflow(a.numerator/divisor_1, b.numerator/divisor_2, &numerator) &&
+           !__builtin_mul_overflow(a.denominator/divisor_2, b.denominator/divisor_1, &denominator) &&
+           makeRational(numerator, denominator, result);
+}
+
+/// Sets the result to -1, 0 or 1, if a is less than, equal to or greater than b
+static bool compareRationals(const CssRational &a, const CssRational &b, int &result)
+{
+    CssRational difference;
+
+    if (!addRationals(a, {-b.numerator, b.denominator}, difference)) return false;
+
+    result = difference.numerator < 0 ? -1 : difference.numerator > 0;
+    return true;
+}
+
+/// Reads the decimal value of a number, including its sign and scientific postfix
+static bool readRational(const CssNumberPtr &number, CssRational &result)
+{
+    int64_t numerator = 0, denominator = 1;
+    bool has_digits = false, has_point = false;
+
+    for (const char character : number->value()) {
+        if (character == '.' && !has_point) {
+            has_point = true;
+            continue;
+        }
+
+        if (character < '0' || character > '9' ||
+            __builtin_mul_overflow(numerator, 10, &numerator) ||
+            __builtin_add_overflow(numerator, character - '0', &numerator) ||
+            (has_point && __builtin_mul_overflow(denominator, 10, &denominator)))
+            return false;
+
+        has_digits = true;
+    }
+
+    if (!has_digits) return false;
+
+    const auto &postfix = number->scientificPostfix();
+
+    if (!postfix.empty()) {
+        // Example: e-3
+        size_t position = 1;
+        const bool negative_exponent = postfix.length() > 1 && postfix[1] == '-';
+
+        if (postfix.length() > 1 && (postfix[1] == '-' || postfix[1] == '+')) ++position;
+        if (position == postfix.length() || postfix.length() - position > 2) return false;
+
+        int exponent = 0;
+
+        for (; position < postfix.length(); ++position) {
+            if (postfix[position] < '0' || postfix[position] > '9') return false;
+            exponent = exponent*10 + postfix[position] - '0';
+        }
+
+        for (; exponent > 0; --exponent)
+            if (__builtin_mul_overflow(negative_exponent ? denominator : numerator, 10,
+                                       negative_exponent ? &denominator : &numerator))
+                return false;
+    }
+
+    return makeRational(number->isNegative() ? -numerator : numerator, denominator, result);
+}
+
+/// Writes the absolute value of a rational in decimal notation. Returns false,
+/// if it has no finite decimal representation. Example: 1/8 => 0.125
+static bool writeRational(const CssRational &rational, string &result)
+{
+    int64_t denominator = rational.denominator, scale = 1;
+    uint8_t decimal_places = 0;
+
+    // The fraction is finite, if the denominator is a product of 2s and 5s only.
+    // The scale extends it to a power of 10
+    while (denominator % 10 == 0 && decimal_places <= 18) {
+        denominator /= 10;
+        ++decimal_places;
+    }
+
+    while (denominator % 2 == 0 && decimal_places <= 18) {
+        denominator /= 2;
+        scale *= 5;
+        ++decimal_places;
+    }
+
+    while (denominator % 5 == 0 && decimal_places <= 18) {
+        denominator /= 5;
+        scale *= 2;
+        ++decimal_places;
+    }
+
+    int64_t digits;
+
+    if (denominator != 1 || decimal_places > 18 ||
+        __builtin_mul_overflow(rational.numerator < 0 ? -rational.numerator : rational.numerator, scale, &digits))
+        return false;
+
+    result = to_string(digits);
+
+    if (decimal_places) {
+        if (result.length() <= decimal_places)
+            result.insert(0, decimal_places - result.length() + 1, '0');
+
+        result.insert(result.length() - decimal_places, 1, '.');
+
+        while (result.back() == '0') result.pop_back();
+        if (result.back() == '.') result.pop_back();
+    }
+
+    return true;
+}
+
+static bool isMathFunction(const CssBaseElementPtr &element)
+{
+    return element->isFunction() &&
+           static_pointer_cast<CssFunction>(element)->name({"calc", "min", "max", "clamp"});
+}
+
+static bool isDelimiter(const CssBaseElementPtr &element, const char delimiter)
+{
+    return element->isDelimiter() && static_pointer_cast<CssDelimiter>(element)->value()[0] == delimiter;
+}
+
+/// Returns true, if the sum is a single number without a unit
+static bool isScalar(const CssMathSum &sum)
+{
+    return sum.size() == 1 && sum.front().unit.empty();
+}
+
+/// Adds the terms of the addend to the sum, terms of the same unit are combined
+static bool addMathSums(CssMathSum &sum, const CssMathSum &addend, const bool subtract)
+{
+    for (const auto &term : addend) {
+        const CssRational coefficient = {subtract ? -term.coefficient.numerator : term.coefficient.numerator,
+                                         term.coefficient.denominator};
+        bool found = false;
+
+        for (auto &sum_term : sum) {
+            if (sum_term.unit == term.unit) {
+                if (!addRationals(sum_term.coefficient, coefficient, sum_term.coefficient))
+                    return false;
+
+                found = true;
+                break;
+            }
+        }
+
+        if (!found) sum.push_back({term.unit, coefficient});
+    }
+
+    return true;
+}
+
+/// Multiplies or divides every term of the sum by the factor
+static bool scaleMathSum(CssMathSum &sum, CssRational factor, const bool divide)
+{
+    if (divide) {
+        if (factor.numerator == 0) return false;
+        makeRational(factor.denominator, factor.numerator, factor);
+    }
+
+    for (auto &term : sum)
+        if (!multiplyRationals(term.coefficient, factor, term.coefficient))
+            return false;
+
+    return true;
+}
+
+/// Drops terms, which are zero, as long as there are other terms. Percentages
+/// are kept, as they change, how the sum resolves. Example: calc(1px + 0%)
+static void removeZeroTerms(CssMathSum &sum)
+{
+    CssMathSum terms;
+
+    for (const auto &term : sum)
+        if (term.coefficient.numerator != 0 || term.unit == "%")
+            terms.push_back(term);
+
+    if (!terms.empty()) sum = terms;
+    else if (sum.size() > 1) sum.resize(1);
+}
+
+static bool evaluateMathFunction(const CssFunctionPtr &function, CssMathSum &sum);
+static bool evaluateMathSum(const DataContainer<CssBaseElementPtr> &elements, size_t &index, CssMathSum &sum);
+
+/// Evaluates a number, a dimension, a parenthesized sum or a nested math function
+static bool evaluateMathValue(const DataContainer<CssBaseElementPtr> &elements, size_t &index, CssMathSum &value)
+{
+    if (index == elements.size()) return false;
+
+    const auto &element = elements[index++];
+    CssRational coefficient;
+
+    if (element->replacementElement()) return false;
+
+    if (element->isNumber() || element->isDimension() || element->isPercentage()) {
+        if (!readRational(static_pointer_cast<CssNumber>(element), coefficient)) return false;
+
+        value.push_back({element->isDimension() ? String::toLower(static_pointer_cast<CssDimension>(element)->unit()) :
+                         element->isPercentage() ? "%" : "", coefficient});
+        return true;
+    }
+
+    if (isDelimiter(element, '(')) {
+        if (!evaluateMathSum(elements, index, value) ||
+            index == elements.size() || !isDelimiter(elements[index], ')'))
+            return false;
+
+        ++index;
+        return true;
+    }
+
+    return isMathFunction(element) && evaluateMathFunction(static_pointer_cast<CssFunction>(element), value);
+}
+
+/// Evaluates values, which are multiplied or divided by numbers
+static bool evaluateMathProduct(const DataContainer<CssBaseElementPtr> &elements, size_t &index, CssMathSum &product)
+{
+    if (!evaluateMathValue(elements, index, product)) return false;
+
+    while (index < elements.size() && (isDelimiter(elements[index], '*') || isDelimiter(elements[index], '/'))) {
+        const bool divide = isDelimiter(elements[index++], '/');
+        CssMathSum factor;
+
+        if (!evaluateMathValue(elements, index, factor)) return false;
+
+        // Only numbers can be multiplied with dimensions
+        if (isScalar(factor)) {
+            if (!scaleMathSum(product, factor.front().coefficient, divide)) return false;
+        } else if (isScalar(product) && !divide) {
+            const auto coefficient = product.front().coefficient;
+            product = factor;
+
+            if (!scaleMathSum(product, coefficient, false)) return false;
+        } else return false;
+    }
+
+    return true;
+}
+
+/// Evaluates products, which are added or subtracted
+static bool evaluateMathSum(const DataContainer<CssBaseElementPtr> &elements, size_t &index, CssMathSum &sum)
+{
+    if (!evaluateMathProduct(elements, index, sum)) return false;
+
+    while (index < elements.size() && (isDelimiter(elements[index], '+') || isDelimiter(elements[index], '-'))) {
+        const bool subtract = isDelimiter(elements[index++], '-');
+        CssMathSum addend;
+
+        if (!evaluateMathProduct(elements, index, addend) || !addMathSums(sum, addend, subtract))
+            return false;
+    }
+
+    removeZeroTerms(sum);
+    return true;
+}
+
+/// Evaluates a complete argument of a math function
+static bool evaluateMathArgument(const DataContainer<CssBaseElementPtr> &elements, CssMathSum &sum)
+{
+    size_t index = 0;
+    return evaluateMathSum(elements, index, sum) && index == elements.size();
+}
+
+/// Resolves a math function to a sum. Comparison functions resolve only,
+/// if all of their arguments have the same unit
+static bool evaluateMathFunction(const CssFunctionPtr &function, CssMathSum &sum)
+{
+    auto &parameters = function->parameters();
+
+    if (function->name("calc"))
+        return parameters.size() == 1 && evaluateMathArgument(parameters.front(), sum);
+
+    if (parameters.empty() || (function->name("clamp") && parameters.size() != 3)) return false;
+
+    DataContainer<CssMathTerm> arguments;
+
+    for (const auto &parameter : parameters) {
+        CssMathSum argument;
+
+        if (!evaluateMathArgument(parameter, argument) || argument.size() != 1 ||
+            (!arguments.empty() && argument.front().unit != arguments.front().unit))
+            return false;
+
+        arguments.push_back(argument.front());
+    }
+
+    auto result = arguments.front();
+    int comparison;
+
+    // clamp(MIN, VAL, MAX) resolves to max(MIN, min(VAL, MAX))
+    if (function->name("clamp")) {
+        result = arguments[1];
+
+        if (!compareRationals(arguments[2].coefficient, result.coefficient, comparison)) return false;
+        if (comparison < 0) result = arguments[2];
+
+        if (!compareRationals(arguments[0].coefficient, result.coefficient, comparison)) return false;
+        if (comparison > 0) result = arguments[0];
+    } else {
+        const int wanted_comparison = function->name("min") ? -1 : 1;
+
+        for (const auto &argument : arguments) {
+            if (!compareRationals(argument.coefficient, result.coefficient, comparison)) return false;
+            if (comparison == wanted_comparison) result = argument;
+        }
+    }
+
+    sum.push_back(result);
+    return true;
+}
+
+/// Creates the element of a term with the absolute value of its coefficient.
+/// Within math functions, percentages are dimensions, as the parser creates them
+static CssNumberPtr createMathTermElement(const CssMathTerm &term, const bool within_math_function)
+{
+    string value;
+
+    if (!writeRational(term.coefficient, value)) return nullptr;
+
+    if (term.unit.empty()) return make_shared<CssNumber>(value);
+    if (term.unit == "%" && !within_math_function) return make_shared<CssPercentage>(value);
+
+    return make_shared<CssDimension>(value, term.unit);
+}
+
+/// Writes the terms of a sum as the argument of a math function. Positive terms
+/// come first, so that only the first term may need a sign. Example: -5px + 2em => 2em - 5px
+static bool appendMathSum(const CssMathSum &sum, DataContainer<CssBaseElementPtr> &elements)
+{
+    for (const bool negative : {false, true}) {
+        for (const auto &term : sum) {
+            if ((term.coefficient.numerator < 0) != negative) continue;
+
+            const auto element = createMathTermElement(term, true);
+
+            if (!element) return false;
+
+            if (elements.empty()) element->setNegativeFlag(negative);
+            else elements.push_back(make_shared<CssDelimiter>(negative ? "-" : "+"));
+
+            elements.push_back(element);
+        }
+    }
+
+    return true;
+}
+
+/*static*/ void
+CssModifier::
+simplifyMathFunction(const CssFunctionPtr &function)
+{
+    // https://drafts.csswg.org/css-values-4/#calc-simplification
+    CssMathSum sum;
+    CssBaseElementPtr replacement;
+
+    if (evaluateMathFunction(function, sum)) {
+        const auto &term = sum.front();
+
+        // Math functions clamp their result to the range, which the property allows.
+        // Only results, which are valid for every property, omit calc() therefore.
+        // Example: calc(10px - 20px) => calc(-10px)
+        if (sum.size() == 1 && term.coefficient.numerator >= 0 &&
+            (!term.unit.empty() || term.coefficient.denominator == 1)) {
+            replacement = createMathTermElement(term, false);
+        } else {
+            DataContainer<CssBaseElementPtr> elements;
+
+            if (appendMathSum(sum, elements)) {
+                const auto calc_function = make_shared<CssFunction>("calc");
+                calc_function->appendParameter(elements);
+                replacement = calc_function;
+            }
+        }
+    }
+    // Fold the arguments of a comparison function one by one, if they have different units.
+    // Example: min(10px * 2, 50%) => min(20px, 50%)
+    else if (!function->name("calc")) {
+        const auto comparison_function = make_shared<CssFunction>(function->name());
+
+        for (const auto &parameter : function->parameters()) {
+            DataContainer<CssBaseElementPtr> elements;
+            sum.clear();
+
+            if (!evaluateMathArgument(parameter, sum) || !appendMathSum(sum, elements))
+                elements = parameter;
+
+            comparison_function->appendParameter(elements);
+        }
+
+        replacement = comparison_function;
+    }
+
+    if (replacement && generatedText(replacement).length() < generatedText(function).length())
+        function->setReplacementElement(replacement);
+}
@@ -23,13 +23,20 @@ along with this program. If not, see <https://www.gnu.org/licenses/>.
 #include "../../Console.h"
 #include "../../DataContainer.h"
 #include "../../HashTable.h"
+#include "../../Parallel.h"
+#include "../../Statistics.h"
 #include "../../String.h"
 #include "../../filesystem/FileSystem.h"
 #include "../../general/modifier/GeneralModifier.h"
+#include "../CssPassManager.h"
+#include "../CssSelectorReport.h"
+#include "../CssSizeReport.h"
 #include "../CssVendorPrefixes.h"
 #include "../parser/includes.h"
 #include "IdentInfo.h"
 #include "CssColorTable.h"
+#include "CssPropertyTable.h"
+#include "CssValueRewriteTable.h"
 #include "restructuring/CssRestructuring.h"
 #include <climits>
 #include <stack>
@@ -50,6 +57,7 @@ using CssVisitorInterface =
 class CssModifier final : public CssVisitorInterface, private GeneralModifier
 {
 public:
+    /// Reads the settings into the flags, which all modifiers share
     explicit
     CssModifier();
 
@@ -74,12 +82,53 @@ public:
     visit(const CssSupportsConditionPtr &)    override,
     visit(const CssCommentPtr &)              override;
 
+    // Used by the pipelined minifier. The top-level elements of the
+    // stylesheet are modified in batches, as soon as they are parsed.
+    void
+    beginStyleSheet(const CssBlockPtr &stylesheet),
+    modifyStyleSheetElements(const CssBlockPtr &elements),
+    endStyleSheet();
+
+    /// Returns true, if modifications are enabled which can only be done,
+    /// after the whole stylesheet has been visited
+    bool
+    needsWholeStyleSheet() const;
+
+    static string
+    /// Returns a possibly minified version of a hex color
+    getShortHexColorValue(const string &hex_value),
+
+    /// Returns a possibly minified version of a number
+    getShortNumber(string number_value);
+
 private:
     enum Context : uint8_t {
         STYLESHEET, FUNCTION_URL, KEYFRAMES_BLOCK, AT_RULE_IMPORT,
         DEFAULT_BLOCK, CURLY_BLOCK, PAREN_BLOCK, SQUARE_BLOCK
     };
 
+    /// Selects the constructor of the modifiers of parallel ranges, which
+    /// leave the shared flags to the modifier of the whole stylesheet
+    struct RangeModifier {};
+
+    explicit
+    CssModifier(RangeModifier);
+
+    static void
+    readSettings();
+
+    // Flags of the passes, which only the modifier reads
+    static bool
+    s_minify_dimensions,
+    s_simplify_math_functions,
+    s_rewrite_values,
+    s_remove_vendor_prefixes,
+    s_rewrite_shorthands,
+    s_merge_longhands,
+    s_remove_overridden_declarations,
+    s_rewrite_selectors,
+    s_unquote_urls;
+
     void
     // Generate replacement identifiers
     generateIds(),
@@ -87,7 +136,24 @@ private:
     generateCustomPropertyNames(),
     generateAnimationNames();
 
+    void
+    visitElements(const CssBlockPtr &block),
+    visitStyleSheetElements(const CssBlockPtr &stylesheet),
+    finishStyleSheet(const CssBlockPtr &stylesheet);
+
+    template<class T>
+    static void
+    mergeIdentInfos(HashTable<string, IdentInfo<T> > &target, const HashTable<string, IdentInfo<T> > &source);
+
+    static inline void
+    renameAliases(const IdentInfo<shared_ptr<string> > &ident_info),
+    renameAliases(const IdentInfo<CssIdentifierPtr> &ident_info);
+
     inline void
+    /// Marks the element, which is currently visited, to be removed from
+    /// its block, after all elements of the block have been visited
+    removeVisitedElement(),
+
     pushContext(const Context),
     popContextIf(const Context),
     popContextIf(const initializer_list<const Context>);
@@ -101,11 +167,6 @@ private:
     writeJsonFile(const string &file_name);
 
     static string
-    /// Returns a possibly minified version of a hex color
-    getShortHexColorValue(const string &hex_value),
-
-    /// Returns a possibly minified version of a number
-    getShortNumber(string number_value),
     /// Returns an RGB/RGBA hex color value from decimal values
     getHexColorFromRGBA(uint8_t r, uint8_t g, uint8_t b, uint8_t a = UCHAR_MAX),
 
@@ -124,6 +185,30 @@ private:
     static inline void
     maybeRewriteLinearGradientFunction(const CssFunctionPtr &function);
 
+    static void
+    /// Folds the constant parts of a calc(), min(), max() or clamp() function.
+    /// Example: calc(16px * 2) => 32px
+    simplifyMathFunction(const CssFunctionPtr &function);
+
+    static void
+    /// Replaces values of the declaration, which match a pattern of the value
+    /// rewrite table. Example: font-weight: bold => font-weight: 700
+    rewriteValues(const CssDeclarationPtr &declaration),
+
+    /// Omits repeated values of a shorthand. Example: margin: 0 0 0 0 => margin: 0
+    shortenShorthand(const CssDeclarationPtr &declaration),
+
+    /// Writes complete sets of longhands in the block as their shorthand
+    mergeLonghands(const CssBlockPtr &block),
+
+    /// Removes declarations of the block, which a later declaration of the
+    /// same property or of one of its shorthands overrides in every browser
+    removeOverriddenDeclarations(const CssBlockPtr &block),
+
+    /// Removes prefixed declarations and values of the block, which none of
+    /// the target browsers needs
+    removeVendorPrefixes(const CssBlockPtr &block);
+
     void
     maybeImportStyleSheet(const CssAtRulePtr &import_rule);
 
@@ -147,7 +232,10 @@ private:
     stack<CssBlockPtr> m_stylesheets;
 
     DataContainer<Context> m_context_stack;
+    /// Number of occurrences of each context on the context stack
+    uint32_t m_context_counts[SQUARE_BLOCK + 1] = {};
     stack<CssBlockPtr> m_block_stack;
+    bool m_remove_visited_element = false;
 
     const Vendor m_vendor;
 
@@ -171,21 +259,80 @@ s_rewrite_angles = false,
 s_use_rgba_hex_color_notation = false,
 s_rewrite_functions = false;
 
-extern shared_ptr<HashTable<string, IdentInfo<shared_ptr<string> > > >
+// Every thread counts identifiers in lists of its own
+extern thread_local shared_ptr<HashTable<string, IdentInfo<shared_ptr<string> > > >
 g_id_replacement_list,
 g_class_replacement_list;
 
-extern shared_ptr<HashTable<string, IdentInfo<CssIdentifierPtr> > >
+extern thread_local shared_ptr<HashTable<string, IdentInfo<CssIdentifierPtr> > >
 g_cprop_replacement_list,
 g_anim_replacement_list;
 
 static uint8_t s_import_depth = 0;
 
+template<class T>
+/*static*/ void
+CssModifier::
+mergeIdentInfos(HashTable<string, IdentInfo<T> > &target, const HashTable<string, IdentInfo<T> > &source)
+{
+    // Insert new entries in the order they were found, so that the target
+    // list ends up exactly as if all identifiers were counted on one thread
+
+    DataContainer<const pair<const string, IdentInfo<T> > *> entries;
+    entries.reserve(source.size());
+
+    for (const auto &pair : source)
+        entries.emplace_back(&pair);
+
+    sort(entries.begin(), entries.end(),
+    [](const pair<const string, IdentInfo<T> > *a, const pair<const string, IdentInfo<T> > *b) {
+        return a->second.index < b->second.index;
+    });
+
+    for (const auto &entry : entries) {
+        const auto found = target.find(entry->first);
+
+        if (found != target.end()) {
+            found->second.count += entry->second.count;
+            found->second.defined = found->second.defined || entry->second.defined;
+            found->second.aliases.emplace_back(entry->second.identifier);
+        } else {
+            auto ident_info = entry->second;
+            ident_info.index = target.size();
+            target.emplace(entry->first, ident_info);
+        }
+    }
+}
+
+/*static*/ inline void
+CssModifier::
+renameAliases(const IdentInfo<shared_ptr<string> > &ident_info)
+{
+    for (const auto &alias : ident_info.aliases)
+        *alias = *ident_info.identifier;
+}
+
+/*static*/ inline void
+CssModifier::
+renameAliases(const IdentInfo<CssIdentifierPtr> &ident_info)
+{
+    for (const auto &alias : ident_info.aliases)
+        alias->setValue(ident_info.identifier->value());
+}
+
+inline void
+CssModifier::
+removeVisitedElement()
+{
+    m_remove_visited_element = true;
+}
+
 inline void
 CssModifier::
 pushContext(const Context context)
 {
     m_context_stack.emplace_back(context);
+    ++m_context_counts[context];
 }
 
 inline void
@@ -194,8 +341,10 @@ popContextIf(const Context expected_context)
 {
     if (m_context_stack.empty()) return;
 
-    if (m_context_stack.back() == expected_context)
+    if (m_context_stack.back() == expected_context) {
         m_context_stack.pop_back();
+        --m_context_counts[expected_context];
+    }
 }
 
 inline void
@@ -207,6 +356,7 @@ popContextIf(const initializer_list<const Context> candidates)
     for (const auto &context : candidates)
         if (m_context_stack.back() == context) {
             m_context_stack.pop_back();
+            --m_context_counts[context];
             return;
         }
 }
@@ -233,11 +383,7 @@ inline bool
 CssModifier::
 hasContext(const Context context) const
 {
-    for (const auto &_context : m_context_stack)
-        if (_context == context)
-            return true;
-
-    return false;
+    return m_context_counts[context] != 0;
 }
 
 // This function is inlined, because it is called only from one position
@@ -431,8 +577,6 @@ maybeRewriteLinearGradientFunction(const CssFunctionPtr &function)
             if (param1.front()->isDimension()) {
                 const auto &dimension = static_pointer_cast<CssDimension>(param1.front());
 
-                minifyAngle(dimension);
-
                 if ((dimension->value("0") && removeUnnecessaryPercentages(params.begin()+1, params.end()) &&
                      reverseColorStops(params.begin()+1, params.end())) ||
                     (dimension->value("180") && dimension->unit("deg") &&
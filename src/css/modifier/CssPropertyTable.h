@@ -0,0 +1,234 @@
+/******************************************************************************
+This source file is part of the project
+HyperSheetsPreprocessor (HSPP) - Optimizer and minifier for CSS
+Copyright (C) 2019 Waldemar Zimpel <hspp@utilizer.de>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#ifndef CSSPROPERTYTABLE_H
+#define CSSPROPERTYTABLE_H
+#include "../../String.h"
+#include <functional>
+#include <string>
+using namespace std;
+
+/// Shorthand properties and the longhands, which they set. Shorthands,
+/// which reset further properties (font, background, border,
+/// text-decoration), are not listed, as writing them instead of their
+/// longhands would change those properties as well.
+struct CssShorthandInfo
+{
+    enum Syntax : uint8_t {
+        // One to four values for the top, right, bottom and left side,
+        // or the top-left, top-right, bottom-right and bottom-left corner
+        BOX,
+        // One value of each longhand in the order of the table
+        SEQUENCE,
+        // Like SEQUENCE, the second value is omitted, if it's equal to the first one
+        PAIR
+    };
+
+    const char *name;
+    Syntax syntax;
+    /// Longhands in the order of the values. Shorthands without longhands
+    /// are shortened only, but never written instead of their longhands.
+    const char *longhands[4];
+};
+
+static const CssShorthandInfo s_css_shorthand_table[] = {
+
+    // https://drafts.csswg.org/css-box-3/#margin-shorthand
+
+    { "margin",          CssShorthandInfo::BOX,      { "margin-top", "margin-right", "margin-bottom", "margin-left" } },
+    { "padding",         CssShorthandInfo::BOX,      { "padding-top", "padding-right", "padding-bottom", "padding-left" } },
+
+    // https://drafts.csswg.org/css-backgrounds-3/#border-shorthands
+
+    { "border-width",    CssShorthandInfo::BOX,      { "border-top-width", "border-right-width", "border-bottom-width", "border-left-width" } },
+    { "border-style",    CssShorthandInfo::BOX,      { "border-top-style", "border-right-style", "border-bottom-style", "border-left-style" } },
+    { "border-color",    CssShorthandInfo::BOX,      { "border-top-color", "border-right-color", "border-bottom-color", "border-left-color" } },
+    { "border-radius",   CssShorthandInfo::BOX,      { "border-top-left-radius", "border-top-right-radius", "border-bottom-right-radius", "border-bottom-left-radius" } },
+    { "border-top",      CssShorthandInfo::SEQUENCE, { "border-top-width", "border-top-style", "border-top-color" } },
+    { "border-right",    CssShorthandInfo::SEQUENCE, { "border-right-width", "border-right-style", "border-right-color" } },
+    { "border-bottom",   CssShorthandInfo::SEQUENCE, { "border-bottom-width", "border-bottom-style", "border-bottom-color" } },
+    { "border-left",     CssShorthandInfo::SEQUENCE, { "border-left-width", "border-left-style", "border-left-color" } },
+
+    // https://drafts.csswg.org/css-ui-4/#outline
+
+    { "outline",         CssShorthandInfo::SEQUENCE, { "outline-width", "outline-style", "outline-color" } },
+
+    // https://drafts.csswg.org/css-lists-3/#list-style-property
+
+    { "list-style",      CssShorthandInfo::SEQUENCE, { "list-style-type", "list-style-position", "list-style-image" } },
+
+    // https://drafts.csswg.org/css-flexbox-1/#flex-property
+
+    { "flex",            CssShorthandInfo::SEQUENCE, { "flex-grow", "flex-shrink", "flex-basis" } },
+    { "flex-flow",       CssShorthandInfo::SEQUENCE, { "flex-direction", "flex-wrap" } },
+
+    // https://drafts.csswg.org/css-multicol-1/#columns
+
+    { "columns",         CssShorthandInfo::SEQUENCE, { "column-width", "column-count" } },
+
+    // https://drafts.csswg.org/css-align-3/#gap-shorthand
+
+    { "gap",             CssShorthandInfo::PAIR,     { "row-gap", "column-gap" } },
+
+    // Shortened only, older browsers don't support these shorthands of
+    // commonly written longhands
+
+    { "inset",           CssShorthandInfo::BOX,      {} },
+    { "scroll-margin",   CssShorthandInfo::BOX,      {} },
+    { "scroll-padding",  CssShorthandInfo::BOX,      {} },
+    { "overflow",        CssShorthandInfo::PAIR,     {} }
+};
+
+/// Shorthands, which reset further properties besides their longhands or
+/// whose longhands aren't written as them. They override all of the
+/// listed properties and the properties, which those set in turn.
+struct CssResetInfo
+{
+    const char *name;
+    const char *properties[10];
+};
+
+static const CssResetInfo s_css_reset_table[] = {
+    { "border",          { "border-top", "border-right", "border-bottom", "border-left",
+                           "border-width", "border-style", "border-color", "border-image" } },
+    { "border-image",    { "border-image-source", "border-image-slice", "border-image-width",
+                           "border-image-outset", "border-image-repeat" } },
+    { "background",      { "background-color", "background-image", "background-repeat",
+                           "background-attachment", "background-position", "background-position-x",
+                           "background-position-y", "background-size", "background-origin",
+                           "background-clip" } },
+    { "background-position", { "background-position-x", "background-position-y" } },
+    { "font",            { "font-style", "font-variant", "font-weight", "font-stretch",
+                           "font-size", "line-height", "font-family" } },
+    { "text-decoration", { "text-decoration-line", "text-decoration-style", "text-decoration-color" } },
+    { "transition",      { "transition-property", "transition-duration",
+                           "transition-timing-function", "transition-delay" } },
+    { "animation",       { "animation-name", "animation-duration", "animation-timing-function",
+                           "animation-delay", "animation-iteration-count", "animation-direction",
+                           "animation-fill-mode", "animation-play-state" } },
+    { "overflow",        { "overflow-x", "overflow-y" } }
+};
+
+/// Calls the function for every property, which the shorthand sets
+static inline void
+forEachCssLonghand(const string &shorthand, const function<void(const string &)> &callback)
+{
+    for (const auto &info : s_css_shorthand_table) {
+        if (shorthand != info.name) continue;
+
+        for (const auto &longhand : info.longhands) {
+            if (!longhand) break;
+
+            callback(longhand);
+            forEachCssLonghand(longhand, callback);
+        }
+    }
+
+    for (const auto &info : s_css_reset_table) {
+        if (shorthand != info.name) continue;
+
+        for (const auto &property : info.properties) {
+            if (!property) break;
+
+            callback(property);
+            forEachCssLonghand(property, callback);
+        }
+    }
+}
+
+/// Keywords of CSS 2.1, which every browser understands
+static const initializer_list<const char *>
+s_css_basic_keywords = {
+    "absolute", "always", "auto", "avoid", "baseline", "bidi-override", "block", "bold",
+    "bolder", "both", "bottom", "capitalize", "center", "circle", "collapse", "crosshair",
+    "cursive", "dashed", "decimal", "default", "disc", "dotted", "double", "embed",
+    "fantasy", "fixed", "groove", "help", "hidden", "hide", "inherit", "inline",
+    "inline-block", "inline-table", "inset", "inside", "invert", "italic", "justify", "large",
+    "larger", "left", "lighter", "line-through", "list-item", "lower-alpha", "lower-roman",
+    "lowercase", "ltr", "medium", "middle", "monospace", "move", "no-repeat", "none",
+    "normal", "nowrap", "oblique", "outset", "outside", "overline", "pointer", "pre",
+    "pre-line", "pre-wrap", "progress", "relative", "repeat", "repeat-x", "repeat-y",
+    "ridge", "right", "rtl", "sans-serif", "scroll", "separate", "serif", "show", "small",
+    "small-caps", "smaller", "solid", "square", "static", "sub", "super", "table",
+    "table-caption", "table-cell", "table-column", "table-column-group",
+    "table-footer-group", "table-header-group", "table-row", "table-row-group", "text",
+    "text-bottom", "text-top", "thick", "thin", "top", "transparent", "underline",
+    "upper-alpha", "upper-roman", "uppercase", "visible", "wait", "x-large", "x-small",
+    "xx-large", "xx-small"
+};
+
+/// Units of CSS 2.1, which every browser understands
+static const initializer_list<const char *>
+s_css_basic_units = {
+    "px", "em", "ex", "pt", "pc", "cm", "mm", "in", "deg", "s", "ms"
+};
+
+/// Properties, which may set the same value of an element. Longhands
+/// share the family of their shorthand, logical properties the family
+/// of their physical counterparts.
+static inline string
+cssPropertyFamily(const string &property)
+{
+    if (property.compare(0, 2, "--") == 0)
+        return property;
+
+    auto name = String::toLower(property);
+
+    // Vendor prefix
+    if (name[0] == '-' && name.find('-', 1) != string::npos)
+        name = name.substr(name.find('-', 1) + 1);
+
+    if (name == "top" || name == "right" || name == "bottom" || name == "left")
+        return "inset";
+
+    if (name.length() >= 3 && name.compare(name.length() - 3, 3, "gap") == 0)
+        return "gap";
+
+    // Corners aren't set by the shorthands of the border sides
+    if (name.length() >= 6 && name.compare(name.length() - 6, 6, "radius") == 0)
+        return "border-radius";
+
+    if (name == "line-height")
+        return "font";
+
+    if (name == "word-wrap")
+        return "overflow";
+
+    const auto family = name.substr(0, name.find('-'));
+
+    if (family == "width" || family == "height" || family == "min" || family == "max" ||
+        family == "inline" || family == "block")
+        return "size";
+
+    if (family == "place" || family == "justify")
+        return "align";
+
+    if (family == "columns")
+        return "column";
+
+    if (family == "page")
+        return "break";
+
+    if (family == "white")
+        return "text";
+
+    return family;
+}
+
+#endif // CSSPROPERTYTABLE_H
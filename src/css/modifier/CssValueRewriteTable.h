@@ -0,0 +1,110 @@
+/******************************************************************************
+This source file is part of the project
+HyperSheetsPreprocessor (HSPP) - Optimizer and minifier for CSS
+Copyright (C) 2019 Waldemar Zimpel <hspp@utilizer.de>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#ifndef CSSVALUEREWRITETABLE_H
+#define CSSVALUEREWRITETABLE_H
+#include <string>
+using namespace std;
+
+/// Values, which are rewritten to a shorter equivalent. Patterns and
+/// replacements are written in lowercase, with single spaces between the
+/// values, commas without spaces between the arguments of a function and
+/// numbers in their shortest form, zero lengths without a unit.
+/// A '*' as the first value of a pattern stands for any value, which the
+/// replacement keeps in place of its '*'.
+struct CssValueRewriteRule
+{
+    /// Properties, the values of which are rewritten as a whole, one comma
+    /// separated list at a time. Rules without properties rewrite the
+    /// function of the pattern in the values of every property.
+    const char *properties[6];
+    const char *pattern;
+    const char *replacement;
+};
+
+static const CssValueRewriteRule s_css_value_rewrite_table[] = {
+
+    // https://drafts.csswg.org/css-fonts-4/#font-weight-prop
+
+    { { "font-weight" },                     "normal",                     "400" },
+    { { "font-weight" },                     "bold",                       "700" },
+
+    // https://drafts.csswg.org/css-backgrounds-3/#border-shorthands
+
+    { { "border", "border-top", "border-right", "border-bottom", "border-left", "outline" },
+                                             "none",                       "0" },
+
+    // https://drafts.csswg.org/css-backgrounds-3/#background-position
+    // A single value stands for the horizontal position, the vertical
+    // one defaults to center then.
+
+    { { "background-position" },             "left top",                   "0 0" },
+    { { "background-position" },             "top left",                   "0 0" },
+    { { "background-position" },             "0% 0%",                      "0 0" },
+    { { "background-position" },             "right top",                  "100% 0" },
+    { { "background-position" },             "top right",                  "100% 0" },
+    { { "background-position" },             "center top",                 "50% 0" },
+    { { "background-position" },             "top center",                 "50% 0" },
+    { { "background-position" },             "left bottom",                "0 100%" },
+    { { "background-position" },             "bottom left",                "0 100%" },
+    { { "background-position" },             "right bottom",               "100% 100%" },
+    { { "background-position" },             "bottom right",               "100% 100%" },
+    { { "background-position" },             "center bottom",              "50% 100%" },
+    { { "background-position" },             "bottom center",              "50% 100%" },
+    { { "background-position" },             "left",                       "0" },
+    { { "background-position" },             "left center",                "0" },
+    { { "background-position" },             "center left",                "0" },
+    { { "background-position" },             "right",                      "100%" },
+    { { "background-position" },             "right center",               "100%" },
+    { { "background-position" },             "center right",               "100%" },
+    { { "background-position" },             "center",                     "50%" },
+    { { "background-position" },             "center center",              "50%" },
+    { { "background-position" },             "50% 50%",                    "50%" },
+    { { "background-position" },             "* center",                   "*" },
+    { { "background-position" },             "* 50%",                      "*" },
+
+    // https://drafts.csswg.org/css-backgrounds-3/#background-size
+
+    { { "background-size" },                 "auto auto",                  "auto" },
+
+    // https://drafts.csswg.org/css-flexbox-1/#flex-common
+
+    { { "flex" },                            "1 1 0%",                     "1" },
+    { { "flex" },                            "0 0 auto",                   "none" },
+
+    // https://drafts.csswg.org/css-transforms-2/#transform-functions
+
+    { {},                                    "translate(0,0)",             "translate(0)" },
+    { {},                                    "translate3d(0,0,0)",         "translateZ(0)" },
+    { {},                                    "scale(1,1)",                 "scale(1)" },
+
+    // https://drafts.csswg.org/css-easing-1/#easing-functions
+
+    { {},                                    "cubic-bezier(.25,.1,.25,1)", "ease" },
+    { {},                                    "cubic-bezier(0,0,1,1)",      "linear" },
+    { {},                                    "cubic-bezier(.42,0,1,1)",    "ease-in" },
+    { {},                                    "cubic-bezier(0,0,.58,1)",    "ease-out" },
+    { {},                                    "cubic-bezier(.42,0,.58,1)",  "ease-in-out" },
+    { {},                                    "steps(1,start)",             "step-start" },
+    { {},                                    "steps(1,jump-start)",        "step-start" },
+    { {},                                    "steps(1,end)",               "step-end" },
+    { {},                                    "steps(1,jump-end)",          "step-end" }
+};
+
+#endif // CSSVALUEREWRITETABLE_H
@@ -1,5 +1,6 @@
 #ifndef IDENTINFO_H
 #define IDENTINFO_H
+#include "../../DataContainer.h"
 #include "../parser/elements/CssIdentifier.h"
 
 namespace CSS {
@@ -16,6 +17,13 @@ public:
     T identifier;
     uint32_t count {1};
     bool defined;
+
+    /// Number of identifiers which had been found before this one
+    uint64_t index {0};
+
+    /// Identifiers of the same name which have been counted on another
+    /// thread. They are renamed together with the identifier.
+    DataContainer<T> aliases;
 };
 
 }
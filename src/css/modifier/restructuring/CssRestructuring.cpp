@@ -18,130 +18,1474 @@ along with this program. If not, see <https://www.gnu.org/licenses/>.
 ******************************************************************************/
 
 #include "CssRestructuring.h"
+#include "../../CssBrowserSupport.h"
+#include "../CssPropertyTable.h"
+#include "../../generator/CssGenerator.h"
+#include "../../parser/elements/CssSelectorCombinator.h"
+#include "../../parser/CssTreeWalker.h"
+#include "../../../String.h"
+#include <algorithm>
 using namespace CSS::Minification;
+using namespace CSS::Generation;
+using namespace CSS::Parsing;
 
-void
-CssRestructuring::
-restructure()
+// Specificity packed into a single number, ids weigh more than classes,
+// which weigh more than types
+constexpr uint64_t ID_WEIGHT = uint64_t(1) << 32;
+constexpr uint64_t CLASS_WEIGHT = uint64_t(1) << 16;
+constexpr uint64_t TYPE_WEIGHT = 1;
+
+static string generate(const CssBaseElementPtr &element)
 {
-    if (cfg.isEnabled(Config::CSS__MERGE_MEDIA_RULES))
-        mergeMediaRules();
+    string generated;
+    CssGenerator css_generator(generated);
+    element->accept(css_generator);
+
+    return generated;
 }
 
-void
-CssRestructuring::
-mergeMediaRules()
+/// Canonical text of a single media query. The media features combined
+/// with "and" are sorted and "all" is omitted, queries using other
+/// combinations are kept as written.
+static string canonicalQuery(const DataContainer<CssBaseElementPtr> &query)
+{
+    const auto isIdentifier = [&query](const size_t index, const initializer_list<string> candidates) -> bool {
+        return index < query.size() && query[index]->isIdentifier() &&
+               static_pointer_cast<CssIdentifier>(query[index])->value(candidates);
+    };
+
+    string written, prefix, media_type;
+    DataContainer<string> features;
+    size_t index = 0;
+
+    for (const auto &element : query)
+        written += (written.empty() ? "" : " ") + generate(element);
+
+    // Custom media and custom properties are case-sensitive
+    if (written.find("--") == string::npos)
+        written = String::toLower(written);
+
+    if (isIdentifier(index, {"not", "only"})) {
+        prefix = String::toLower(static_pointer_cast<CssIdentifier>(query[index++])->value());
+
+        if (index == query.size() || !query[index]->isIdentifier())
+            return written;
+    }
+
+    if (index < query.size() && query[index]->isIdentifier() && !isIdentifier(index, {"and", "or", "not"})) {
+        media_type = String::toLower(static_pointer_cast<CssIdentifier>(query[index++])->value());
+
+        if (index != query.size() && !isIdentifier(index++, {"and"}))
+            return written;
+    }
+
+    for (; index < query.size(); ++index) {
+        if (query[index]->isIdentifier())
+            return written;
+
+        features.emplace_back(String::toLower(generate(query[index])));
+
+        if (index+1 != query.size() && !isIdentifier(++index, {"and"}))
+            return written;
+    }
+
+    if (media_type == "all" && prefix.empty())
+        media_type.clear();
+
+    sort(features.begin(), features.end());
+
+    string canonical = prefix.empty() ? media_type : prefix + ' ' + media_type;
+
+    for (const auto &feature : features)
+        canonical += (canonical.empty() ? "" : " and ") + feature;
+
+    return canonical;
+}
+
+/// Canonical text of a media query list. Queries are sorted and
+/// duplicates removed, a list with a query matching all media is "all".
+static string canonicalQueryList(const CssAtRulePtr &at_rule)
+{
+    DataContainer<string> queries;
+
+    if (at_rule->expressions()) {
+        for (const auto &query : *at_rule->expressions()) {
+            queries.emplace_back(canonicalQuery(*query));
+
+            if (queries.back().empty())
+                return "all";
+        }
+    }
+
+    if (queries.empty())
+        return "all";
+
+    sort(queries.begin(), queries.end());
+    queries.erase(unique(queries.begin(), queries.end()), queries.end());
+
+    string canonical;
+
+    for (const auto &query : queries)
+        canonical += (canonical.empty() ? "" : ",") + query;
+
+    return canonical;
+}
+
+static uint64_t specificity(const CssBaseElementPtr &element);
+
+static uint64_t compoundSpecificity(const CssSelectorPtr &compound)
+{
+    uint64_t result = 0;
+
+    const auto broadestArgument = [](const shared_ptr<DataContainer<CssSelectorPtr> > &arguments) -> uint64_t {
+        uint64_t highest = 0;
+
+        if (arguments)
+            for (const auto &argument : *arguments)
+                highest = max(highest, specificity(argument));
+
+        return highest;
+    };
+
+    // The simple selectors of a compound selector are linked from the last to the first
+    for (auto selector = compound; selector; selector = selector->parentalSelector()) {
+        switch (selector->selectorType()) {
+        case CssSelector::ID:
+            result += ID_WEIGHT;
+            break;
+        case CssSelector::CLASS:
+        case CssSelector::ATTRIBUTE:
+            result += CLASS_WEIGHT;
+            break;
+        case CssSelector::TYPE:
+        case CssSelector::PSEUDO_ELEMENT:
+            result += TYPE_WEIGHT;
+            break;
+        case CssSelector::PSEUDO_CLASS: {
+            const auto name = String::toLower(selector->name());
+
+            // Pseudo-elements written with a single colon
+            if (name == "before" || name == "after" || name == "first-line" || name == "first-letter")
+                result += TYPE_WEIGHT;
+            else if (name == "where")
+                ;
+            else if (name == "is" || name == "not" || name == "has")
+                result += broadestArgument(selector->subSelectors());
+            else if (selector->subSelectors() && !selector->subSelectors()->empty() &&
+                     selector->subSelectors()->front()->isOfType(CssSelector::AN_PLUS_B))
+                result += CLASS_WEIGHT + broadestArgument(selector->subSelectors()->front()->subSelectors());
+            else
+                result += CLASS_WEIGHT + broadestArgument(selector->subSelectors());
+            break;
+        }
+        default:;
+        }
+    }
+
+    return result;
+}
+
+static uint64_t specificity(const CssBaseElementPtr &element)
+{
+    uint64_t result = 0;
+    auto current = element;
+
+    // Combinators are nested to the left
+    while (current->isOfType(CssBaseElement::SELECTOR_COMBINATOR)) {
+        const auto combinator = static_pointer_cast<CssSelectorCombinator>(current);
+
+        result += compoundSpecificity(CssSelector::fromBase(combinator->right()));
+        current = combinator->left();
+    }
+
+    return result + compoundSpecificity(CssSelector::fromBase(current));
+}
+
+/// Keys of the declarations, whose order in the cascade matters among each
+/// other: the same property family, importance and selector specificity
+static string cascadeKey(const string &family, const uint64_t specificity, const bool important)
+{
+    return family + ' ' + to_string(specificity) + (important ? "!" : "");
+}
+
+/// Collects the cascade keys of the rules within the element. Returns
+/// false, if the element contains rules, which cannot be moved safely.
+static bool collectCascadeKeys(const CssBaseElementPtr &element, HashTable<string, bool> &keys)
+{
+    // Imported stylesheets stay in place
+    if (element->replacementElement()) {
+        collectCascadeKeys(element->replacementElement(), keys);
+        return false;
+    }
+
+    if (element->isOfType(CssBaseElement::BLOCK)) {
+        bool movable = true;
+
+        for (const auto &child : static_pointer_cast<CssBlock>(element)->elements())
+            movable = collectCascadeKeys(child, keys) && movable;
+
+        return movable;
+    }
+
+    if (element->isQualifiedRule()) {
+        const auto qualified_rule = static_pointer_cast<CssQualifiedRule>(element);
+        HashTable<uint64_t, bool> specificities;
+
+        for (const auto &selector : qualified_rule->selectors())
+            specificities.appendElement(specificity(selector), true);
+
+        if (qualified_rule->block()) {
+            for (const auto &child : qualified_rule->block()->elements()) {
+                if (!child->isDeclaration()) continue;
+
+                const auto declaration = static_pointer_cast<CssDeclaration>(child);
+                const auto family = cssPropertyFamily(declaration->name());
+
+                for (const auto &selector_specificity : specificities)
+                    keys.appendElement(cascadeKey(family, selector_specificity.first, declaration->isImportant()), true);
+            }
+        }
+
+        return true;
+    }
+
+    if (element->isAtRule()) {
+        const auto at_rule = static_pointer_cast<CssAtRule>(element);
+        const auto keyword = String::toLower(at_rule->keyword());
+
+        // The rules of keyframes don't apply to elements
+        if (keyword.length() >= 9 && keyword.compare(keyword.length() - 9, 9, "keyframes") == 0)
+            return false;
+
+        if (at_rule->block())
+            return collectCascadeKeys(at_rule->block(), keys) && (keyword == "media" || keyword == "supports");
+
+        return false;
+    }
+
+    // Comments
+    return true;
+}
+
+/// Cascade order check for moving rules in front of or behind the elements
+/// of a block. Records the last position of each cascade key in the block.
+class CascadeOrder
+{
+public:
+    /// Returns true, if rules with these keys can be moved to the position,
+    /// without passing elements containing related declarations
+    bool
+    canMoveTo(const HashTable<string, bool> &keys, const size_t position) const
+    {
+        for (const auto &key : keys) {
+            const auto separator = key.first.find(' ');
+            const auto family = key.first.substr(0, separator);
+            const auto specificity_and_importance = key.first.substr(separator);
+
+            if (isAfter(key.first, position) ||
+                // "all" sets every property
+                isAfter("all" + specificity_and_importance, position) ||
+                (family == "all" && isAfter("*" + specificity_and_importance, position)))
+                return false;
+        }
+
+        return true;
+    }
+
+    void
+    record(const HashTable<string, bool> &keys, const size_t position)
+    {
+        for (const auto &key : keys) {
+            update(key.first, position);
+            update("*" + key.first.substr(key.first.find(' ')), position);
+        }
+    }
+
+private:
+    bool
+    isAfter(const string &key, const size_t position) const
+    {
+        const auto found = m_last_positions.find(key);
+        return found != m_last_positions.end() && found->second > position;
+    }
+
+    void
+    update(const string &key, const size_t position)
+    {
+        auto &last_position = m_last_positions[key];
+        last_position = max(last_position, position);
+    }
+
+    HashTable<string, size_t> m_last_positions;
+};
+
+/// Merges the elements of a block, which have the same non-empty key, as far
+/// as this keeps the order of the cascade. The merge function moves the
+/// content of an element to the end or, if at_end is false, to the
+/// beginning of the other one. Returns the number of merged elements,
+/// which have been removed from the block.
+static uint64_t mergeElements(DataContainer<CssBaseElementPtr> &elements, const DataContainer<string> &merge_keys,
+                              const function<void(const CssBaseElementPtr &, const CssBaseElementPtr &, const bool)> &merge,
+                              HashTable<const CssBaseElement *, bool> &merged_elements)
+{
+    HashTable<string, size_t> merge_key_counts;
+    bool has_equal_merge_keys = false;
+
+    for (const auto &merge_key : merge_keys)
+        if (!merge_key.empty())
+            has_equal_merge_keys = ++merge_key_counts[merge_key] > 1 || has_equal_merge_keys;
+
+    if (!has_equal_merge_keys) return 0;
+
+    /// Elements, into which the following elements with the same key are merged
+    struct MergeTarget
+    {
+        CssBaseElementPtr element;
+        size_t position;
+        HashTable<string, bool> keys;
+        bool movable;
+    };
+
+    HashTable<string, MergeTarget> targets;
+    CascadeOrder cascade_order;
+    uint64_t merged = 0;
+
+    for (size_t position = 0; position != elements.size(); ++position) {
+        const auto &element = elements[position];
+        HashTable<string, bool> keys;
+        const bool movable = collectCascadeKeys(element, keys);
+
+        if (merge_keys[position].empty() || merge_key_counts[merge_keys[position]] < 2) {
+            cascade_order.record(keys, position);
+            continue;
+        }
+
+        const auto found = targets.find(merge_keys[position]);
+
+        if (found == targets.end()) {
+            targets.appendElement(merge_keys[position], MergeTarget {element, position, keys, movable});
+            cascade_order.record(keys, position);
+            continue;
+        }
+
+        auto &target = found->second;
+        CssBaseElementPtr merged_element;
+
+        // Move the content in front of the elements since the target ...
+        if (movable && cascade_order.canMoveTo(keys, target.position)) {
+            merge(target.element, element, true);
+            cascade_order.record(keys, target.position);
+            merged_element = element;
+        }
+        // ... or the content of the target behind them
+        else if (target.movable && cascade_order.canMoveTo(target.keys, target.position)) {
+            merge(element, target.element, false);
+            cascade_order.record(target.keys, position);
+            merged_element = target.element;
+            target.element = element;
+            target.position = position;
+        }
+        // Following elements are merged into this one
+        else {
+            target = MergeTarget {element, position, keys, movable};
+            cascade_order.record(keys, position);
+            continue;
+        }
+
+        for (const auto &key : keys)
+            target.keys.appendElement(key.first, true);
+
+        target.movable = target.movable && movable;
+        merged_elements.appendElement(&*merged_element, true);
+        ++merged;
+    }
+
+    if (merged)
+        elements.removeElements([&merged_elements](const CssBaseElementPtr &element) -> bool {
+            return merged_elements.find(&*element) != merged_elements.end();
+        });
+
+    return merged;
+}
+
+/// Moves the elements of one block to the end or the beginning of another one
+static void moveElements(const CssBlockPtr &target, const CssBlockPtr &block, const bool at_end)
+{
+    auto &elements = target->elements();
+    elements.insert(at_end ? elements.end() : elements.begin(),
+                    block->elements().begin(), block->elements().end());
+}
+
+/// Calls the function for the blocks of at-rules and imported stylesheets
+/// among the children of the block
+static void forNestedBlocks(const CssBlockPtr &block, const function<void(const CssBlockPtr &)> &function)
+{
+    for (const auto &element : block->elements()) {
+        const auto &nested = element->replacementElement() ? element->replacementElement() : element;
+
+        if (nested->isOfType(CssBaseElement::BLOCK))
+            function(static_pointer_cast<CssBlock>(nested));
+        else if (nested->isAtRule() && static_pointer_cast<CssAtRule>(nested)->block())
+            function(static_pointer_cast<CssAtRule>(nested)->block());
+    }
+}
+
+/// Simple selectors, which all target browsers understand. A selector
+/// list containing another one is invalid as a whole in some browsers,
+/// so rules with such selectors aren't combined with others. Pseudo-classes
+/// outside of the list below are looked up in the support table.
+static bool isWidelySupported(const CssBaseElementPtr &element)
 {
-    if (m_media_rules.size() > 1) {
-        using ExpressionList = DataContainer<CssBaseElementPtr>;
-        using ExpressionListPtr = shared_ptr<ExpressionList>;
-        using ExpressionLists = DataContainer<DataContainer<CssBaseElementPtr> >;
-        using ExpressionListsPtr = shared_ptr<DataContainer<shared_ptr<DataContainer<CssBaseElementPtr> > > >;
+    static const HashTable<string, bool> pseudo_classes {
+        {"active", true}, {"checked", true}, {"disabled", true}, {"empty", true},
+        {"enabled", true}, {"first-child", true}, {"first-of-type", true}, {"focus", true},
+        {"hover", true}, {"lang", true}, {"last-child", true}, {"last-of-type", true},
+        {"link", true}, {"not", true}, {"nth-child", true}, {"nth-last-child", true},
+        {"nth-of-type", true}, {"nth-last-of-type", true}, {"only-child", true},
+        {"only-of-type", true}, {"root", true}, {"target", true}, {"visited", true},
+        // Pseudo-elements written with a single colon
+        {"before", true}, {"after", true}, {"first-line", true}, {"first-letter", true}
+    };
+
+    auto current = element;
 
-        const auto compareExpression = [](const ExpressionListPtr &expression_list_1, const ExpressionListPtr &expression_list_2) -> bool {
-            ExpressionLists expressions1, expressions2;
+    while (current->isOfType(CssBaseElement::SELECTOR_COMBINATOR)) {
+        const auto combinator = static_pointer_cast<CssSelectorCombinator>(current);
 
-            for (size_t i = 0, pos1 = 0, pos2 = 0, size = expression_list_1->size(); i != size; ++i) {
-                if (i+1 == size) {
-                    expressions1.emplace_back(ExpressionList());
-                    expressions2.emplace_back(ExpressionList());
+        if (!isWidelySupported(combinator->right()))
+            return false;
 
-                    for (size_t x = pos1; x <= i; ++x)
-                        expressions1.back().emplace_back((*expression_list_1)[x]);
+        current = combinator->left();
+    }
 
-                    for (size_t x = pos2; x <= i; ++x)
-                        expressions2.back().emplace_back((*expression_list_2)[x]);
-                }
+    const auto isSupported = [](const string &feature) -> bool {
+        return CSS::CssBrowserSupport::supportsSelector(feature) == CSS::CssBrowserSupport::SUPPORTED;
+    };
 
-                if ((*expression_list_1)[i]->type() == CssBaseElement::IDENTIFIER) {
-                    const auto identifier = static_pointer_cast<CssIdentifier>((*expression_list_1)[i]);
+    for (auto selector = CssSelector::fromBase(current); selector; selector = selector->parentalSelector()) {
+        const auto name = String::toLower(selector->name());
 
-                    if (identifier->value("and")) {
-                        expressions1.emplace_back(ExpressionList());
+        if ((selector->isOfType(CssSelector::PSEUDO_CLASS) &&
+             pseudo_classes.find(name) == pseudo_classes.end() && !isSupported(name)) ||
+            (selector->isOfType(CssSelector::PSEUDO_ELEMENT) &&
+             name != "before" && name != "after" && name != "first-line" && name != "first-letter"))
+            return false;
 
-                        for (size_t x = pos1; x != i; ++x)
-                            expressions1.back().emplace_back((*expression_list_1)[x]);
+        if (!selector->isOfType(CssSelector::PSEUDO_CLASS) || !selector->subSelectors())
+            continue;
 
-                        pos1 = i+1;
-                    }
-                }
+        const auto &subselectors = *selector->subSelectors();
 
-                if ((*expression_list_2)[i]->type() == CssBaseElement::IDENTIFIER) {
-                    const auto identifier = static_pointer_cast<CssIdentifier>((*expression_list_2)[i]);
+        // Combinators are kept among the selectors of pseudo-classes as well
+        const auto isCompound = [](const CssBaseElementPtr &subselector) -> bool {
+            return subselector->isOfType(CssBaseElement::SELECTOR);
+        };
 
-                    if (identifier->value("and")) {
-                        expressions2.emplace_back(ExpressionList());
+        // Example: :not(.a, .b) or :not(.a .b)
+        if (name == "not" && (subselectors.size() > 1 || (!subselectors.empty() && !isCompound(subselectors.front()))) &&
+            !isSupported("not list"))
+            return false;
 
-                        for (size_t x = pos2; x != i; ++x)
-                            expressions2.back().emplace_back((*expression_list_2)[x]);
+        for (const auto &subselector : subselectors) {
+            if (!isCompound(subselector) || !subselector->isOfType(CssSelector::AN_PLUS_B)) {
+                if (!isWidelySupported(subselector))
+                    return false;
 
-                        pos2 = i+1;
-                    }
-                }
+                continue;
             }
 
-            const auto compareExpression = [](const ExpressionList &expr_list_1, const ExpressionList &expr_list_2) -> bool {
-                for (size_t i = 0, size = expr_list_1.size(); i != size; ++i) {
-                    if (&*(expr_list_1[i]) != &*(expr_list_2[i]))
+            // Example: :nth-child(odd of .item)
+            const auto &of_selectors = CssSelector::fromBase(subselector)->subSelectors();
+
+            if (of_selectors && !of_selectors->empty()) {
+                if (!isSupported(name + " of"))
+                    return false;
+
+                for (const auto &of_selector : *of_selectors)
+                    if (!isWidelySupported(of_selector))
                         return false;
-                }
+            }
+        }
+    }
+
+    return true;
+}
+
+/// Selector list of a rule, sorted and without duplicates. Empty for the
+/// rules of keyframes and rules containing other elements than declarations.
+static string canonicalSelectorList(const CssQualifiedRulePtr &qualified_rule)
+{
+    DataContainer<string> selectors;
+
+    if (!qualified_rule->block()) return string();
+
+    for (const auto &child : qualified_rule->block()->elements())
+        if (!child->isDeclaration())
+            return string();
+
+    for (const auto &selector : qualified_rule->selectors()) {
+        if (selector->isOfType(CssBaseElement::SELECTOR) &&
+            CssSelector::fromBase(selector)->isOfType(CssSelector::KEYFRAMES))
+            return string();
+
+        selectors.emplace_back(generate(selector));
+    }
+
+    sort(selectors.begin(), selectors.end());
+    selectors.erase(unique(selectors.begin(), selectors.end()), selectors.end());
 
+    string canonical;
+
+    for (const auto &selector : selectors)
+        canonical += (canonical.empty() ? "" : ",") + selector;
+
+    return canonical;
+}
+
+/// Declarations of a rule in their order. Empty for rules, which
+/// cannot be combined with others.
+static string declarationBlockText(const CssQualifiedRulePtr &qualified_rule)
+{
+    if (canonicalSelectorList(qualified_rule).empty()) return string();
+
+    for (const auto &selector : qualified_rule->selectors())
+        if (!isWidelySupported(selector))
+            return string();
+
+    string declarations;
+
+    for (const auto &child : qualified_rule->block()->elements())
+        declarations += generate(child) + ';';
+
+    return declarations;
+}
+
+/// Definitions, which are referred to by their name
+enum Definition : uint8_t {
+    NOT_A_DEFINITION, KEYFRAMES, COUNTER_STYLE, FONT_FACE, CUSTOM_PROPERTY
+};
+
+/// Names, which refer to definitions
+struct DefinitionReferences
+{
+    /// Custom properties, which are read, without their leading dashes
+    HashTable<string, bool> custom_properties;
+    /// Identifiers, runs of identifiers and strings in lower case
+    HashTable<string, bool> names;
+    /// Set for the definitions, which a property reads through var(), env()
+    /// or attr(). Every definition of that type may be used then.
+    bool substituted[CUSTOM_PROPERTY] = {};
+};
+
+static Definition definitionType(const CssAtRulePtr &at_rule)
+{
+    const auto keyword = String::toLower(at_rule->keyword());
+
+    if (keyword.length() >= 9 && keyword.compare(keyword.length() - 9, 9, "keyframes") == 0)
+        return KEYFRAMES;
+
+    if (keyword == "counter-style")
+        return COUNTER_STYLE;
+
+    if (keyword == "font-face")
+        return FONT_FACE;
+
+    return NOT_A_DEFINITION;
+}
+
+/// Name of the definition in lower case. Empty, if the name cannot be determined.
+static string definitionName(const CssAtRulePtr &at_rule, const Definition definition)
+{
+    if (definition == FONT_FACE) {
+        string family;
+
+        if (!at_rule->block()) return family;
+
+        for (const auto &element : at_rule->block()->elements()) {
+            if (!element->isDeclaration()) continue;
+
+            const auto declaration = static_pointer_cast<CssDeclaration>(element);
+
+            if (String::toLower(declaration->name()) != "font-family" || declaration->values().size() != 1)
+                continue;
+
+            family.clear();
+
+            // Example: font-family: "Open Sans" or font-family: Open Sans
+            for (const auto &value : declaration->values().front()) {
+                if (!family.empty()) family += ' ';
+
+                if (value->isString())
+                    family += String::toLower(static_pointer_cast<CssString>(value)->value());
+                else if (value->isIdentifier())
+                    family += String::toLower(static_pointer_cast<CssIdentifier>(value)->value());
+                else
+                    return string();
+            }
+        }
+
+        return family;
+    }
+
+    if (!at_rule->expressions() || at_rule->expressions()->empty() || at_rule->expressions()->front()->empty())
+        return string();
+
+    const auto &name = at_rule->expressions()->front()->front();
+
+    if (name->isIdentifier())
+        return String::toLower(static_pointer_cast<CssIdentifier>(name)->value());
+
+    if (name->isString())
+        return String::toLower(static_pointer_cast<CssString>(name)->value());
+
+    return string();
+}
+
+/// Type of the definitions, which the property refers to by their name
+static Definition referredDefinition(string property)
+{
+    // Example: -webkit-animation-name
+    if (property.length() > 1 && property[0] == '-' && property[1] != '-') {
+        const auto dash = property.find('-', 1);
+
+        if (dash != string::npos)
+            property.erase(0, dash + 1);
+    }
+
+    if (property == "animation" || property == "animation-name")
+        return KEYFRAMES;
+
+    if (property == "font" || property == "font-family")
+        return FONT_FACE;
+
+    // Example: content: counter(item, var(--style))
+    if (property == "list-style" || property == "list-style-type" ||
+        property.compare(0, 8, "counter-") == 0 || property == "content")
+        return COUNTER_STYLE;
+
+    return NOT_A_DEFINITION;
+}
+
+/// Returns true, if the values contain a var(), env() or attr() function
+static bool hasSubstitutionFunction(const DataContainer<CssBaseElementPtr> &values)
+{
+    for (const auto &value : values) {
+        if (!value->isFunction()) continue;
+
+        const auto function = static_pointer_cast<CssFunction>(value);
+        const auto name = String::toLower(function->name());
+
+        if (name == "var" || name == "env" || name == "attr")
+            return true;
+
+        for (const auto &parameter : function->parameters())
+            if (hasSubstitutionFunction(parameter))
                 return true;
-            };
+    }
+
+    return false;
+}
+
+/// Collects the names in a list of component values. Font families may
+/// be written as several identifiers, so runs of identifiers are collected
+/// as well.
+static void collectNames(const DataContainer<CssBaseElementPtr> &values, DefinitionReferences &references)
+{
+    // Longest font family name, which is recognized, in identifiers
+    constexpr size_t MAX_RUN_LENGTH = 6;
+
+    DataContainer<string> run;
+
+    for (const auto &value : values) {
+        if (value->isCustomProperty()) {
+            references.custom_properties.appendElement(static_pointer_cast<CssCustomProperty>(value)->value(), true);
+            run.clear();
+        }
+        else if (value->isIdentifier()) {
+            if (run.size() == MAX_RUN_LENGTH)
+                run.erase(run.begin());
+
+            run.emplace_back(String::toLower(static_pointer_cast<CssIdentifier>(value)->value()));
+
+            string name;
+
+            for (auto identifier = run.rbegin(); identifier != run.rend(); ++identifier) {
+                name = name.empty() ? *identifier : *identifier + ' ' + name;
+                references.names.appendElement(name, true);
+            }
+        }
+        else {
+            run.clear();
+
+            if (value->isString())
+                references.names.appendElement(String::toLower(static_pointer_cast<CssString>(value)->value()), true);
+            else if (value->isFunction())
+                for (const auto &parameter : static_pointer_cast<CssFunction>(value)->parameters())
+                    collectNames(parameter, references);
+        }
+    }
+}
+
+/// Collects the names in the declarations and at-rule preludes of the
+/// block. Definitions don't refer to themselves by their name.
+static void collectReferences(const CssBlockPtr &block, DefinitionReferences &references, const bool font_face = false)
+{
+    for (const auto &element : block->elements()) {
+        const auto &nested = element->replacementElement() ? element->replacementElement() : element;
+
+        if (nested->isOfType(CssBaseElement::BLOCK))
+            collectReferences(static_pointer_cast<CssBlock>(nested), references);
+        else if (nested->isDeclaration()) {
+            const auto declaration = static_pointer_cast<CssDeclaration>(nested);
+
+            const auto property = String::toLower(declaration->name());
+
+            if (font_face && property == "font-family") continue;
+
+            const auto definition = referredDefinition(property);
+
+            for (const auto &values : declaration->values()) {
+                collectNames(values, references);
+
+                // Example: animation: 1s var(--name)
+                if (definition != NOT_A_DEFINITION && hasSubstitutionFunction(values))
+                    references.substituted[definition] = true;
+            }
+        }
+        else if (nested->isQualifiedRule()) {
+            const auto qualified_rule = static_pointer_cast<CssQualifiedRule>(nested);
+
+            if (qualified_rule->block())
+                collectReferences(qualified_rule->block(), references);
+        }
+        else if (nested->isAtRule()) {
+            const auto at_rule = static_pointer_cast<CssAtRule>(nested);
+            const auto definition = definitionType(at_rule);
+
+            // Example: @container style(--theme: dark)
+            if (at_rule->expressions() && (definition == NOT_A_DEFINITION || definition == FONT_FACE)) {
+                CssTreeWalker tree_walker([&references](const CssBaseElementPtr &expression) {
+                    if (expression->isCustomProperty())
+                        references.custom_properties.appendElement(static_pointer_cast<CssCustomProperty>(expression)->value(), true);
+                    else if (expression->isIdentifier())
+                        references.names.appendElement(String::toLower(static_pointer_cast<CssIdentifier>(expression)->value()), true);
+                    else if (expression->isString())
+                        references.names.appendElement(String::toLower(static_pointer_cast<CssString>(expression)->value()), true);
+                });
+
+                for (const auto &list : *at_rule->expressions())
+                    for (const auto &expression : *list)
+                        expression->accept(tree_walker);
+            }
+
+            if (at_rule->block())
+                collectReferences(at_rule->block(), references, definition == FONT_FACE);
+        }
+    }
+}
+
+/// Removes the definitions among the descendants of the block, which
+/// aren't used. Returns the number of removed definitions.
+static uint64_t removeDefinitions(const CssBlockPtr &block, const bool remove_empty_rules,
+                                  const function<bool(Definition, const string &)> &is_used)
+{
+    uint64_t removed_definitions = 0;
+
+    block->elements().removeElements([&](const CssBaseElementPtr &element) -> bool {
+        const auto &nested = element->replacementElement() ? element->replacementElement() : element;
+        CssBlockPtr nested_block;
 
-            const auto expressionExists = [&compareExpression](const ExpressionLists &expression_lists, const ExpressionList &expression_list) -> bool {
-                for (const auto &_expression_list : expression_lists) {
-                    if (_expression_list.size() == expression_list.size())
-                        if (compareExpression(_expression_list, expression_list))
-                            return true;
-                }
+        if (nested->isOfType(CssBaseElement::BLOCK))
+            nested_block = static_pointer_cast<CssBlock>(nested);
+        else if (nested->isDeclaration()) {
+            const auto declaration = static_pointer_cast<CssDeclaration>(nested);
 
+            if (!declaration->namePtr()->isCustomProperty() || is_used(CUSTOM_PROPERTY, declaration->name()))
                 return false;
-            };
 
-            if (expressions1.size() != expressions2.size())
+            ++removed_definitions;
+            return true;
+        }
+        else if (nested->isQualifiedRule())
+            nested_block = static_pointer_cast<CssQualifiedRule>(nested)->block();
+        else if (nested->isAtRule()) {
+            const auto at_rule = static_pointer_cast<CssAtRule>(nested);
+            const auto definition = definitionType(at_rule);
+
+            if (definition == NOT_A_DEFINITION)
+                nested_block = at_rule->block();
+            else if (is_used(definition, definitionName(at_rule, definition)))
                 return false;
+            else {
+                ++removed_definitions;
+                return true;
+            }
+        }
 
-            for (const auto &expr : expressions1)
-                if (!expressionExists(expressions2, expr))
-                    return false;
+        if (!nested_block || nested_block->elements().empty()) return false;
+
+        const auto removed_descendants = removeDefinitions(nested_block, remove_empty_rules, is_used);
+        removed_definitions += removed_descendants;
+
+        // Rules, which contained unused definitions only, are removed as well
+        return removed_descendants && remove_empty_rules && nested_block->elements().empty();
+    });
+
+    return removed_definitions;
+}
+
+/// Declarations and uses of a custom property
+struct CustomPropertyUses
+{
+    /// Declaration in a rule for the root element at the top level of the
+    /// stylesheet, and that rule
+    CssDeclarationPtr declaration;
+    CssQualifiedRulePtr rule;
+
+    uint64_t declarations = 0, uses = 0;
+
+    /// Length of the var() functions, which read the custom property
+    uint64_t use_length = 0;
+
+    /// Set, if a var() function within calc(), min(), max() or clamp() reads
+    /// the custom property. Their values are generated without white space.
+    bool math_use = false;
+};
+
+/// Name of the custom property, which the var() function reads. Empty for
+/// other elements.
+static string varName(const CssBaseElementPtr &element)
+{
+    if (!element->isFunction()) return string();
+
+    const auto function = static_pointer_cast<CssFunction>(element);
+
+    if (String::toLower(function->name()) != "var" ||
+        function->parameters().empty() || function->parameters().front().empty())
+        return string();
+
+    const auto &name = function->parameters().front().front();
+
+    return name->isCustomProperty() ? static_pointer_cast<CssCustomProperty>(name)->value() : string();
+}
+
+static void countCustomPropertyUses(DataContainer<DataContainer<CssBaseElementPtr> > &lists,
+                                    HashTable<string, CustomPropertyUses> &custom_properties,
+                                    const bool within_math_function = false)
+{
+    for (const auto &list : lists) {
+        for (const auto &value : list) {
+            if (!value->isFunction()) continue;
+
+            const auto function = static_pointer_cast<CssFunction>(value);
+            const auto name = varName(value);
+
+            if (!name.empty()) {
+                auto &uses = custom_properties[name];
+                ++uses.uses;
+                uses.use_length += generate(value).length();
+                uses.math_use = uses.math_use || within_math_function;
+            }
+
+            // Fallbacks and arguments of other functions may read custom properties as well
+            countCustomPropertyUses(function->parameters(), custom_properties,
+                                    within_math_function || function->name({"calc", "min", "max", "clamp", "alpha"}));
+        }
+    }
+}
 
+/// Returns true, if a list of the value has more than one component value.
+/// Example: --gap: 1px 2px
+static bool hasSeveralValues(const DataContainer<DataContainer<CssBaseElementPtr> > &lists)
+{
+    for (const auto &list : lists)
+        if (list.size() > 1)
             return true;
-        };
 
-        const auto expressionExists = [&compareExpression](const ExpressionListsPtr &expression_lists, const ExpressionListPtr &expression_list) -> bool {
-            for (const auto &_expression_list : *expression_lists) {
-                if (&*_expression_list == &*expression_list)
-                    return true;
+    return false;
+}
+
+/// Counts the declarations and uses of the custom properties among the
+/// descendants of the block. Imported stylesheets may depend on media
+/// queries, so only rules of the stylesheet itself are at the top level.
+static void collectCustomProperties(const CssBlockPtr &block, HashTable<string, CustomPropertyUses> &custom_properties,
+                                    const bool top_level, const CssQualifiedRulePtr &root_rule = nullptr)
+{
+    for (const auto &element : block->elements()) {
+        const auto &nested = element->replacementElement() ? element->replacementElement() : element;
+
+        if (nested->isOfType(CssBaseElement::BLOCK))
+            collectCustomProperties(static_pointer_cast<CssBlock>(nested), custom_properties, false);
+        else if (nested->isDeclaration()) {
+            const auto declaration = static_pointer_cast<CssDeclaration>(nested);
+
+            countCustomPropertyUses(declaration->values(), custom_properties);
+
+            if (!declaration->namePtr()->isCustomProperty()) continue;
 
-                if (_expression_list->size() == expression_list->size() && _expression_list->size() > 2 && expression_list->size() > 2)
-                    if (compareExpression(_expression_list, expression_list))
-                        return true;
+            auto &uses = custom_properties[declaration->name()];
+            ++uses.declarations;
+
+            if (root_rule) {
+                uses.declaration = declaration;
+                uses.rule = root_rule;
             }
+        }
+        else if (nested->isQualifiedRule()) {
+            const auto qualified_rule = static_pointer_cast<CssQualifiedRule>(nested);
+
+            if (!qualified_rule->block()) continue;
+
+            const auto root = top_level && qualified_rule->selectors().size() == 1 &&
+                String::toLower(generate(qualified_rule->selectors().front())) == ":root";
+
+            collectCustomProperties(qualified_rule->block(), custom_properties, false, root ? qualified_rule : nullptr);
+        }
+        else if (nested->isAtRule() && static_pointer_cast<CssAtRule>(nested)->block())
+            collectCustomProperties(static_pointer_cast<CssAtRule>(nested)->block(), custom_properties, false);
+    }
+}
 
+/// Returns true, if the value of a custom property is the same for every
+/// element: it doesn't read other custom properties, environment variables
+/// or attributes and isn't a CSS-wide keyword
+static bool isConstantValue(DataContainer<DataContainer<CssBaseElementPtr> > &lists)
+{
+    if (lists.empty() || lists.front().empty()) return false;
+
+    if (lists.size() == 1 && lists.front().size() == 1 && lists.front().front()->isIdentifier()) {
+        const auto keyword = String::toLower(static_pointer_cast<CssIdentifier>(lists.front().front())->value());
+
+        if (keyword == "inherit" || keyword == "initial" || keyword == "unset" ||
+            keyword == "revert" || keyword == "revert-layer")
             return false;
-        };
+    }
 
-        const auto compareExpressionList = [&expressionExists](const ExpressionListsPtr &expression_list_1, const ExpressionListsPtr &expression_list_2) -> bool {
-            for (const auto &expression : *expression_list_1)
-                if (!expressionExists(expression_list_2, expression))
-                    return false;
+    for (const auto &list : lists) {
+        for (const auto &value : list) {
+            if (!value->isFunction()) continue;
+
+            const auto function = static_pointer_cast<CssFunction>(value);
+            const auto name = String::toLower(function->name());
+
+            if (name == "var" || name == "env" || name == "attr" || !isConstantValue(function->parameters()))
+                return false;
+        }
+    }
+
+    return true;
+}
+
+/// Replaces var() functions, which read one of the custom properties, with
+/// its value. A fallback isn't used, as the custom property is always
+/// defined. Values with commas are spliced into the comma separated lists.
+static bool inlineCustomPropertyUses(DataContainer<DataContainer<CssBaseElementPtr> > &lists,
+                                     const HashTable<string, CssDeclarationPtr> &custom_properties)
+{
+    bool inlined = false;
+    DataContainer<DataContainer<CssBaseElementPtr> > inlined_lists;
+
+    for (const auto &list : lists) {
+        inlined_lists.emplace_back();
+
+        for (const auto &value : list) {
+            if (!value->isFunction()) {
+                inlined_lists.back().emplace_back(value);
+                continue;
+            }
+
+            const auto found = custom_properties.find(varName(value));
+
+            if (found == custom_properties.end()) {
+                inlined = inlineCustomPropertyUses(static_pointer_cast<CssFunction>(value)->parameters(), custom_properties) || inlined;
+                inlined_lists.back().emplace_back(value);
+                continue;
+            }
+
+            const auto &values = found->second->values();
+
+            for (auto inlined_list = values.begin(); inlined_list != values.end(); ++inlined_list) {
+                if (inlined_list != values.begin())
+                    inlined_lists.emplace_back();
+
+                inlined_lists.back().insert(inlined_lists.back().end(), inlined_list->begin(), inlined_list->end());
+            }
+
+            inlined = true;
+        }
+    }
+
+    if (inlined)
+        lists = move(inlined_lists);
+
+    return inlined;
+}
+
+/// Calls the function for every declaration among the descendants of the block
+static void forEachDeclaration(const CssBlockPtr &block, const function<void(const CssDeclarationPtr &)> &function)
+{
+    for (const auto &element : block->elements()) {
+        const auto &nested = element->replacementElement() ? element->replacementElement() : element;
+
+        if (nested->isOfType(CssBaseElement::BLOCK))
+            forEachDeclaration(static_pointer_cast<CssBlock>(nested), function);
+        else if (nested->isDeclaration())
+            function(static_pointer_cast<CssDeclaration>(nested));
+        else if (nested->isQualifiedRule() && static_pointer_cast<CssQualifiedRule>(nested)->block())
+            forEachDeclaration(static_pointer_cast<CssQualifiedRule>(nested)->block(), function);
+        else if (nested->isAtRule() && static_pointer_cast<CssAtRule>(nested)->block())
+            forEachDeclaration(static_pointer_cast<CssAtRule>(nested)->block(), function);
+    }
+}
+
+void
+CssRestructuring::
+restructure()
+{
+    CssPassManager::run(CssPassManager::MERGE_MEDIA_RULES, m_stylesheet, [this]() {
+        return mergeMediaRules();
+    });
+
+    CssPassManager::run(CssPassManager::MERGE_RULES, m_stylesheet, [this]() {
+        return mergeRules();
+    });
+}
+
+bool
+CssRestructuring::
+mergeMediaRules()
+{
+    const auto merged_media_rules = m_merged_media_rules;
+
+    if (m_media_rules.size() > 1 && m_stylesheet) {
+        HashTable<const CssBaseElement *, bool> merged_rules;
+
+        mergeMediaRules(m_stylesheet, merged_rules);
+
+        if (!merged_rules.empty())
+            m_media_rules.removeElements([&merged_rules](const CssAtRulePtr &at_rule) -> bool {
+                return merged_rules.find(&*at_rule) != merged_rules.end();
+            });
+    }
+
+    return m_merged_media_rules != merged_media_rules;
+}
+
+void
+CssRestructuring::
+mergeMediaRules(const CssBlockPtr &block, HashTable<const CssBaseElement *, bool> &merged_rules)
+{
+    auto &elements = block->elements();
+
+    // Canonical query lists of the media rules, which are direct children of the block
+    DataContainer<string> query_lists;
+    query_lists.resize(elements.size());
+
+    for (size_t position = 0; position != elements.size(); ++position) {
+        const auto &element = elements[position];
+
+        if (element->isAtRule() && !element->replacementElement()) {
+            const auto at_rule = static_pointer_cast<CssAtRule>(element);
+
+            if (at_rule->keyword() == "media" && at_rule->block())
+                query_lists[position] = canonicalQueryList(at_rule);
+        }
+    }
+
+    m_merged_media_rules += mergeElements(elements, query_lists, [](const CssBaseElementPtr &target, const CssBaseElementPtr &element, const bool at_end) {
+        moveElements(static_pointer_cast<CssAtRule>(target)->block(), static_pointer_cast<CssAtRule>(element)->block(), at_end);
+    }, merged_rules);
+
+    // Media rules within other rules and imported stylesheets
+    forNestedBlocks(block, [this, &merged_rules](const CssBlockPtr &nested_block) {
+        mergeMediaRules(nested_block, merged_rules);
+    });
+}
+
+bool
+CssRestructuring::
+mergeRules()
+{
+    const auto merged_rules = m_merged_rules;
+
+    if (m_stylesheet)
+        mergeRules(m_stylesheet);
+
+    return m_merged_rules != merged_rules;
+}
+
+void
+CssRestructuring::
+mergeRules(const CssBlockPtr &block)
+{
+    auto &elements = block->elements();
+    HashTable<const CssBaseElement *, bool> merged_rules;
+    DataContainer<string> merge_keys;
+    merge_keys.resize(elements.size());
+
+    // Rules with the same selectors are combined into one block ...
+    for (size_t position = 0; position != elements.size(); ++position)
+        if (elements[position]->isQualifiedRule())
+            merge_keys[position] = canonicalSelectorList(static_pointer_cast<CssQualifiedRule>(elements[position]));
 
+    m_merged_rules += mergeElements(elements, merge_keys, [](const CssBaseElementPtr &target, const CssBaseElementPtr &element, const bool at_end) {
+        moveElements(static_pointer_cast<CssQualifiedRule>(target)->block(), static_pointer_cast<CssQualifiedRule>(element)->block(), at_end);
+    }, merged_rules);
+
+    // ... and rules with the same declarations into one selector list
+    merge_keys.assign(elements.size(), string());
+
+    for (size_t position = 0; position != elements.size(); ++position)
+        if (elements[position]->isQualifiedRule())
+            merge_keys[position] = declarationBlockText(static_pointer_cast<CssQualifiedRule>(elements[position]));
+
+    HashTable<const CssBaseElement *, CssQualifiedRulePtr> combined_rules;
+
+    m_merged_rules += mergeElements(elements, merge_keys, [&combined_rules](const CssBaseElementPtr &target, const CssBaseElementPtr &element, const bool at_end) {
+        const auto qualified_rule = static_pointer_cast<CssQualifiedRule>(target);
+        auto &selectors = qualified_rule->selectors();
+        const auto &moved_selectors = static_pointer_cast<CssQualifiedRule>(element)->selectors();
+
+        selectors.insert(at_end ? selectors.end() : selectors.begin(), moved_selectors.begin(), moved_selectors.end());
+        combined_rules[&*target] = qualified_rule;
+    }, merged_rules);
+
+    // Selectors, which occur in more than one of the combined rules
+    for (const auto &combined_rule : combined_rules) {
+        HashTable<string, bool> selectors;
+
+        combined_rule.second->selectors().removeElements([&selectors](const CssBaseElementPtr &selector) -> bool {
+            return !selectors.emplace(generate(selector), true).second;
+        });
+    }
+
+    forNestedBlocks(block, [this](const CssBlockPtr &nested_block) {
+        mergeRules(nested_block);
+    });
+}
+
+/// Removes prefixed keyframes, which no target browser needs, and keyframes,
+/// which the block repeats identically later. Returns the number of removed rules.
+static uint64_t removeKeyframes(const CssBlockPtr &block)
+{
+    uint64_t removed_rules = 0;
+
+    // Names of the unprefixed keyframes and the last of identical keyframes
+    HashTable<string, bool> unprefixed_names;
+    HashTable<string, const CssBaseElement *> last_keyframes;
+
+    for (const auto &element : block->elements()) {
+        const auto &nested = element->replacementElement() ? element->replacementElement() : element;
+
+        if (!nested->isAtRule() || definitionType(static_pointer_cast<CssAtRule>(nested)) != KEYFRAMES)
+            continue;
+
+        const auto at_rule = static_pointer_cast<CssAtRule>(nested);
+
+        if (String::toLower(at_rule->keyword()) == "keyframes")
+            unprefixed_names.emplace(definitionName(at_rule, KEYFRAMES), true);
+
+        last_keyframes[generate(at_rule)] = &*nested;
+    }
+
+    block->elements().removeElements([&](const CssBaseElementPtr &element) -> bool {
+        const auto &nested = element->replacementElement() ? element->replacementElement() : element;
+
+        if (!nested->isAtRule()) return false;
+
+        const auto at_rule = static_pointer_cast<CssAtRule>(nested);
+
+        if (definitionType(at_rule) != KEYFRAMES) {
+            if (at_rule->block() && !at_rule->block()->elements().empty())
+                removed_rules += removeKeyframes(at_rule->block());
+
+            return false;
+        }
+
+        // Example: @-webkit-keyframes spin {...} @keyframes spin {...}
+        const auto prefix = CSS::CssBrowserSupport::vendorPrefix(String::toLower(at_rule->keyword()));
+
+        if ((!prefix.empty() &&
+             (!CSS::CssBrowserSupport::usesPrefix(prefix) ||
+              (!CSS::CssBrowserSupport::needsPrefix(prefix, "keyframes") &&
+               unprefixed_names.count(definitionName(at_rule, KEYFRAMES))))) ||
+            last_keyframes[generate(at_rule)] != &*nested) {
+            ++removed_rules;
             return true;
-        };
+        }
+
+        return false;
+    });
 
-        for (auto itr1 = m_media_rules.begin(); itr1 != m_media_rules.end()-1; ++itr1) {
-            for (auto itr2 = itr1+1; itr2 != m_media_rules.end(); ++itr2) {
-                if (compareExpressionList((*itr1)->expressions(), (*itr2)->expressions())) {
-                    for (const auto &element : (*itr2)->block()->elements())
-                        (*itr1)->block()->elements().appendElement(element);
+    return removed_rules;
+}
+
+static CSS::CssBrowserSupport::Support evaluateSupportsCondition(const DataContainer<CssBaseElementPtr> &condition);
+
+/// Evaluates a declaration or a condition in parentheses. Other elements
+/// like selector() aren't evaluated.
+static CSS::CssBrowserSupport::Support evaluateSupportsInParens(const CssBaseElementPtr &element)
+{
+    const auto &nested = element->replacementElement() ? element->replacementElement() : element;
+
+    if (!nested->isOfType(CssBaseElement::BLOCK) || static_pointer_cast<CssBlock>(nested)->blockType() != CssBlock::PAREN)
+        return CSS::CssBrowserSupport::PARTIALLY_SUPPORTED;
+
+    const auto &elements = static_pointer_cast<CssBlock>(nested)->elements();
+
+    // Example: (display: grid)
+    if (elements.size() == 1 && elements.front()->isDeclaration()) {
+        const auto declaration = static_pointer_cast<CssDeclaration>(elements.front());
+        const auto &values = declaration->values();
+        string value;
+
+        if (!declaration->importantHack().empty() || values.empty() || values.front().empty())
+            return CSS::CssBrowserSupport::PARTIALLY_SUPPORTED;
 
-                    m_stylesheet->removeElement(*itr2);
-                    m_media_rules.erase(itr2--);
-                }
+        // Example: (grid-template-columns: 1fr 1fr)
+        for (const auto &list : values) {
+            if (!value.empty()) value += ',';
+
+            for (const auto &element : list) {
+                if (!value.empty() && value.back() != ',') value += ' ';
+                value += generate(element);
             }
+        }
+
+        return CSS::CssBrowserSupport::supportsDeclaration(
+            declaration->namePtr()->isCustomProperty() ? "--" : declaration->name(), value);
+    }
+
+    return evaluateSupportsCondition(elements);
+}
+
+/// Evaluates a supports condition, which is either "not" followed by a
+/// condition in parentheses or conditions in parentheses joined by "and"
+/// or by "or"
+static CSS::CssBrowserSupport::Support evaluateSupportsCondition(const DataContainer<CssBaseElementPtr> &condition)
+{
+    const auto keyword = [&condition](const size_t position) -> string {
+        const auto &element = condition[position]->replacementElement() ?
+                              condition[position]->replacementElement() : condition[position];
+
+        return element->isIdentifier() ? String::toLower(static_pointer_cast<CssIdentifier>(element)->value()) : string();
+    };
+
+    // Example: not (display: grid)
+    if (condition.size() == 2 && keyword(0) == "not")
+        return CSS::CssBrowserSupport::Support(CSS::CssBrowserSupport::SUPPORTED - evaluateSupportsInParens(condition[1]));
+
+    if (condition.size() % 2 == 0)
+        return CSS::CssBrowserSupport::PARTIALLY_SUPPORTED;
+
+    auto support = evaluateSupportsInParens(condition.front());
+
+    // Example: (display: grid) and (gap: 1em)
+    for (size_t position = 1; position < condition.size(); position += 2) {
+        const auto operation = keyword(position);
+
+        if ((operation != "and" && operation != "or") || operation != keyword(1))
+            return CSS::CssBrowserSupport::PARTIALLY_SUPPORTED;
+
+        const auto operand = evaluateSupportsInParens(condition[position + 1]);
+        support = operation == "and" ? min(support, operand) : max(support, operand);
+    }
+
+    return support;
+}
+
+/// Removes the supports rules among the descendants of the block, whose
+/// conditions no target browser meets, and replaces those, whose conditions
+/// all target browsers meet, by their rules. Returns the number of removed
+/// and replaced supports rules.
+static uint64_t unwrapSupportsRules(const CssBlockPtr &block, const bool remove_empty_rules)
+{
+    uint64_t evaluated_rules = 0;
+    DataContainer<CssBaseElementPtr> elements;
+
+    for (const auto &element : block->elements()) {
+        const auto &nested = element->replacementElement() ? element->replacementElement() : element;
+
+        if (nested->isOfType(CssBaseElement::BLOCK))
+            evaluated_rules += unwrapSupportsRules(static_pointer_cast<CssBlock>(nested), remove_empty_rules);
+
+        if (!nested->isAtRule() || !static_pointer_cast<CssAtRule>(nested)->block()) {
+            elements.emplace_back(element);
+            continue;
+        }
+
+        const auto at_rule = static_pointer_cast<CssAtRule>(nested);
+
+        // Supports rules within supports and media rules
+        const auto evaluated_descendants = unwrapSupportsRules(at_rule->block(), remove_empty_rules);
+        evaluated_rules += evaluated_descendants;
+
+        // Rules, which contained removed supports rules only, are removed as well
+        if (evaluated_descendants && remove_empty_rules && at_rule->block()->elements().empty())
+            continue;
 
-            if (&*itr1 == &m_media_rules.back()) break;
+        const auto support = String::toLower(at_rule->keyword()) == "supports" &&
+                             at_rule->expressions() && at_rule->expressions()->size() == 1 ?
+                             evaluateSupportsCondition(*at_rule->expressions()->front()) :
+                             CSS::CssBrowserSupport::PARTIALLY_SUPPORTED;
+
+        if (support == CSS::CssBrowserSupport::PARTIALLY_SUPPORTED) {
+            elements.emplace_back(element);
+            continue;
         }
+
+        ++evaluated_rules;
+
+        if (support == CSS::CssBrowserSupport::SUPPORTED)
+            elements.insert(elements.end(), at_rule->block()->elements().begin(), at_rule->block()->elements().end());
+    }
+
+    if (evaluated_rules)
+        block->setElements(elements);
+
+    return evaluated_rules;
+}
+
+void
+CssRestructuring::
+removeUnusedDefinitions()
+{
+    // Definitions, which are referred to from outside of the stylesheet,
+    // e.g. by scripts. Custom properties are listed with their dashes.
+    HashTable<string, bool> kept_custom_properties, kept_names;
+
+    for (const auto &name : cfg.cssKeepDefinitions()) {
+        if (name.substr(0, 2) == "--")
+            kept_custom_properties.appendElement(name.substr(2), true);
+        else if (!name.empty())
+            kept_names.appendElement(String::toLower(name), true);
     }
+
+    const auto remove_empty_rules = CssPassManager::isEnabled(CssPassManager::REMOVE_EMPTY_RULES);
+
+    CssPassManager::run(CssPassManager::REMOVE_UNUSED_DEFINITIONS, m_stylesheet, [&]() {
+        DefinitionReferences references;
+        collectReferences(m_stylesheet, references);
+
+        const auto removed_definitions = removeDefinitions(m_stylesheet, remove_empty_rules,
+        [&](const Definition definition, const string &name) -> bool {
+            // Definitions of unknown names are kept
+            if (name.empty()) return true;
+
+            if (definition == CUSTOM_PROPERTY)
+                return references.custom_properties.count(name) || kept_custom_properties.count(name);
+
+            if (references.substituted[definition]) return true;
+
+            // Font families of several words are listed without spaces
+            string listed_name = name;
+            listed_name.erase(remove(listed_name.begin(), listed_name.end(), ' '), listed_name.end());
+
+            return references.names.count(name) || kept_names.count(name) || kept_names.count(listed_name);
+        });
+
+        m_removed_definitions += removed_definitions;
+        return removed_definitions != 0;
+    });
+}
+
+void
+CssRestructuring::
+inlineCustomProperties()
+{
+    // Custom properties, which scripts may read or change
+    HashTable<string, bool> kept_custom_properties;
+
+    for (const auto &name : cfg.cssKeepDefinitions())
+        if (name.substr(0, 2) == "--")
+            kept_custom_properties.appendElement(name.substr(2), true);
+
+    const auto remove_empty_rules = CssPassManager::isEnabled(CssPassManager::REMOVE_EMPTY_RULES);
+
+    CssPassManager::run(CssPassManager::INLINE_CUSTOM_PROPERTIES, m_stylesheet, [&]() {
+        HashTable<string, CustomPropertyUses> custom_properties;
+        collectCustomProperties(m_stylesheet, custom_properties, true);
+
+        HashTable<string, CssDeclarationPtr> inlined_custom_properties;
+        HashTable<const CssBaseElement *, CssQualifiedRulePtr> root_rules;
+
+        for (const auto &custom_property : custom_properties) {
+            const auto &uses = custom_property.second;
+
+            if (uses.declarations != 1 || !uses.declaration || !uses.uses ||
+                kept_custom_properties.count(custom_property.first) ||
+                !isConstantValue(uses.declaration->values()) ||
+                // The values would be spliced into the math function without
+                // their separators. Example: calc(2*var(--a)) with --a: 1 +2
+                (uses.math_use && hasSeveralValues(uses.declaration->values())))
+                continue;
+
+            uint64_t value_length = 0;
+
+            for (const auto &list : uses.declaration->values())
+                for (const auto &value : list)
+                    value_length += generate(value).length() + 1;
+
+            // Example: --name:value; and the var() functions, which read it
+            const auto definition_length = custom_property.first.length() + 3 + value_length;
+
+            if (uses.uses * value_length >= definition_length + uses.use_length) continue;
+
+            inlined_custom_properties.appendElement(custom_property.first, uses.declaration);
+            root_rules.appendElement(&*uses.rule, uses.rule);
+        }
+
+        if (inlined_custom_properties.empty()) return false;
+
+        forEachDeclaration(m_stylesheet, [&inlined_custom_properties](const CssDeclarationPtr &declaration) {
+            inlineCustomPropertyUses(declaration->values(), inlined_custom_properties);
+        });
+
+        // The definitions aren't needed anymore
+        for (const auto &root_rule : root_rules) {
+            root_rule.second->block()->elements().removeElements([&inlined_custom_properties](const CssBaseElementPtr &element) -> bool {
+                if (!element->isDeclaration()) return false;
+
+                const auto declaration = static_pointer_cast<CssDeclaration>(element);
+                const auto found = inlined_custom_properties.find(declaration->name());
+
+                return declaration->namePtr()->isCustomProperty() &&
+                       found != inlined_custom_properties.end() && found->second == declaration;
+            });
+        }
+
+        if (remove_empty_rules)
+            m_stylesheet->elements().removeElements([&root_rules](const CssBaseElementPtr &element) -> bool {
+                return root_rules.count(&*element) && static_pointer_cast<CssQualifiedRule>(element)->block()->elements().empty();
+            });
+
+        m_inlined_custom_properties += inlined_custom_properties.size();
+        return true;
+    });
+}
+
+void
+CssRestructuring::
+removeVendorPrefixedRules()
+{
+    CssPassManager::run(CssPassManager::REMOVE_VENDOR_PREFIXES, m_stylesheet, [this]() {
+        const auto removed_rules = removeKeyframes(m_stylesheet);
+
+        m_removed_prefixed_rules += removed_rules;
+        return removed_rules != 0;
+    });
+}
+
+void
+CssRestructuring::
+evaluateSupportsRules()
+{
+    const auto remove_empty_rules = CssPassManager::isEnabled(CssPassManager::REMOVE_EMPTY_RULES);
+
+    CssPassManager::run(CssPassManager::EVALUATE_SUPPORTS, m_stylesheet, [this, remove_empty_rules]() {
+        const auto evaluated_rules = unwrapSupportsRules(m_stylesheet, remove_empty_rules);
+
+        m_evaluated_supports_rules += evaluated_rules;
+        return evaluated_rules != 0;
+    });
 }
@@ -21,6 +21,7 @@ along with this program. If not, see <https://www.gnu.org/licenses/>.
 #define CSSRESTRUCTURING_H
 #include "../../../config/Config.h"
 #include "../../../HashTable.h"
+#include "../../CssPassManager.h"
 #include "../../parser/elements/CssAtRule.h"
 #include "../../parser/elements/CssQualifiedRule.h"
 #include "../../parser/elements/CssSelector.h"
@@ -44,16 +45,77 @@ public:
     appendAtRuleMedia(const CssAtRulePtr &at_rule_media);
 
     void
-    restructure();
+    restructure(),
+
+    /// Removes keyframes, counter styles, font faces and custom properties,
+    /// which the stylesheet doesn't refer to
+    removeUnusedDefinitions(),
+
+    /// Replaces the uses of custom properties, which are defined once for
+    /// the root element, with their values, if this is shorter
+    inlineCustomProperties(),
+
+    /// Removes prefixed keyframes, which none of the target browsers needs,
+    /// and keyframes, which are repeated identically
+    removeVendorPrefixedRules(),
+
+    /// Removes supports rules, whose conditions none of the target browsers
+    /// meets, and unwraps those, whose conditions all of them meet
+    evaluateSupportsRules();
+
+    inline const DataContainer<CssAtRulePtr>
+    &mediaRules() const;
+
+    inline uint64_t
+    mergedMediaRules() const,
+    mergedRules() const,
+    removedDefinitions() const,
+    inlinedCustomProperties() const,
+    removedPrefixedRules() const,
+    evaluatedSupportsRules() const;
 
 private:
-    void
+    /// Returns true, if any media rules have been merged
+    bool
     mergeMediaRules();
 
+    /// Merges media rules with equivalent query lists among the children
+    /// of the block, as far as this keeps the order of the cascade
+    void
+    mergeMediaRules(const CssBlockPtr &block, HashTable<const CssBaseElement *, bool> &merged_rules);
+
+    /// Returns true, if any qualified rules have been merged
+    bool
+    mergeRules();
+
+    /// Combines rules with the same selectors into one block and rules with
+    /// the same declarations into one selector list, as far as this keeps
+    /// the order of the cascade
+    void
+    mergeRules(const CssBlockPtr &block);
+
     DataContainer<CssAtRulePtr>
     m_media_rules;
 
     StyleSheetPtr m_stylesheet;
+
+    /// Number of media rules, which have been merged into others
+    uint64_t m_merged_media_rules {0};
+
+    /// Number of qualified rules, which have been merged into others
+    uint64_t m_merged_rules {0};
+
+    /// Number of unused definitions, which have been removed
+    uint64_t m_removed_definitions {0};
+
+    /// Number of custom properties, which have been inlined
+    uint64_t m_inlined_custom_properties {0};
+
+    /// Number of prefixed or repeated keyframes, which have been removed
+    uint64_t m_removed_prefixed_rules {0};
+
+    /// Number of supports rules, which have been removed or unwrapped
+    uint64_t m_evaluated_supports_rules {0};
 };
 
 inline void
@@ -70,6 +132,55 @@ appendAtRuleMedia(const CssAtRulePtr &at_rule_media)
     m_media_rules.emplace_back(at_rule_media);
 }
 
+inline const DataContainer<CssAtRulePtr> &
+CssRestructuring::
+mediaRules() const
+{
+    return m_media_rules;
+}
+
+inline uint64_t
+CssRestructuring::
+mergedMediaRules() const
+{
+    return m_merged_media_rules;
+}
+
+inline uint64_t
+CssRestructuring::
+mergedRules() const
+{
+    return m_merged_rules;
+}
+
+inline uint64_t
+CssRestructuring::
+removedDefinitions() const
+{
+    return m_removed_definitions;
+}
+
+inline uint64_t
+CssRestructuring::
+inlinedCustomProperties() const
+{
+    return m_inlined_custom_properties;
+}
+
+inline uint64_t
+CssRestructuring::
+removedPrefixedRules() const
+{
+    return m_removed_prefixed_rules;
+}
+
+inline uint64_t
+CssRestructuring::
+evaluatedSupportsRules() const
+{
+    return m_evaluated_supports_rules;
+}
+
 } // namespace Minification
 } // namespace CSS
 
@@ -22,7 +22,8 @@ using namespace CSS::Parsing;
 
 CssParser::CssParser(const GeneralTokenStreamPtr &token_stream, string file_name) :
     GeneralParser(token_stream),
-    m_stylesheet(make_shared<CssBlock>(CssBlock::STYLESHEET)),
+    m_arena(make_shared<MemoryArena>()),
+    m_stylesheet(createElement<CssBlock>(CssBlock::STYLESHEET)),
     m_file_name(move(file_name)) {}
 
 const CssParser::StyleSheetPtr
@@ -46,10 +47,23 @@ CssParser::parse()
 CssParser::
 parse(const shared_ptr<string> &content, const string &file_name)
 {
+    // Stylesheets smaller than this are always parsed on a single thread
+    constexpr uint64_t MIN_SEGMENT_SIZE = 64 * 1024;
+
+    const auto thread_count = Parallel::threadCount();
+
+    if (thread_count > 1 && content->length() >= 2 * MIN_SEGMENT_SIZE) {
+        const auto segments = CssTokenizer::splitTopLevelRules(
+            *content, max<uint64_t>(MIN_SEGMENT_SIZE, content->length() / thread_count));
+
+        if (segments.size() > 1)
+            return parseSegments(*content, segments, file_name);
+    }
+
     // Tokenize stylesheet
     const auto token_stream = CssTokenizer::tokenize(content);
     // Parse token stream and return the AST
-    return CssParser(token_stream, file_name).parse();
+    return parse(token_stream, file_name);
 }
 
 /*static*/ const CssParser::StyleSheetPtr
@@ -59,7 +73,118 @@ parse(const string &content, const string &file_name, const uint32_t begin_row,
     // Tokenize stylesheet
     const auto token_stream = CssTokenizer::tokenize(content, begin_row, begin_column);
     // Parse token stream and return the AST
-    return CssParser(token_stream, file_name).parse();
+    return parse(token_stream, file_name);
+}
+
+/*static*/ const CssParser::StyleSheetPtr
+CssParser::
+parse(const GeneralTokenStreamPtr &token_stream, const string &file_name)
+{
+    if (Statistics::isEnabled())
+        countTokens(*token_stream);
+
+    Statistics::PhaseTimer parse_timer(Statistics::PARSE);
+    // Parse token stream and get the AST
+    CssParser parser(token_stream, file_name);
+    const auto stylesheet = parser.parse();
+    parse_timer.stop();
+
+    if (Statistics::isEnabled()) {
+        countElements(stylesheet);
+#ifdef HSPP_ALLOC_STATS
+        parser.countElementBytes();
+#endif
+    }
+
+    return stylesheet;
+}
+
+/*static*/ void
+CssParser::
+countTokens(const GeneralTokenStream &token_stream)
+{
+    array<uint64_t, UCHAR_MAX + 1> counts {};
+
+    for (const auto &token : token_stream)
+        ++counts[static_pointer_cast<CssToken>(token)->type()];
+
+    for (uint64_t type = 0; type < counts.size(); ++type)
+        if (counts[type] != 0)
+            Statistics::addCount("tokens", CssToken::typeName(CssToken::CssTokenType(type)), counts[type]);
+}
+
+/*static*/ void
+CssParser::
+countElements(const StyleSheetPtr &stylesheet)
+{
+    array<uint64_t, UCHAR_MAX + 1> counts {};
+
+    CssTreeWalker tree_walker([&counts](const CssBaseElementPtr &element) {
+        ++counts[element->type()];
+    });
+
+    for (const auto &element : stylesheet->elements())
+        element->accept(tree_walker);
+
+    for (uint64_t type = 0; type < counts.size(); ++type)
+        if (counts[type] != 0)
+            Statistics::addCount("nodes", CssBaseElement::typeName(CssBaseElement::ElementType(type)), counts[type]);
+}
+
+#ifdef HSPP_ALLOC_STATS
+void
+CssParser::
+countElementBytes() const
+{
+    for (uint64_t type = 0; type < m_element_bytes.size(); ++type)
+        if (m_element_bytes[type] != 0)
+            Statistics::addCount("node_bytes", CssBaseElement::typeName(CssBaseElement::ElementType(type)), m_element_bytes[type]);
+}
+#endif
+
+/*static*/ const CssParser::StyleSheetPtr
+CssParser::
+parseSegments(const string &content, const DataContainer<CssTokenizer::Segment> &segments, const string &file_name)
+{
+    DataContainer<StyleSheetPtr> stylesheets;
+    stylesheets.resize(segments.size());
+
+    // Reports of the syntax errors per segment and the first segment with one
+    DataContainer<string> errors;
+    errors.resize(segments.size());
+    atomic<uint64_t> first_error {segments.size()};
+
+    // Tokenize and parse the segments concurrently
+    Parallel::forEach(segments.size(), [&](const uint64_t index) {
+        // Segments after the first erroneous one don't need to be parsed
+        if (index > first_error) return;
+
+        const auto &segment = segments.at(index);
+        SyntaxError::DeferScope defer_errors;
+
+        try {
+            stylesheets.at(index) = parse(content.substr(segment.begin, segment.end - segment.begin),
+                                          file_name, segment.begin_row, segment.begin_column);
+        } catch (const SyntaxError &error) {
+            errors.at(index) = error.what();
+
+            auto first = first_error.load();
+            while (index < first && !first_error.compare_exchange_weak(first, index));
+        }
+    });
+
+    // Report the first error in document order on the calling thread
+    if (first_error < segments.size())
+        SyntaxError::raise(errors.at(first_error));
+
+    // Join the rules in document order
+    const auto &stylesheet = stylesheets.front();
+
+    for (auto itr = stylesheets.begin() + 1; itr != stylesheets.end(); ++itr)
+        for (const auto &element : (*itr)->elements())
+            stylesheet->appendElement(element);
+
+    return stylesheet;
 }
 
 /*static*/ const CssParser::StyleSheetPtr
@@ -101,7 +226,7 @@ CssParser::
 parseComment()
 {
     if (currentToken()->isComment()) {
-        CssComment::CommentType comment_type;
+        CssComment::CommentType comment_type = CssComment::COMMENT;
 
         switch (currentToken()->type()) {
         case CssToken::COMMENT:
@@ -116,7 +241,7 @@ parseComment()
         default:;
         }
 
-        const auto comment_element = make_shared<CssComment>(comment_type, currentToken()->content());
+        const auto comment_element = createElement<CssComment>(comment_type, currentToken()->content());
         m_tmp_result_stack.emplace(comment_element);
         lookAhead();
         return true;
@@ -129,7 +254,7 @@ bool
 CssParser::
 parseBlock(CssBlock::BlockType block_type)
 {
-    auto block = make_shared<CssBlock>(block_type);
+    auto block = createElement<CssBlock>(block_type);
 
     if (parseDeclarationList()) {
         // Set AST elements
@@ -180,7 +305,7 @@ parseParenBlock()
 {
     if (currentToken()->isPunctuator('(') && lookAhead()) {
         if (currentToken()->isPunctuator('(')) {
-            const auto paren_block = make_shared<CssBlock>(CssBlock::PAREN);
+            const auto paren_block = createElement<CssBlock>(CssBlock::PAREN);
             while (parseValue() || parseParenBlock()) {
                 paren_block->appendElement(m_tmp_result_stack.top());
                 m_tmp_result_stack.pop();
@@ -206,7 +331,7 @@ parseQualifiedRule()
 {
     if (parseSelectorList() && currentToken()->isPunctuator('{')) {
         // Create an object for the qualified rule and assign the selector list to it
-        const auto qualified_rule = make_shared<CssQualifiedRule>(m_tmp_list.top());
+        const auto qualified_rule = createElement<CssQualifiedRule>(m_tmp_list.top());
         // Remove the selector list from the top of the temporal list stack
         m_tmp_list.pop();
 
@@ -234,7 +359,7 @@ parseSelector()
            currentToken()->isHashLiteral() || currentToken()->isIdentifier()) {
 
         parental_selector = recent_selector ?
-            recent_selector : make_shared<CssSelector>(CssSelector::UNIVERSAL, "*");
+            recent_selector : createElement<CssSelector>(CssSelector::UNIVERSAL, "*");
 
         switch (currentToken()->type()) {
         case CssToken::PUNCTUATOR:
@@ -242,7 +367,7 @@ parseSelector()
             case '.':
                 if (!nextToken()->isIdentifier() && advance()) throwParseError("Invalid class name");
                 advance();
-                current_selector = make_shared<CssSelector>(CssSelector::CLASS, currentToken()->content());
+                current_selector = createElement<CssSelector>(CssSelector::CLASS, currentToken()->content());
                 current_selector->setInitialPosition(currentToken()->row(), currentToken()->column() - 1);
                 advance();
                 break;
@@ -261,19 +386,19 @@ parseSelector()
                 }
                 break;
             case '*':
-                current_selector = make_shared<CssSelector>(CssSelector::UNIVERSAL, "*");
+                current_selector = createElement<CssSelector>(CssSelector::UNIVERSAL, "*");
                 advance();
                 break;
             }
             break;
         case CssToken::HASH_LITERAL:
             if (currentToken()->content().empty()) throwParseError("Invalid id");
-            current_selector = make_shared<CssSelector>(CssSelector::ID, currentToken()->content());
+            current_selector = createElement<CssSelector>(CssSelector::ID, currentToken()->content());
             current_selector->setInitialPosition(currentToken()->row(), currentToken()->column());
             advance();
             break;
         case CssToken::IDENTIFIER:
-            current_selector = make_shared<CssSelector>(CssSelector::TYPE, currentToken()->content());
+            current_selector = createElement<CssSelector>(CssSelector::TYPE, currentToken()->content());
             advance();
             break;
         default:
@@ -329,11 +454,11 @@ parseSelectorCombination()
         if (currentToken()->isPunctuator({'>', '+', '~'}) || currentToken()->isWhiteSpace()) {
 
             combinator = currentToken()->isWhiteSpace() ?
-                make_shared<CssSelectorCombinator>(CssSelectorCombinator::DESCENDANCY) :
-                make_shared<CssSelectorCombinator>(
+                createElement<CssSelectorCombinator>(CssSelectorCombinator::DESCENDANCY) :
+                createElement<CssSelectorCombinator>(
                     CssSelectorCombinator::getCombinatorType(currentToken()->content().front()));
 
-            !left && (left = make_shared<CssSelector>(CssSelector::UNIVERSAL, "*"));
+            !left && (left = createElement<CssSelector>(CssSelector::UNIVERSAL, "*"));
 
             lookAhead(); continue;
         }
@@ -377,7 +502,7 @@ parseAttributeSelector()
 {
     if (currentToken()->isPunctuator('[') && lookAhead()) {
         const auto row = currentToken()->row(), column = currentToken()->column();
-        const auto attribute_selector = make_shared<CssSelectorAttribute>();
+        const auto attribute_selector = createElement<CssSelectorAttribute>();
 
         if (!currentToken()->isIdentifier()) throwParseError("");
 
@@ -443,7 +568,7 @@ CssParser::
 parsePseudoClass()
 {
     if (currentToken()->isPunctuator(':') && nextToken()->isIdentifier() && advance()) {
-        const auto pseudo_class = make_shared<CssSelector>(CssSelector::PSEUDO_CLASS, currentToken()->content());
+        const auto pseudo_class = createElement<CssSelector>(CssSelector::PSEUDO_CLASS, currentToken()->content());
 
         if (currentToken()->hasContent({"is", "not", "where", "has", "host", "host-context"})) {
             if (nextToken()->isPunctuator('(') && advance() && lookAhead()) {
@@ -475,7 +600,7 @@ parsePseudoClass()
                 }
 
                 if (!an_plus_b.empty()) {
-                    const auto an_plus_b_selector = make_shared<CssSelector>(CssSelector::AN_PLUS_B, an_plus_b);
+                    const auto an_plus_b_selector = createElement<CssSelector>(CssSelector::AN_PLUS_B, an_plus_b);
                     pseudo_class->appendSubSelector(an_plus_b_selector);
 
                     if (currentToken()->isIdentifier("of") && lookAhead()) {
@@ -496,7 +621,7 @@ parsePseudoClass()
         }
         else if (currentToken()->hasContent({"lang", "-ms-lang"}) && nextToken()->isPunctuator('(') && advance() && lookAhead()) {
             if (currentToken()->isIdentifier()) {
-                const auto lang_identifier = make_shared<CssSelector>(CssSelector::NONE, currentToken()->content());
+                const auto lang_identifier = createElement<CssSelector>(CssSelector::NONE, currentToken()->content());
                 pseudo_class->appendSubSelector(lang_identifier);
                 lookAhead();
 
@@ -581,7 +706,7 @@ parsePseudoElement()
 {
     if (currentToken()->isPunctuator(':') && nextToken()->isPunctuator(':') &&
         currentToken(+2)->isIdentifier() && advance(+2)) {
-        const auto pseudo_element = make_shared<CssSelector>(CssSelector::PSEUDO_ELEMENT, currentToken()->content());
+        const auto pseudo_element = createElement<CssSelector>(CssSelector::PSEUDO_ELEMENT, currentToken()->content());
 
         m_tmp_result_stack.emplace(pseudo_element);
         advance();
@@ -638,8 +763,8 @@ parseAtRuleCharset()
 
             if (currentToken()->isStringLiteral()) {
                 if (m_stylesheet->elements().empty()) {
-                    const auto at_rule_charset = make_shared<CssAtRule>(at_keyword_charset);
-                    const auto css_string = make_shared<CssString>(currentToken()->content());
+                    const auto at_rule_charset = createElement<CssAtRule>(at_keyword_charset);
+                    const auto css_string = createElement<CssString>(currentToken()->content());
 
                     at_rule_charset->appendExpression(css_string);
                     m_tmp_result_stack.emplace(at_rule_charset);
@@ -662,8 +787,8 @@ parseAtRuleDocument()
     for (const auto &vendor_prefix : m_vendor.prefixes) {
         const auto at_keyword_document = vendor_prefix + "document";
         if (currentToken()->isAtKeyword(at_keyword_document) && lookAhead()) {
-            const auto at_rule_document = make_shared<CssAtRule>(at_keyword_document);
-            const auto at_rule_block = make_shared<CssBlock>(CssBlock::CURLY);
+            const auto at_rule_document = createElement<CssAtRule>(at_keyword_document);
+            const auto at_rule_block = createElement<CssBlock>(CssBlock::CURLY);
 
             if (currentToken()->isIdentifier() && nextToken()->isPunctuator('(')) {
                 if (parseFunction()) {
@@ -702,7 +827,7 @@ parseAtRuleImport()
         const auto at_keyword_import = vendor_prefix + "import";
 
         if (currentToken()->isAtKeyword(at_keyword_import) && lookAhead()) {
-            const auto at_rule_import = make_shared<CssAtRule>(at_keyword_import);
+            const auto at_rule_import = createElement<CssAtRule>(at_keyword_import);
 
             while (parseFunctionSupports() || parseValue() || parseParenBlock()) {
                 at_rule_import->appendExpression(m_tmp_result_stack.top());
@@ -733,7 +858,7 @@ parseAtRuleNamespace()
         const auto at_keyword_namespace = vendor_prefix + "namespace";
 
         if (currentToken()->isAtKeyword(at_keyword_namespace) && lookAhead()) {
-            const auto at_rule_namespace = make_shared<CssAtRule>(at_keyword_namespace);
+            const auto at_rule_namespace = createElement<CssAtRule>(at_keyword_namespace);
 
             while (parseFunction() || parseValue()) {
                 at_rule_namespace->appendExpression(m_tmp_result_stack.top());
@@ -757,8 +882,8 @@ parseAtRuleFontface()
         const auto at_keyword_fontface = vendor_prefix + "font-face";
         if (currentToken()->isAtKeyword(at_keyword_fontface) && lookAhead() &&
             currentToken()->isPunctuator('{') && lookAhead()) {
-            const auto at_rule_font_face = make_shared<CssAtRule>(at_keyword_fontface);
-            const auto at_rule_block = make_shared<CssBlock>(CssBlock::CURLY);
+            const auto at_rule_font_face = createElement<CssAtRule>(at_keyword_fontface);
+            const auto at_rule_block = createElement<CssBlock>(CssBlock::CURLY);
 
             if (parseDeclaration()) {
                 do {
@@ -786,8 +911,8 @@ parseAtRuleMedia()
         const auto at_keyword_media = vendor_prefix + "media";
 
         if (currentToken()->isAtKeyword(at_keyword_media) && lookAhead()) {
-            const auto at_rule_media = make_shared<CssAtRule>(at_keyword_media);
-            const auto at_rule_block = make_shared<CssBlock>(CssBlock::CURLY);
+            const auto at_rule_media = createElement<CssAtRule>(at_keyword_media);
+            const auto at_rule_block = createElement<CssBlock>(CssBlock::CURLY);
 
             while (parseValue() || parseParenBlock() || parseComment()) {
                 at_rule_media->appendExpression(m_tmp_result_stack.top());
@@ -825,7 +950,7 @@ parseAtRulePage()
         const auto at_keyword_page = vendor_prefix + "page";
 
         if (currentToken()->isAtKeyword(at_keyword_page) && lookAhead()) {
-            const auto at_rule_page = make_shared<CssAtRule>(at_keyword_page);
+            const auto at_rule_page = createElement<CssAtRule>(at_keyword_page);
 
             if (currentToken()->isPunctuator('{')) {
                 if (parseCurlyBlock()) {
@@ -838,7 +963,7 @@ parseAtRulePage()
 
                 lookAhead();
 
-                const auto at_rule_block = make_shared<CssBlock>(CssBlock::CURLY);
+                const auto at_rule_block = createElement<CssBlock>(CssBlock::CURLY);
 
                 while (parseAtRule() || parseQualifiedRule()) {
                     at_rule_block->appendElement(m_tmp_result_stack.top());
@@ -868,8 +993,8 @@ parseAtRuleSupports()
         const auto at_keyword_supports = vendor_prefix + "supports";
 
         if (currentToken()->isAtKeyword(at_keyword_supports) && lookAhead()) {
-            const auto at_rule_supports = make_shared<CssAtRule>(at_keyword_supports);
-            const auto at_rule_block = make_shared<CssBlock>(CssBlock::CURLY);
+            const auto at_rule_supports = createElement<CssAtRule>(at_keyword_supports);
+            const auto at_rule_block = createElement<CssBlock>(CssBlock::CURLY);
 
             while (parseValue() || parseParenBlock()) {
                 at_rule_supports->appendExpression(m_tmp_result_stack.top());
@@ -911,8 +1036,8 @@ parseAtRuleCounterStyle()
             const auto at_keyword_counter_style = vendor_prefix + "counter-style";
 
             if (currentToken()->isAtKeyword(at_keyword_counter_style) && lookAhead()) {
-                const auto at_rule_counter_style = make_shared<CssAtRule>(at_keyword_counter_style);
-                const auto at_rule_block = make_shared<CssBlock>(CssBlock::CURLY);
+                const auto at_rule_counter_style = createElement<CssAtRule>(at_keyword_counter_style);
+                const auto at_rule_block = createElement<CssBlock>(CssBlock::CURLY);
 
                 while (parseValue() || parseParenBlock()) {
                     at_rule_counter_style->appendExpression(m_tmp_result_stack.top());
@@ -952,8 +1077,8 @@ parseAtRuleKeyframes()
         const auto at_keyword_keyframes = vendor_prefix + "keyframes";
 
         if (currentToken()->isAtKeyword(at_keyword_keyframes) && lookAhead()) {
-            const auto at_rule_keyframes = make_shared<CssAtRule>(at_keyword_keyframes);
-            const auto at_rule_block = make_shared<CssBlock>(CssBlock::CURLY);
+            const auto at_rule_keyframes = createElement<CssAtRule>(at_keyword_keyframes);
+            const auto at_rule_block = createElement<CssBlock>(CssBlock::CURLY);
 
             if (parseValue()) {
                 at_rule_keyframes->appendExpression(m_tmp_result_stack.top());
@@ -962,14 +1087,14 @@ parseAtRuleKeyframes()
 
                 if (currentToken()->isPunctuator('{') && lookAhead()) {
                     while (true) {
-                        const auto rule = make_shared<CssQualifiedRule>();
+                        const auto rule = createElement<CssQualifiedRule>();
                         do {
                             if (currentToken()->hasContent({ "from", "to" })) {
-                                const auto selector = make_shared<CssSelector>(CssSelector::KEYFRAMES, currentToken()->content());
+                                const auto selector = createElement<CssSelector>(CssSelector::KEYFRAMES, currentToken()->content());
                                 rule->appendSelector(selector); lookAhead();
                             } else if (currentToken()->isNumericLiteral() &&
                                        nextToken()->hasContent("%")) {
-                                const auto selector = make_shared<CssSelector>(CssSelector::KEYFRAMES, currentToken()->content() + "%");
+                                const auto selector = createElement<CssSelector>(CssSelector::KEYFRAMES, currentToken()->content() + "%");
                                 rule->appendSelector(selector); advance(); lookAhead();
                             }
                         } while (currentToken()->isPunctuator(',') && lookAhead());
@@ -1011,7 +1136,7 @@ parseAtRuleViewport()
         const auto at_keyword_viewport = vendor_prefix + "viewport";
 
         if (currentToken()->isAtKeyword(at_keyword_viewport) && lookAhead()) {
-            const auto at_rule_viewport = make_shared<CssAtRule>(at_keyword_viewport);
+            const auto at_rule_viewport = createElement<CssAtRule>(at_keyword_viewport);
 
             if (currentToken()->isPunctuator('{') && parseCurlyBlock()) {
                 at_rule_viewport->setBlock(m_tmp_result_stack.top());
@@ -1037,9 +1162,9 @@ parseDeclaration()
 
         if (currentToken()->isIdentifier() && currentToken()->content().substr(0, 2) == "--") {
             const auto custom_property_name = currentToken()->content().substr(2);
-            const auto custom_property = make_shared<CssCustomProperty>(custom_property_name);
+            const auto custom_property = createElement<CssCustomProperty>(custom_property_name);
 
-            declaration = make_shared<CssDeclaration>(custom_property);
+            declaration = createElement<CssDeclaration>(custom_property);
         } else {
             // IE <= 7 hack
             auto ie_hack = false;
@@ -1049,7 +1174,7 @@ parseDeclaration()
 
             const auto property_name = (ie_hack ? "*" : "") + currentToken()->content();
 
-            declaration = make_shared<CssDeclaration>(property_name);
+            declaration = createElement<CssDeclaration>(property_name);
         }
 
         lookAhead();
@@ -1098,7 +1223,7 @@ parseDeclaration()
                             content += currentToken()->content(); advance();
                         }
 
-                        const auto css_string = make_shared<CssString>(content, true);
+                        const auto css_string = createElement<CssString>(content, true);
                         declaration->values()[0].clear();
                         declaration->values()[0].emplace_back(css_string);
                     }
@@ -1188,7 +1313,7 @@ parseFunction()
 
         if (parseMathFunction() || parseFunctionAlphaIE()) return true;
 
-        const auto function = make_shared<CssFunction>(currentToken()->content());
+        const auto function = createElement<CssFunction>(currentToken()->content());
         function->setInitialPosition(currentToken()->row(), currentToken()->column());
         advance(+2) && currentToken()->isWhiteSpace() && lookAhead();
 
@@ -1225,7 +1350,7 @@ parseValue()
 
         if (currentToken()->content().substr(0, 2) == "--") {
             const auto custom_property_name = currentToken()->content().substr(2);
-            const auto custom_property = make_shared<CssCustomProperty>(custom_property_name);
+            const auto custom_property = createElement<CssCustomProperty>(custom_property_name);
             custom_property->setInitialPosition(currentToken()->row(), currentToken()->column());
             m_tmp_result_stack.emplace(custom_property);
             lookAhead();
@@ -1233,7 +1358,7 @@ parseValue()
         }
 
         if (currentToken()->content() == "transparent" || isPredefinedColor(currentToken()->content())) {
-            auto color = make_shared<CssColor>(CssColor::PREDEFINED_NAME, currentToken()->content());
+            auto color = createElement<CssColor>(CssColor::PREDEFINED_NAME, currentToken()->content());
             color->setInitialPosition(currentToken()->row(), currentToken()->column());
 
             m_tmp_result_stack.emplace(color);
@@ -1242,7 +1367,7 @@ parseValue()
             return true;
         }
 
-        const auto identifier = make_shared<CssIdentifier>(currentToken()->content());
+        const auto identifier = createElement<CssIdentifier>(currentToken()->content());
 
         identifier->setInitialPosition(currentToken()->row(), currentToken()->column());
         m_tmp_result_stack.emplace(identifier);
@@ -1252,7 +1377,7 @@ parseValue()
     case CssToken::NUMERIC_LITERAL:
         return parseNumber();
     case CssToken::STRING_LITERAL: {
-        const auto string = make_shared<CssString>(currentToken()->content());
+        const auto string = createElement<CssString>(currentToken()->content());
         string->setInitialPosition(currentToken()->row(), currentToken()->column());
         m_tmp_result_stack.emplace(string);
         lookAhead();
@@ -1262,7 +1387,7 @@ parseValue()
         if (!isValidHexColor(currentToken()->content()))
             throwParseError("Invalid hex color: '#" + currentToken()->content() + "'");
 
-        const auto hex_color = make_shared<CssColor>(CssColor::HEX_LITERAL, String::toLower(currentToken()->content()));
+        const auto hex_color = createElement<CssColor>(CssColor::HEX_LITERAL, String::toLower(currentToken()->content()));
         hex_color->setInitialPosition(currentToken()->row(), currentToken()->column());
         m_tmp_result_stack.emplace(hex_color);
 
@@ -1270,7 +1395,7 @@ parseValue()
         return true;
     }
     case CssToken::UNICODE_RANGE: {
-        const auto unicode_range = make_shared<CssUnicodeRange>(currentToken()->content());
+        const auto unicode_range = createElement<CssUnicodeRange>(currentToken()->content());
         unicode_range->setInitialPosition(currentToken()->row(), currentToken()->column());
         m_tmp_result_stack.emplace(unicode_range);
         lookAhead();
@@ -1281,7 +1406,7 @@ parseValue()
             return true;
 
         if (currentToken()->isPunctuator({'+', '-', '*', '/'})) {
-            const auto delimiter = make_shared<CssDelimiter>(currentToken()->content());
+            const auto delimiter = createElement<CssDelimiter>(currentToken()->content());
             delimiter->setInitialPosition(currentToken()->row(), currentToken()->column());
             m_tmp_result_stack.emplace(delimiter);
             lookAhead();
@@ -1312,7 +1437,7 @@ parseNumber()
         row = currentToken()->row(),
         column = currentToken()->column();
 
-        const auto number_element = make_shared<CssNumber>(currentToken()->content());
+        const auto number_element = createElement<CssNumber>(currentToken()->content());
         number_element->setInitialPosition(row, column);
         number_element->setNegativeFlag(negative_number);
         advance();
@@ -1323,7 +1448,7 @@ parseNumber()
         }
 
         if (currentToken()->isUnit()) {
-            auto dimension_element = make_shared<CssDimension>(move(*number_element));
+            auto dimension_element = createElement<CssDimension>(move(*number_element));
             dimension_element->setUnit(currentToken()->content());
             dimension_element->setNegativeFlag(negative_number);
             dimension_element->setInitialPosition(row, column);
@@ -1333,7 +1458,7 @@ parseNumber()
             lookAhead();
         }
         else if (currentToken()->isPunctuator('%')) {
-            auto percentage_element = make_shared<CssPercentage>(move(*number_element));
+            auto percentage_element = createElement<CssPercentage>(move(*number_element));
             percentage_element->setNegativeFlag(negative_number);
             percentage_element->setInitialPosition(row, column);
 
@@ -1358,7 +1483,7 @@ parseFunctionSupports()
 {
     if (currentToken()->isIdentifier() && currentToken()->content() == "supports" &&
         nextToken()->isPunctuator('(') && advance(+2)) {
-        const auto supports_condition = make_shared<CssSupportsCondition>();
+        const auto supports_condition = createElement<CssSupportsCondition>();
 
         if (parseDeclaration()) {
             supports_condition->appendCondition(m_tmp_result_stack.top());
@@ -1383,7 +1508,7 @@ parseMathFunction()
     if (currentToken()->isIdentifier({"calc", "min", "max", "clamp"}) &&
         nextToken()->isPunctuator('(')) {
 
-        const auto function = make_shared<CssFunction>(currentToken()->content());
+        const auto function = createElement<CssFunction>(currentToken()->content());
         advance() && lookAhead();
         uint8_t paren_counter = 1;
 
@@ -1412,7 +1537,7 @@ parseMathFunction()
                     else if (currentToken()->content().front() == ')')
                         if (!bool(--paren_counter)) break;
 
-                    const auto punctuator = make_shared<CssDelimiter>(currentToken()->content());
+                    const auto punctuator = createElement<CssDelimiter>(currentToken()->content());
                     m_tmp_list.top().emplace_back(punctuator); lookAhead();
 
                     continue;
@@ -1425,7 +1550,7 @@ parseMathFunction()
             }
             else if (currentToken()->isNumericLiteral()) {
                 if (nextToken()->isUnit() || nextToken()->isPunctuator('%')) {
-                    const auto dimension = make_shared<CssDimension>(
+                    const auto dimension = createElement<CssDimension>(
                                 currentToken()->content(), nextToken()->content());
 
                     advance() && lookAhead();
@@ -1434,7 +1559,7 @@ parseMathFunction()
                     continue;
                 }
 
-                const auto number = make_shared<CssNumber>(currentToken()->content());
+                const auto number = createElement<CssNumber>(currentToken()->content());
                 m_tmp_list.top().emplace_back(number);
                 lookAhead();
 
@@ -1477,8 +1602,8 @@ parseFunctionAlphaIE()
         }
 
         if (currentToken()->isPunctuator(')') && lookAhead()) {
-            const auto function_alpha_ie = make_shared<CssFunction>("alpha");
-            const auto css_string = make_shared<CssString>(move(content), true);
+            const auto function_alpha_ie = createElement<CssFunction>("alpha");
+            const auto css_string = createElement<CssString>(move(content), true);
             function_alpha_ie->appendParameter({css_string});
 
             m_tmp_result_stack.emplace(function_alpha_ie);
@@ -1528,20 +1653,22 @@ void
 CssParser::
 throwParseError(const string &message) const
 {
-    cout << NEWLINE "[CSS PARSER]" NEWLINE;
+    ostringstream report;
+
+    report << NEWLINE "[CSS PARSER]" NEWLINE;
 
     if (!currentToken()->isEof()) {
-        cout << "Parse error: Unexpected token "
+        report << "Parse error: Unexpected token "
              << (currentToken()->isWhiteSpace() ? "<whitespace>" : "'");
 
         // This is needed because '@' is not part of the at rule token content
         // and '#' also is not part of the hash token.
         if (currentToken()->isAtKeyword())
-            cout << '@';
+            report << '@';
         else if (currentToken()->isHashLiteral())
-            cout << '#';
+            report << '#';
 
-        cout << (currentToken()->isWhiteSpace() ? "" : currentToken()->content() + "'")
+        report << (currentToken()->isWhiteSpace() ? "" : currentToken()->content() + "'")
              << " on row "
              << currentToken()->row()
              << " column "
@@ -1552,7 +1679,7 @@ throwParseError(const string &message) const
              << NEWLINE
              << endl;
     } else {
-        cout << "Parse error on row "
+        report << "Parse error on row "
              << currentToken()->row()
              << " column "
              << currentToken()->column()
@@ -1563,5 +1690,6 @@ throwParseError(const string &message) const
              << endl;
     }
 
-    exit(1);
+    // Segments parsed on worker threads hand the error to the calling thread
+    SyntaxError::raise(report.str());
 }
@@ -20,12 +20,21 @@ along with this program. If not, see <https://www.gnu.org/licenses/>.
 #ifndef CSSPARSER_H
 #define CSSPARSER_H
 #include "../../general/parser/GeneralParser.h"
+#include "../../MemoryArena.h"
+#include "../../Parallel.h"
+#include "../../Statistics.h"
+#include "../../SyntaxError.h"
 #include "../CssVendorPrefixes.h"
 #include "../modifier/CssColorTable.h"
 #include "../tokenizer/CssTokenizer.h"
 #include "../tokenizer/elements/CssToken.h"
+#include "CssTreeWalker.h"
 #include "includes.h"
+#include <array>
+#include <atomic>
+#include <climits>
 #include <functional>
+#include <sstream>
 #include <stack>
 
 namespace CSS {
@@ -45,6 +54,7 @@ public:
     static const StyleSheetPtr
     parse(const shared_ptr<string> &content, const string &file_name = string()),
     parse(const string &content, const string &file_name = string(), const uint32_t begin_row = 1, const uint32_t begin_column = 1),
+    parse(const GeneralTokenStreamPtr &token_stream, const string &file_name = string()),
     parseStyleAttribute(const string &content, const uint32_t begin_row = 1, const uint32_t begin_column = 1);
 
     [[noreturn]] void
@@ -60,12 +70,29 @@ private:
     lookAhead(),
     lookBehind();
 
+    template<class T, class ...Args>
+    inline shared_ptr<T>
+    createElement(Args &&...args);
+
     const StyleSheetPtr
     parse();
 
     const StyleSheetPtr
     parseStyleAttribute();
 
+    static const StyleSheetPtr
+    parseSegments(const string &content, const DataContainer<CssTokenizer::Segment> &segments, const string &file_name);
+
+    static void
+    // Add counters to the statistics
+    countTokens(const GeneralTokenStream &token_stream),
+    countElements(const StyleSheetPtr &stylesheet);
+
+#ifdef HSPP_ALLOC_STATS
+    void
+    countElementBytes() const;
+#endif
+
     const string
     parseSelectorAnPlusB();
 
@@ -113,6 +140,15 @@ private:
     isPredefinedColor(const string &identifier),
     isValidHexColor(const string &hex_color_literal);
 
+    // AST nodes are allocated from the arena in document order, so that
+    // the passes running over the tree walk through consecutive memory
+    const MemoryArenaPtr m_arena;
+
+#ifdef HSPP_ALLOC_STATS
+    // Bytes allocated in the arena and on the heap for the nodes of each type
+    array<uint64_t, UCHAR_MAX + 1> m_element_bytes {};
+#endif
+
     StyleSheetPtr m_stylesheet;
     stack<CssBaseElementPtr> m_tmp_result_stack;
     stack<DataContainer<CssBaseElementPtr> > m_tmp_list;
@@ -165,6 +201,31 @@ lookBehind()
     return true;
 }
 
+template<class T, class ...Args>
+inline shared_ptr<T>
+CssParser::
+createElement(Args &&...args)
+{
+#ifdef HSPP_ALLOC_STATS
+    if (Statistics::isEnabled()) {
+        const uint64_t
+        arena_bytes = m_arena->bytesAllocated(),
+        arena_reserved_bytes = m_arena->bytesReserved(),
+        heap_bytes = Statistics::threadAllocatedBytes();
+
+        const auto element = allocate_shared<T>(ArenaAllocator<T>(m_arena), forward<Args>(args)...);
+
+        // New arena chunks are heap allocations too, but they are not owned by the node
+        m_element_bytes[element->type()] += m_arena->bytesAllocated() - arena_bytes +
+                                            Statistics::threadAllocatedBytes() - heap_bytes -
+                                            (m_arena->bytesReserved() - arena_reserved_bytes);
+        return element;
+    }
+#endif
+
+    return allocate_shared<T>(ArenaAllocator<T>(m_arena), forward<Args>(args)...);
+}
+
 } // namespace Parsing
 } // namespace CSS
 
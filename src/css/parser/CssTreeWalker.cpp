@@ -0,0 +1,208 @@
+/******************************************************************************
+This source file is part of the project
+HyperSheetsPreprocessor (HSPP) - Optimizer and minifier for CSS
+Copyright (C) 2019 Waldemar Zimpel <hspp@utilizer.de>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://www.gnu.org/licenses/>.
+*******************************************************************************/
+
+#include "CssTreeWalker.h"
+using namespace CSS::Parsing;
+
+CssTreeWalker::CssTreeWalker(function<void(const CssBaseElementPtr &element)> callback) :
+    m_callback(move(callback)) {}
+
+void
+CssTreeWalker::
+visit(const CssAtRulePtr &at_rule)
+{
+    m_callback(at_rule);
+
+    if (at_rule->replacementElement()) {
+        at_rule->replacementElement()->accept(*this);
+        return;
+    }
+
+    if (at_rule->expressions())
+        for (const auto &list : *at_rule->expressions())
+            for (const auto &element : *list)
+                element->accept(*this);
+
+    if (at_rule->block())
+        at_rule->block()->accept(*this);
+}
+
+void
+CssTreeWalker::
+visit(const CssBlockPtr &block)
+{
+    m_callback(block);
+
+    for (const auto &element : block->elements())
+        element->accept(*this);
+}
+
+void
+CssTreeWalker::
+visit(const CssDeclarationPtr &declaration)
+{
+    m_callback(declaration);
+
+    declaration->namePtr()->accept(*this);
+
+    for (const auto &list : declaration->values())
+        for (const auto &value : list)
+            value->accept(*this);
+}
+
+void
+CssTreeWalker::
+visit(const CssPercentagePtr &percentage)
+{
+    m_callback(percentage);
+}
+
+void
+CssTreeWalker::
+visit(const CssDimensionPtr &dimension)
+{
+    m_callback(dimension);
+}
+
+void
+CssTreeWalker::
+visit(const CssFunctionPtr &function)
+{
+    m_callback(function);
+
+    for (const auto &list : function->parameters())
+        for (const auto &element : list)
+            element->accept(*this);
+}
+
+void
+CssTreeWalker::
+visit(const CssIdentifierPtr &identifier)
+{
+    m_callback(identifier);
+}
+
+void
+CssTreeWalker::
+visit(const CssCustomPropertyPtr &custom_property)
+{
+    m_callback(custom_property);
+}
+
+void
+CssTreeWalker::
+visit(const CssNumberPtr &number)
+{
+    m_callback(number);
+}
+
+void
+CssTreeWalker::
+visit(const CssColorPtr &color)
+{
+    m_callback(color);
+}
+
+void
+CssTreeWalker::
+visit(const CssQualifiedRulePtr &qualified_rule)
+{
+    m_callback(qualified_rule);
+
+    for (const auto &selector : qualified_rule->selectors())
+        selector->accept(*this);
+
+    if (qualified_rule->block())
+        qualified_rule->block()->accept(*this);
+}
+
+void
+CssTreeWalker::
+visit(const CssStringPtr &string)
+{
+    m_callback(string);
+}
+
+void
+CssTreeWalker::
+visit(const CssSelectorPtr &selector)
+{
+    m_callback(selector);
+
+    if (selector->parentalSelector())
+        selector->parentalSelector()->accept(*this);
+
+    if (selector->subSelectors())
+        for (const auto &sub_selector : *selector->subSelectors())
+            sub_selector->accept(*this);
+}
+
+void
+CssTreeWalker::
+visit(const CssSelectorAttributePtr &attribute_selector)
+{
+    m_callback(attribute_selector);
+
+    if (attribute_selector->parentalSelector())
+        attribute_selector->parentalSelector()->accept(*this);
+}
+
+void
+CssTreeWalker::
+visit(const CssSelectorCombinatorPtr &selector_combinator)
+{
+    m_callback(selector_combinator);
+
+    if (selector_combinator->left())
+        selector_combinator->left()->accept(*this);
+
+    if (selector_combinator->right())
+        selector_combinator->right()->accept(*this);
+}
+
+void
+CssTreeWalker::
+visit(const CssDelimiterPtr &delimiter)
+{
+    m_callback(delimiter);
+}
+
+void
+CssTreeWalker::
+visit(const CssUnicodeRangePtr &unicode_range)
+{
+    m_callback(unicode_range);
+}
+
+void
+CssTreeWalker::
+visit(const CssSupportsConditionPtr &supports_condition)
+{
+    m_callback(supports_condition);
+
+    if (supports_condition->conditionBlock())
+        supports_condition->conditionBlock()->accept(*this);
+}
+
+void
+CssTreeWalker::
+visit(const CssCommentPtr &comment)
+{
+    m_callback(comment);
+}
@@ -0,0 +1,64 @@
+/******************************************************************************
+This source file is part of the project
+HyperSheetsPreprocessor (HSPP) - Optimizer and minifier for CSS
+Copyright (C) 2019 Waldemar Zimpel <hspp@utilizer.de>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://www.gnu.org/licenses/>.
+*******************************************************************************/
+
+#ifndef CSSTREEWALKER_H
+#define CSSTREEWALKER_H
+#include "includes.h"
+#include <functional>
+
+namespace CSS {
+namespace Parsing {
+using namespace CSS::Parsing::Elements;
+
+/// Visits every element of a parse tree and passes it to a callback function
+class CssTreeWalker final : public CssVisitorInterface
+{
+public:
+    explicit
+    CssTreeWalker(function<void(const CssBaseElementPtr &element)> callback);
+
+    void
+    visit(const CssAtRulePtr &)               override,
+    visit(const CssBlockPtr &)                override,
+    visit(const CssDeclarationPtr &)          override,
+    visit(const CssPercentagePtr &)           override,
+    visit(const CssDimensionPtr &)            override,
+    visit(const CssFunctionPtr &)             override,
+    visit(const CssIdentifierPtr &)           override,
+    visit(const CssCustomPropertyPtr &)       override,
+    visit(const CssNumberPtr &)               override,
+    visit(const CssColorPtr &)                override,
+    visit(const CssQualifiedRulePtr &)        override,
+    visit(const CssStringPtr &)               override,
+    visit(const CssSelectorPtr &)             override,
+    visit(const CssSelectorAttributePtr &)    override,
+    visit(const CssSelectorCombinatorPtr &)   override,
+    visit(const CssDelimiterPtr &)            override,
+    visit(const CssUnicodeRangePtr &)         override,
+    visit(const CssSupportsConditionPtr &)    override,
+    visit(const CssCommentPtr &)              override;
+
+private:
+    const function<void(const CssBaseElementPtr &element)> m_callback;
+};
+
+} // namespace Parsing
+} // namespace CSS
+
+#endif // CSSTREEWALKER_H
@@ -20,7 +20,9 @@ along with this program. If not, see <https://www.gnu.org/licenses/>.
 #ifndef CSSBASEELEMENT_H
 #define CSSBASEELEMENT_H
 #include "../../../general/visitor/VisitorInterface.h"
+#include <initializer_list>
 #include <memory>
+#include <string>
 
 #ifndef NDEBUG
 #include <iostream>
@@ -92,6 +94,9 @@ public:
     inline ElementType
     type() const;
 
+    static inline const char *
+    typeName(const ElementType type);
+
     inline bool
 	isOfType(const ElementType element_type),
     isOfType(const initializer_list<ElementType> candidates),
@@ -143,6 +148,20 @@ type() const -> ElementType
     return m_type;
 }
 
+/*static*/ inline const char *
+CssBaseElement::
+typeName(const ElementType type)
+{
+    static const char *const names[] = {
+        "SELECTOR", "SELECTOR_COMBINATOR", "BLOCK", "IDENTIFIER", "COLOR", "NUMBER",
+        "STRING", "AT_RULE", "QUALIFIED_RULE", "SUPPORTS_CONDITION", "DECLARATION",
+        "FUNCTION", "PERCENTAGE", "DIMENSION", "DELIMITER", "COMMENT", "UNICODE_RANGE",
+        "CUSTOM_PROPERTY"
+    };
+
+    return names[type];
+}
+
 inline bool
 CssBaseElement::
 isOfType(const ElementType element_type)
@@ -18,6 +18,7 @@ along with this program. If not, see <https://www.gnu.org/licenses/>.
 ******************************************************************************/
 
 #include "CssTokenizer.h"
+#include "../CssPassManager.h"
 using namespace CSS::Tokenization;
 
 CssTokenizer::CssTokenizer(const shared_ptr<string> &content) :
@@ -30,6 +31,8 @@ const GeneralTokenStreamPtr
 CssTokenizer::
 tokenize()
 {
+    Statistics::PhaseTimer tokenize_timer(Statistics::TOKENIZE);
+
     // Recognize character encoding
     // If no @charset rule is available, UTF-8 encoding is used
     if (byteStream()->substr(0, 8) == "@charset") {
@@ -99,6 +102,161 @@ tokenize(const string &content, const uint32_t begin_row, const uint32_t begin_c
     return CssTokenizer(content, begin_row, begin_column).tokenize();
 }
 
+/*static*/ const DataContainer<CssTokenizer::Segment>
+CssTokenizer::
+splitTopLevelRules(const string &content, const uint64_t min_segment_size)
+{
+    // Splits the stylesheet after top-level rules into segments which can be
+    // tokenized and parsed independently. Strings, comments, escape sequences
+    // and unquoted URLs are skipped the same way the tokenizer reads them,
+    // and row and column are counted the same way as well, so that every
+    // segment reports the correct position on errors.
+
+    DataContainer<Segment> segments;
+    const auto length = content.length();
+
+    // Stylesheets with a character encoding other than UTF-8 are not split
+    if (content.compare(0, 8, "@charset") == 0) {
+        const auto begin = content.find_first_of("\"'", 8);
+
+        if (begin == string::npos || begin + 6 >= length ||
+            String::toLower(content.substr(begin + 1, 5)) != "utf-8" ||
+            content[begin + 6] != content[begin]) {
+            segments.push_back({0, length, 1, 1});
+            return segments;
+        }
+    }
+
+    string::size_type pos = 0;
+    uint32_t row = 1, column = 1;
+    uint64_t block_depth = 0, paren_depth = 0;
+
+    const auto advance = [&]() {
+        const auto c = content[pos];
+
+        if (c == '\n') {
+            ++row; column = 1; ++pos;
+            return;
+        }
+
+        if (c == '\t') {
+            column += cfg.tabWidth(); ++pos;
+            return;
+        }
+
+        uint8_t char_count = 0;
+
+        if ((c & 0xf0) == 0xf0)
+            char_count = 4;
+        else if ((c & 0xe0) == 0xe0 && (c & 0x10) != 0x10)
+            char_count = 3;
+        else if ((c & 0xc0) == 0xc0 && (c & 0x20) != 0x20)
+            char_count = 2;
+
+        if (bool(char_count)) {
+            auto end = pos;
+
+            while (end < length && end != pos + char_count && content[end] < 0) ++end;
+
+            if (end == length || end == pos + char_count) {
+                ++column; pos = end;
+                return;
+            }
+        }
+
+        ++column; ++pos;
+    };
+
+    const auto isIdentifierChar = [](const char c) -> bool {
+        return bool(isalnum(c)) || c == '-' || c == '_' || c == '\\' || c == '#' || c < 0;
+    };
+
+    // An @charset rule is only accepted at the beginning of a stylesheet,
+    // so a segment must not start with one
+    const auto isCharsetAhead = [&]() -> bool {
+        auto next = pos;
+
+        while (next < length) {
+            if (bool(isspace(content[next])))
+                ++next;
+            else if (content.compare(next, 2, "/*") == 0) {
+                next = content.find("*/", next + 2);
+                next = next == string::npos ? length : next + 2;
+            } else break;
+        }
+
+        return content.compare(next, 8, "@charset") == 0;
+    };
+
+    Segment segment {0, 0, 1, 1};
+
+    while (pos < length) {
+        const auto c = content[pos];
+
+        if (c == '/' && pos + 1 < length && content[pos + 1] == '*') {
+            advance(); advance();
+            while (pos + 1 < length && !(content[pos] == '*' && content[pos + 1] == '/')) advance();
+
+            if (pos + 1 < length) {
+                advance(); advance();
+            }
+
+            continue;
+        }
+
+        if (c == '"' || c == '\'') {
+            do advance(); while (pos < length && content[pos] != c);
+
+            if (pos < length) advance();
+
+            continue;
+        }
+
+        if (c == '\\') {
+            advance();
+
+            if (pos < length) advance();
+
+            continue;
+        }
+
+        if (c == 'u' && content.compare(pos, 4, "url(") == 0 &&
+            (pos == 0 || !isIdentifierChar(content[pos - 1]))) {
+            for (uint8_t i = 0; i < 4; ++i) advance();
+            while (pos < length && bool(isspace(content[pos]))) advance();
+
+            if (pos < length && content[pos] != '"' && content[pos] != '\'') {
+                do advance(); while (pos < length && content[pos] != ')');
+
+                if (pos < length) advance();
+            } else ++paren_depth;
+
+            continue;
+        }
+
+        advance();
+
+        switch (c) {
+        case '{': ++block_depth; break;
+        case '}': if (block_depth > 0) --block_depth; break;
+        case '(': ++paren_depth; break;
+        case ')': if (paren_depth > 0) --paren_depth; break;
+        }
+
+        if ((c == '}' || c == ';') && block_depth == 0 && paren_depth == 0 &&
+            pos - segment.begin >= min_segment_size && pos < length && !isCharsetAhead()) {
+            segment.end = pos;
+            segments.push_back(segment);
+            segment = {pos, 0, row, column};
+        }
+    }
+
+    segment.end = length;
+    segments.push_back(segment);
+
+    return segments;
+}
+
 inline bool
 CssTokenizer::
 isWhiteSpace()
@@ -316,6 +474,9 @@ isComment()
 
                 const auto comment_token = make_shared<CssToken>(comment_type, comment_content);
                 appendToken(comment_token, currentRow(), start_column);
+            } else if (CssPassManager::isCountingBytes()) {
+                // The comment and its delimiters
+                CssPassManager::addSavedBytes(CssPassManager::REMOVE_COMMENTS, int64_t(comment_content.length()) + 4);
             }
 
             advance(+2);
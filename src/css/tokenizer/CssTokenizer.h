@@ -21,6 +21,7 @@ along with this program. If not, see <https://www.gnu.org/licenses/>.
 #define CSSTOKENIZER_H
 #include "../../config/Config.h"
 #include "../../general/tokenizer/GeneralTokenizer.h"
+#include "../../Statistics.h"
 #include "elements/CssToken.h"
 
 namespace CSS {
@@ -31,6 +32,13 @@ using namespace Tokens;
 class CssTokenizer : public GeneralTokenizer
 {
 public:
+    /// Part of a stylesheet which consists of complete top-level rules only
+    struct Segment
+    {
+        string::size_type begin, end;
+        uint32_t begin_row, begin_column;
+    };
+
     explicit
     CssTokenizer(const shared_ptr<string> &content),
     CssTokenizer(const string &content, const uint32_t begin_row = 1, const uint32_t begin_column = 1);
@@ -39,6 +47,9 @@ public:
     tokenize(const shared_ptr<string> &content),
     tokenize(const string &content, const uint32_t begin_row = 1, const uint32_t begin_column = 1);
 
+    static const DataContainer<Segment>
+    splitTopLevelRules(const string &content, const uint64_t min_segment_size);
+
 private:
     inline const GeneralTokenStreamPtr
     tokenize();
@@ -66,6 +66,9 @@ public:
     inline CssTokenType
     type() const;
 
+    static inline const char *
+    typeName(const CssTokenType type);
+
 private:
     CssTokenType m_type;
 };
@@ -84,6 +87,19 @@ type() const -> CssTokenType
     return m_type;
 }
 
+/*static*/ inline const char *
+CssToken::
+typeName(const CssTokenType type)
+{
+    static const char *const names[] = {
+        "WHITESPACE", "PUNCTUATOR", "IDENTIFIER", "AT_KEYWORD", "STRING_LITERAL", "HASH_LITERAL",
+        "NUMERIC_LITERAL", "SCIENTIFIC_LITERAL", "UNIT", "COMMENT", "CDATA_START_COMMENT",
+        "CDATA_END_COMMENT", "UNICODE_RANGE", "ESCAPE", "EOF"
+    };
+
+    return names[type];
+}
+
 inline bool
 CssToken::
 isPunctuator() const
@@ -116,8 +116,16 @@ processFile(const string &input_path, const string &output_path)
     auto file_content = make_shared<string>();
 
     if (hasFileExtensionOf(input_path, cfg.cssFileExtensions())) {
-        if (FileSystem::readFile(input_path, *file_content)) {
+        Statistics::beginFile(input_path);
+
+        Statistics::PhaseTimer read_timer(Statistics::READ);
+        const bool is_read = FileSystem::readFile(input_path, *file_content);
+        read_timer.stop();
+
+        if (is_read) {
             const auto input_size = file_content->length();
+            Statistics::addBytesIn(input_size);
+
             // Set buffer to minified version of file content
             file_content = CssMinifier::minify(file_content);
 
@@ -127,11 +135,18 @@ processFile(const string &input_path, const string &output_path)
         }
     } else return false;
 
+    Statistics::PhaseTimer write_timer(Statistics::WRITE);
+
     if (cfg.isEnabled(Config::GENERAL__OUTPUT_TO_STDO))
         Console::writeLine(*file_content);
     else
         writeFile(output_path, *file_content);
 
+    write_timer.stop();
+
+    Statistics::addBytesOut(file_content->length());
+    Statistics::endFile();
+
     return true;
 }
 
@@ -20,6 +20,7 @@ along with this program. If not, see <https://www.gnu.org/licenses/>.
 #ifndef MINIFIER_H
 #define MINIFIER_H
 #include <memory>
+#include <string>
 
 namespace General {
 namespace Minification {
@@ -189,7 +189,9 @@ void
 GeneralTokenizer::
 throwSyntaxError(const string &message)
 {
-    cout << "Syntax error: Unexpected character '"
+    ostringstream report;
+
+    report << "Syntax error: Unexpected character '"
          << currentChar()
          << "' on row "
          << m_row
@@ -199,5 +201,5 @@ throwSyntaxError(const string &message)
          << message
          << endl;
 
-    exit(1);
+    SyntaxError::raise(report.str());
 }
@@ -20,9 +20,11 @@ along with this program. If not, see <https://www.gnu.org/licenses/>.
 #ifndef GENERALTOKENIZER_H
 #define GENERALTOKENIZER_H
 #include "../../String.h"
+#include "../../SyntaxError.h"
 #include "../../config/Config.h"
 #include "elements/GeneralToken.h"
 #include <memory>
+#include <sstream>
 
 namespace General {
 namespace Tokenization {
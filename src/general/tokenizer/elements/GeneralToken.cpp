@@ -21,7 +21,7 @@ along with this program. If not, see <https://www.gnu.org/licenses/>.
 using namespace General::Tokenization::Tokens;
 
 GeneralToken::GeneralToken(const char c) :
-    m_content(&c) {}
+    m_content(1, c) {}
 
 GeneralToken::GeneralToken(string content) :
     m_content(move(content)) {}
@@ -19,7 +19,9 @@ along with this program. If not, see <https://www.gnu.org/licenses/>.
 
 #ifndef GENERALTOKEN_H
 #define GENERALTOKEN_H
+#include <initializer_list>
 #include <memory>
+#include <string>
 
 #ifdef EOF
 #undef EOF
@@ -24,6 +24,7 @@ Config cfg;
 using namespace std::chrono;
 
 static DataContainer<pair<const string, const string> > arg_pair_list;
+static string trace_file_path, size_report_path, selector_report_path;
 
 int main(int argc, char **argv)
 {
@@ -82,14 +83,48 @@ int main(int argc, char **argv)
 
         high_resolution_clock::time_point t1, t2;
 
-        if (!cfg.isEnabled(Config::GENERAL__OUTPUT_TO_STDO))
-            t1 = high_resolution_clock::now();
+        t1 = high_resolution_clock::now();
 
         FileSystemWorker::process();
 
-        if (!cfg.isEnabled(Config::GENERAL__OUTPUT_TO_STDO)) {
-            t2 = high_resolution_clock::now();
+        t2 = high_resolution_clock::now();
+
+        if (Statistics::isEnabled())
+            Statistics::writeReport(cfg.isEnabled(Config::GENERAL__OUTPUT_TO_STDO) ? cerr : cout,
+                                    uint64_t(duration_cast<microseconds>(t2 - t1).count()));
+
+        if (!trace_file_path.empty()) {
+            ostringstream trace;
+            Statistics::writeTrace(trace);
+
+            !FileSystem::writeFile(trace_file_path, trace.str()) &&
+                RETURN("Couldn't write the trace file " + trace_file_path);
+        }
+
+        if (CSS::CssSizeReport::isEnabled()) {
+            ostringstream size_report;
+            CSS::CssSizeReport::writeJson(size_report);
+
+            !FileSystem::writeFile(size_report_path, size_report.str()) &&
+                RETURN("Couldn't write the size report " + size_report_path);
+
+            CSS::CssSizeReport::writeSummary(cfg.isEnabled(Config::GENERAL__OUTPUT_TO_STDO) ? cerr : cout);
+        }
+
+        if (CSS::CssPassManager::isReportEnabled())
+            CSS::CssPassManager::writeReport(cfg.isEnabled(Config::GENERAL__OUTPUT_TO_STDO) ? cerr : cout);
+
+        if (CSS::CssSelectorReport::isEnabled()) {
+            ostringstream selector_report;
+            CSS::CssSelectorReport::writeJson(selector_report);
+
+            !FileSystem::writeFile(selector_report_path, selector_report.str()) &&
+                RETURN("Couldn't write the selector report " + selector_report_path);
 
+            CSS::CssSelectorReport::writeSummary(cfg.isEnabled(Config::GENERAL__OUTPUT_TO_STDO) ? cerr : cout);
+        }
+
+        if (!cfg.isEnabled(Config::GENERAL__OUTPUT_TO_STDO)) {
             auto duration = duration_cast<microseconds>(t2 - t1).count();
             string time_unit = TIME_UNIT;
 
@@ -143,7 +178,8 @@ bool parseArguments(DataContainer<string> &args, DataContainer<pair<const string
 bool isSupportedArgument(const string &arg)
 {
     const initializer_list<const string> supported_arg_list
-            = {"-i", "-o", "--help", "--create-config-file", "--config-info", "--config-file", "--stdo"};
+            = {"-i", "-o", "--help", "--create-config-file", "--config-info", "--config-file", "--stdo", "--stats", "--trace-file", "--size-report", "--selector-report",
+               "-O", "--passes", "--pass-budget", "--fixpoint"};
 
     return find(supported_arg_list.begin(),
            supported_arg_list.end(),
@@ -178,6 +214,74 @@ void prepare(DataContainer<pair<const string, const string> > &args)
         cfg.enable(Config::GENERAL__OUTPUT_TO_STDO);
     }
 
+    if (isSet("--stats")) {
+        !(attrVal("--stats").empty() || attrVal("--stats") == "json") &&
+            RETURN("Expected either nothing or 'json' after argument '--stats'");
+
+        Statistics::enable(attrVal("--stats") == "json");
+    }
+
+    if (isSet("--trace-file")) {
+        trace_file_path = attrVal("--trace-file");
+
+        (trace_file_path.empty() || !FileSystem::isAbsolutePath(trace_file_path)) &&
+            RETURN("Expected absolute file path after argument '--trace-file'");
+
+        Statistics::enableTrace();
+    }
+
+    if (isSet("--size-report")) {
+        size_report_path = attrVal("--size-report");
+
+        (size_report_path.empty() || !FileSystem::isAbsolutePath(size_report_path)) &&
+            RETURN("Expected absolute file path after argument '--size-report'");
+
+        CSS::CssSizeReport::enable();
+    }
+
+    if (isSet("--selector-report")) {
+        selector_report_path = attrVal("--selector-report");
+
+        (selector_report_path.empty() || !FileSystem::isAbsolutePath(selector_report_path)) &&
+            RETURN("Expected absolute file path after argument '--selector-report'");
+
+        CSS::CssSelectorReport::enable();
+    }
+
+    if (isSet("-O")) {
+        const string level = attrVal("-O");
+
+        !(level == "0" || level == "1" || level == "2") &&
+            RETURN("Expected 0, 1 or 2 after argument '-O'");
+
+        CSS::CssPassManager::setLevel(CSS::CssPassManager::Level(level.front() - '0'));
+    }
+
+    CSS::CssPassManager::resolveDependencies();
+
+    if (isSet("--passes")) {
+        !attrVal("--passes").empty() &&
+            RETURN("Expected no value after argument '--passes'");
+
+        CSS::CssPassManager::enableReport();
+    }
+
+    if (isSet("--fixpoint")) {
+        !attrVal("--fixpoint").empty() &&
+            RETURN("Expected no value after argument '--fixpoint'");
+
+        CSS::CssPassManager::enableFixpoint();
+    }
+
+    if (isSet("--pass-budget")) {
+        const string budget = attrVal("--pass-budget");
+
+        (budget.empty() || !all_of(budget.begin(), budget.end(), ::isdigit)) &&
+            RETURN("Expected the number of milliseconds after argument '--pass-budget'");
+
+        CSS::CssPassManager::setTimeBudget(stoull(budget));
+    }
+
     if (!cfg.isEnabled(Config::GENERAL__OUTPUT_TO_STDO) &&
         cfg.isEnabled(Config::GENERAL__CREATE_JSON_FILE)) {
         const auto checkJsonObjectName = [&](const string &var) -> void {
@@ -21,6 +21,10 @@ along with this program. If not, see <https://www.gnu.org/licenses/>.
 #define MAIN_H
 #include "Console.h"
 #include "Help.h"
+#include "Statistics.h"
+#include "css/CssPassManager.h"
+#include "css/CssSelectorReport.h"
+#include "css/CssSizeReport.h"
 #include "config/Config.h"
 #include "config/ConfigFile.h"
 #include "config/ConfigFile.h"
@@ -30,7 +34,7 @@ along with this program. If not, see <https://www.gnu.org/licenses/>.
 
 using namespace std;
 
-extern inline bool RETURN [[noreturn]] (const string &message);
+extern bool RETURN [[noreturn]] (const string &message);
 //inline bool RETURN [[noreturn]] (const string &message);
 inline bool isSet(const string &arg);
 inline string attrVal(const string &arg);
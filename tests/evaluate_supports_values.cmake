@@ -0,0 +1,39 @@
+# A value may be newer than its property. evaluate_supports leaves rules
+# testing values, which the support table doesn't list, unchanged, while
+# listed declarations are still resolved against the default targets.
+#
+# Variables: HSPP (path of the executable), WORK_DIR (scratch directory)
+
+set(STYLESHEET "${WORK_DIR}/evaluate_supports_values.css")
+set(CONFIG_FILE "${WORK_DIR}/evaluate_supports_values.ini")
+
+file(MAKE_DIRECTORY "${WORK_DIR}")
+file(WRITE "${STYLESHEET}"
+	"@supports (grid-template-rows:masonry){.masonry{color:red}}\n"
+	"@supports not (grid-template-columns:subgrid){.fallback{color:blue}}\n"
+	"@supports (display:grid){.grid{color:green}}\n")
+file(WRITE "${CONFIG_FILE}" "[general]\ncreate_json_file = off\n\n[css]\nevaluate_supports = on\n")
+
+execute_process(
+	COMMAND "${HSPP}" -i "${STYLESHEET}" --stdo --config-file "${CONFIG_FILE}"
+	RESULT_VARIABLE RESULT
+	OUTPUT_VARIABLE OUTPUT
+	ERROR_VARIABLE OUTPUT
+)
+
+if(NOT RESULT EQUAL 0)
+	message(FATAL_ERROR "hspp failed:\n${OUTPUT}")
+endif()
+
+if(NOT OUTPUT MATCHES "@supports ?\\(grid-template-rows:masonry\\){\\.masonry{color:red}}")
+	message(FATAL_ERROR "The rule testing masonry was evaluated:\n${OUTPUT}")
+endif()
+
+# Chrome 109 and Safari 15.6 don't understand subgrid
+if(NOT OUTPUT MATCHES "@supports not \\(grid-template-columns:subgrid\\){\\.fallback{color:blue}}")
+	message(FATAL_ERROR "The fallback for subgrid was removed:\n${OUTPUT}")
+endif()
+
+if(OUTPUT MATCHES "display:grid" OR NOT OUTPUT MATCHES "\\.grid{color:green}")
+	message(FATAL_ERROR "The rule testing display:grid wasn't unwrapped:\n${OUTPUT}")
+endif()
@@ -0,0 +1,31 @@
+# Math functions are generated without white space between their values,
+# so inline_custom_properties doesn't splice a custom property with
+# several values into calc(). A single value is still inlined.
+#
+# Variables: HSPP (path of the executable), WORK_DIR (scratch directory)
+
+set(STYLESHEET "${WORK_DIR}/inline_custom_properties_math.css")
+set(CONFIG_FILE "${WORK_DIR}/inline_custom_properties_math.ini")
+
+file(MAKE_DIRECTORY "${WORK_DIR}")
+file(WRITE "${STYLESHEET}" ":root{--a:1 +2;--b:1px 2px;--c:3px}\na{width:calc(2*var(--a))}\nb{width:calc(var(--b))}\nc{width:calc(2*var(--c))}\n")
+file(WRITE "${CONFIG_FILE}" "[general]\ncreate_json_file = off\n\n[css]\ninline_custom_properties = on\n")
+
+execute_process(
+	COMMAND "${HSPP}" -i "${STYLESHEET}" --stdo --config-file "${CONFIG_FILE}"
+	RESULT_VARIABLE RESULT
+	OUTPUT_VARIABLE OUTPUT
+	ERROR_VARIABLE OUTPUT
+)
+
+if(NOT RESULT EQUAL 0)
+	message(FATAL_ERROR "hspp failed:\n${OUTPUT}")
+endif()
+
+if(NOT OUTPUT MATCHES "a{width:calc\\(2\\*var\\(--a\\)\\)}" OR NOT OUTPUT MATCHES "b{width:calc\\(var\\(--b\\)\\)}")
+	message(FATAL_ERROR "A custom property with several values was inlined into calc():\n${OUTPUT}")
+endif()
+
+if(NOT OUTPUT MATCHES "c{width:calc\\(2\\*3px\\)}")
+	message(FATAL_ERROR "A custom property with a single value wasn't inlined:\n${OUTPUT}")
+endif()
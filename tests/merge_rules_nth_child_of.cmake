@@ -0,0 +1,43 @@
+# Chrome before 111 doesn't understand :nth-child(An+B of S) and drops a
+# selector list containing it. merge_rules only combines such a rule with
+# others, if all browser_targets understand it.
+#
+# Variables: HSPP (path of the executable), WORK_DIR (scratch directory)
+
+set(STYLESHEET "${WORK_DIR}/merge_rules_nth_child_of.css")
+set(CONFIG_FILE "${WORK_DIR}/merge_rules_nth_child_of.ini")
+
+file(MAKE_DIRECTORY "${WORK_DIR}")
+file(WRITE "${STYLESHEET}" ".a:nth-child(odd of .x){color:red}\n.b{color:red}\n.c:nth-child(odd){color:blue}\n.d{color:blue}\n")
+
+# The default targets include chrome 109
+foreach(TARGETS "" "chrome 120 safari 17 firefox 120")
+	set(CONFIG "[general]\ncreate_json_file = off\n\n[css]\nmerge_rules = on\n")
+
+	if(TARGETS)
+		string(APPEND CONFIG "browser_targets = ${TARGETS}\n")
+	endif()
+
+	file(WRITE "${CONFIG_FILE}" "${CONFIG}")
+
+	execute_process(
+		COMMAND "${HSPP}" -i "${STYLESHEET}" --stdo --config-file "${CONFIG_FILE}"
+		RESULT_VARIABLE RESULT
+		OUTPUT_VARIABLE OUTPUT
+		ERROR_VARIABLE OUTPUT
+	)
+
+	if(NOT RESULT EQUAL 0)
+		message(FATAL_ERROR "hspp failed:\n${OUTPUT}")
+	endif()
+
+	if(NOT OUTPUT MATCHES "\\.c:nth-child\\(odd\\),\\.d{color:blue}")
+		message(FATAL_ERROR "Rules with a plain :nth-child() weren't merged:\n${OUTPUT}")
+	endif()
+
+	if(TARGETS AND NOT OUTPUT MATCHES "\\.a:nth-child\\(odd of \\.x\\),\\.b{color:red}")
+		message(FATAL_ERROR "Rules weren't merged with the targets ${TARGETS}:\n${OUTPUT}")
+	elseif(NOT TARGETS AND NOT OUTPUT MATCHES "\\.a:nth-child\\(odd of \\.x\\){color:red}\\.b{color:red}")
+		message(FATAL_ERROR "A rule with :nth-child(odd of .x) was merged for the default targets:\n${OUTPUT}")
+	endif()
+endforeach()
@@ -0,0 +1,45 @@
+# A stylesheet large enough to be parsed in parallel segments, with syntax
+# errors in two later segments. Only the first error in document order is
+# reported, once, and hspp fails.
+#
+# Variables: HSPP (path of the executable), WORK_DIR (scratch directory)
+
+set(STYLESHEET "${WORK_DIR}/parse_error_in_later_segment.css")
+set(CONFIG_FILE "${WORK_DIR}/parse_error_in_later_segment.ini")
+
+set(RULES "")
+foreach(ROW RANGE 1 5000)
+	if(ROW EQUAL 2500)
+		string(APPEND RULES ".broken-a{color:red}}\n")
+	elseif(ROW EQUAL 4500)
+		string(APPEND RULES ".broken-b{color:red}}\n")
+	else()
+		string(APPEND RULES ".rule-${ROW}{color:red;margin:0 auto}\n")
+	endif()
+endforeach()
+
+file(MAKE_DIRECTORY "${WORK_DIR}")
+file(WRITE "${STYLESHEET}" "${RULES}")
+
+# Segments are parsed concurrently, or passed through the pipeline stages
+foreach(PIPELINE off on)
+	file(WRITE "${CONFIG_FILE}" "[general]\nthreads = 4\npipeline = ${PIPELINE}\n")
+
+	execute_process(
+		COMMAND "${HSPP}" -i "${STYLESHEET}" --stdo --config-file "${CONFIG_FILE}"
+		RESULT_VARIABLE RESULT
+		OUTPUT_VARIABLE OUTPUT
+		ERROR_VARIABLE OUTPUT
+	)
+
+	if(RESULT EQUAL 0)
+		message(FATAL_ERROR "hspp succeeded on an invalid stylesheet with pipeline = ${PIPELINE}")
+	endif()
+
+	string(REGEX MATCHALL "Parse error" ERRORS "${OUTPUT}")
+	list(LENGTH ERRORS ERROR_COUNT)
+
+	if(NOT ERROR_COUNT EQUAL 1 OR NOT OUTPUT MATCHES "on row 2500 column 21")
+		message(FATAL_ERROR "Expected one parse error on row 2500 with pipeline = ${PIPELINE}, got:\n${OUTPUT}")
+	endif()
+endforeach()
@@ -0,0 +1,51 @@
+# A property, which reads var(), may refer to any definition of its type,
+# as the custom property may be set outside of the stylesheet. Every
+# @keyframes rule is kept for animation, every @font-face rule for
+# font-family. Definitions of other types are still removed.
+#
+# Variables: HSPP (path of the executable), WORK_DIR (scratch directory)
+
+set(STYLESHEET "${WORK_DIR}/remove_unused_definitions_var.css")
+set(CONFIG_FILE "${WORK_DIR}/remove_unused_definitions_var.ini")
+
+file(MAKE_DIRECTORY "${WORK_DIR}")
+file(WRITE "${CONFIG_FILE}" "[general]\ncreate_json_file = off\n\n[css]\nremove_unused_definitions = on\n")
+
+foreach(CASE keyframes font_face)
+	set(KEYFRAMES "@keyframes a{0%{opacity:0}}")
+	set(FONT_FACE "@font-face{font-family:Foo;src:url(foo.woff)}")
+
+	if(CASE STREQUAL "keyframes")
+		set(USE "animation:1s var(--n)")
+		set(KEPT "${KEYFRAMES}")
+		set(REMOVED "${FONT_FACE}")
+	else()
+		set(USE "font-family:var(--f)")
+		set(KEPT "${FONT_FACE}")
+		set(REMOVED "${KEYFRAMES}")
+	endif()
+
+	file(WRITE "${STYLESHEET}" "b{${USE}}\n${KEYFRAMES}\n${FONT_FACE}\n")
+
+	execute_process(
+		COMMAND "${HSPP}" -i "${STYLESHEET}" --stdo --config-file "${CONFIG_FILE}"
+		RESULT_VARIABLE RESULT
+		OUTPUT_VARIABLE OUTPUT
+		ERROR_VARIABLE OUTPUT
+	)
+
+	if(NOT RESULT EQUAL 0)
+		message(FATAL_ERROR "hspp failed:\n${OUTPUT}")
+	endif()
+
+	string(FIND "${OUTPUT}" "${KEPT}" KEPT_POSITION)
+	string(FIND "${OUTPUT}" "${REMOVED}" REMOVED_POSITION)
+
+	if(KEPT_POSITION EQUAL -1)
+		message(FATAL_ERROR "The definition, which '${USE}' may refer to, was removed:\n${OUTPUT}")
+	endif()
+
+	if(NOT REMOVED_POSITION EQUAL -1)
+		message(FATAL_ERROR "The unused definition wasn't removed with '${USE}':\n${OUTPUT}")
+	endif()
+endforeach()
@@ -0,0 +1,31 @@
+# A substitution function may stand for several values, so the patterns
+# of the value rewrite table, which start with any value, don't match it.
+# The plain value next to it is still rewritten.
+#
+# Variables: HSPP (path of the executable), WORK_DIR (scratch directory)
+
+set(STYLESHEET "${WORK_DIR}/rewrite_values_var.css")
+set(CONFIG_FILE "${WORK_DIR}/rewrite_values_var.ini")
+
+file(MAKE_DIRECTORY "${WORK_DIR}")
+file(WRITE "${STYLESHEET}" "a{background-position:var(--x) center}\nb{background-position:10px center}\n")
+file(WRITE "${CONFIG_FILE}" "[general]\ncreate_json_file = off\n\n[css]\nrewrite_values = on\n")
+
+execute_process(
+	COMMAND "${HSPP}" -i "${STYLESHEET}" --stdo --config-file "${CONFIG_FILE}"
+	RESULT_VARIABLE RESULT
+	OUTPUT_VARIABLE OUTPUT
+	ERROR_VARIABLE OUTPUT
+)
+
+if(NOT RESULT EQUAL 0)
+	message(FATAL_ERROR "hspp failed:\n${OUTPUT}")
+endif()
+
+if(NOT OUTPUT MATCHES "a{background-position:var\\(--x\\) center}")
+	message(FATAL_ERROR "The value with var() was rewritten:\n${OUTPUT}")
+endif()
+
+if(NOT OUTPUT MATCHES "b{background-position:10px}")
+	message(FATAL_ERROR "The value without var() wasn't rewritten:\n${OUTPUT}")
+endif()
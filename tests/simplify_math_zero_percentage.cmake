@@ -0,0 +1,31 @@
+# A percentage term of a math function changes, how the result resolves,
+# even if it is zero. simplify_math_functions keeps it, but still drops
+# zero terms of other units.
+#
+# Variables: HSPP (path of the executable), WORK_DIR (scratch directory)
+
+set(STYLESHEET "${WORK_DIR}/simplify_math_zero_percentage.css")
+set(CONFIG_FILE "${WORK_DIR}/simplify_math_zero_percentage.ini")
+
+file(MAKE_DIRECTORY "${WORK_DIR}")
+file(WRITE "${STYLESHEET}" "a{width:calc(1px + 0%)}\nb{width:calc(2px * 3 + 0% * 4)}\nc{width:calc(10px + 0em + 5px)}\n")
+file(WRITE "${CONFIG_FILE}" "[general]\ncreate_json_file = off\n\n[css]\nsimplify_math_functions = on\n")
+
+execute_process(
+	COMMAND "${HSPP}" -i "${STYLESHEET}" --stdo --config-file "${CONFIG_FILE}"
+	RESULT_VARIABLE RESULT
+	OUTPUT_VARIABLE OUTPUT
+	ERROR_VARIABLE OUTPUT
+)
+
+if(NOT RESULT EQUAL 0)
+	message(FATAL_ERROR "hspp failed:\n${OUTPUT}")
+endif()
+
+if(NOT OUTPUT MATCHES "a{width:calc\\(1px \\+ 0%\\)}" OR NOT OUTPUT MATCHES "b{width:calc\\(6px \\+ 0%\\)}")
+	message(FATAL_ERROR "A zero percentage was dropped:\n${OUTPUT}")
+endif()
+
+if(NOT OUTPUT MATCHES "c{width:15px}")
+	message(FATAL_ERROR "A zero length wasn't dropped:\n${OUTPUT}")
+endif()